@@ -0,0 +1,57 @@
+# Measures how long it takes from the start of the process until the first
+# sound is submitted to the mixer, and where that time goes.
+
+script_start = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+require 'etc'
+
+# How long the process has been running, read from /proc on Linux, or nil
+# where that is not known.
+def process_elapsed
+  stat = File.read('/proc/self/stat')
+  # Fields after the command name, which may contain spaces; the start time
+  # is the 22nd field, counted in clock ticks since the system booted.
+  start = stat[stat.rindex(')') + 2..-1].split[19].to_i
+  uptime = File.read('/proc/uptime').to_f
+  uptime - start.fdiv(Etc.sysconf(Etc::SC_CLK_TCK))
+rescue SystemCallError, NotImplementedError, TypeError
+  nil
+end
+
+# Interpreter startup comes before the script, so it is timed from the
+# process start; both clocks only tick every 10 ms or so.
+elapsed = process_elapsed
+if elapsed
+  t0 = Process.clock_gettime(Process::CLOCK_MONOTONIC) - elapsed
+else
+  puts 'process start unknown; timing from the start of the script'
+  t0 = script_start
+end
+phases = [['boot', script_start]]
+mark = lambda do |name|
+  phases << [name, Process.clock_gettime(Process::CLOCK_MONOTONIC)]
+end
+
+require 'seal'
+mark['require']
+
+Seal.startup
+mark['startup']
+
+buffer = Seal::Buffer.new('audio/siren.wav')
+mark['load']
+
+source = Seal::Source.new
+source.buffer = buffer
+source.play
+mark['play']
+
+last = t0
+phases.each do |name, t|
+  printf("%-8s %8.2f ms\n", name, (t - last) * 1000)
+  last = t
+end
+printf("%-8s %8.2f ms\n", 'total', (last - t0) * 1000)
+
+sleep 1 while source.state == Seal::Source::State::PLAYING
+
+Seal.cleanup
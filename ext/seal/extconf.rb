@@ -36,6 +36,13 @@ else
   check_library('pthread', 'pthread_create')
 end
 
+# Release the GVL around blocking calls where supported (Ruby 2.0+).
+have_func('rb_thread_call_without_gvl', 'ruby/thread.h')
+# Report memory held by OpenAL to the GC where supported (Ruby 2.4+).
+have_func('rb_gc_adjust_memory_usage')
+# Allow use from non-main Ractors where supported (Ruby 3.0+).
+have_func('rb_ext_ractor_safe')
+
 # Add source directories.
 $VPATH << src_dir << File.join(src_dir, 'seal') <<
           File.join(src_dir, 'libogg') <<
@@ -8,12 +8,19 @@
 #define _SEAL_SEAL_H_
 
 #include "seal/core.h"
+#include "seal/context.h"
 #include "seal/buf.h"
+#include "seal/io.h"
 #include "seal/stream.h"
+#include "seal/cbuf.h"
+#include "seal/probe.h"
 #include "seal/src.h"
+#include "seal/culler.h"
 #include "seal/listener.h"
 #include "seal/efs.h"
 #include "seal/rvb.h"
+#include "seal/zone.h"
+#include "seal/writer.h"
 #include "seal/err.h"
 
 #endif /* _SEAL_SEAL_H_ */
@@ -18,6 +18,7 @@
 #include <stddef.h>
 #include "raw.h"
 #include "fmt.h"
+#include "io.h"
 #include "err.h"
 
 typedef struct seal_buf_t seal_buf_t;
@@ -46,7 +47,10 @@ seal_err_t SEAL_API seal_destroy_buf(seal_buf_t*);
 
 /*
  * Loads audio from a file to a buffer that is not currently used by any
- * source. Sets all the attributes appropriately.
+ * source. Sets all the attributes appropriately. ADPCM-encoded WAVE files are
+ * handed to OpenAL as they are if the implementation supports the codec (in
+ * which case the bit depth of the buffer is 4), or otherwise decoded to
+ * 16-bit PCM.
  *
  * @param buf       the buffer to receive the loaded data
  * @param filename  the filename of the audio
@@ -60,6 +64,24 @@ seal_err_t SEAL_API seal_load2buf(
     seal_fmt_t
 );
 
+/*
+ * Same as `seal_load2buf' except that stereo audio is downmixed to mono
+ * before being handed to OpenAL. OpenAL only spatializes mono buffers, so
+ * this is meant for positional sound effects that happen to be stored in
+ * stereo files; it also halves the memory the buffer takes.
+ *
+ * @param buf       the buffer to receive the loaded data
+ * @param filename  the filename of the audio
+ * @param fmt       the format of the audio file; automatic recognition of the
+ *                  audio format will be attempted if `fmt' is
+ *                  `SEAL_UNKNOWN_FMT'
+ */
+seal_err_t SEAL_API seal_load_mono2buf(
+    seal_buf_t*,
+    const char* /*filename*/,
+    seal_fmt_t
+);
+
 /*
  * Copies raw PCM data to a buffer that is not currently used by any source.
  * Sets all the attributes appropriately.
@@ -122,6 +144,24 @@ seal_err_t SEAL_API seal_load(
     seal_fmt_t
 );
 
+/*
+ * Same as `seal_load' except that the encoded audio is read through the
+ * callbacks of an I/O object rather than from a file, so that audio can be
+ * loaded from archives or other virtual file systems.
+ *
+ * @param raw       the receiver of the loaded PCM data; `raw->data' will be
+ *                  dynamically allocated so the caller is responsible for
+ *                  deallocating it
+ * @param io        the I/O object to read the audio from; `io->close' is
+ *                  called before this function returns whether or not it
+ *                  succeeds
+ * @param fmt       the format of the audio; automatic recognition of the
+ *                  audio format will be attempted if the passed-in `fmt' is
+ *                  `SEAL_UNKNOWN_FMT', in which case `io' must be able to
+ *                  seek
+ */
+seal_err_t SEAL_API seal_load_io(seal_raw_t*, seal_io_t*, seal_fmt_t);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,133 @@
+/*
+ * Interfaces for manipulating compressed buffers. A compressed buffer keeps
+ * the encoded bytes of an audio file in memory and decodes them only when it
+ * is being played. This trades a little CPU time during playback for a much
+ * smaller memory footprint than that of a regular buffer, whose PCM data can
+ * easily be ten times the size of the encoded file. Compressed buffers are
+ * therefore suitable for medium-sized sound that is played often enough that
+ * reading it from the disk every time is undesirable, yet is too large to
+ * keep decoded.
+ *
+ * A compressed buffer is played by attaching it to a source with
+ * `seal_set_src_cbuf', which turns the source into a streaming source that
+ * reads from the memory of the compressed buffer. Any number of sources can
+ * play the same compressed buffer at the same time.
+ */
+
+#ifndef _SEAL_CBUF_H_
+#define _SEAL_CBUF_H_
+
+#include <stddef.h>
+#include "raw.h"
+#include "fmt.h"
+#include "stream.h"
+#include "err.h"
+
+typedef struct seal_cbuf_t seal_cbuf_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Initializes a new, empty compressed buffer. If the compressed buffer is no
+ * longer needed, call `seal_destroy_cbuf' to release the resources used by
+ * the compressed buffer.
+ *
+ * @param cbuf  the compressed buffer to initialize
+ */
+seal_err_t SEAL_API seal_init_cbuf(seal_cbuf_t*);
+
+/*
+ * Destroys a compressed buffer that is not currently used by any source or
+ * stream.
+ *
+ * @param cbuf  the compressed buffer to destroy
+ */
+seal_err_t SEAL_API seal_destroy_cbuf(seal_cbuf_t*);
+
+/*
+ * Loads the encoded content of an audio file to a compressed buffer that is
+ * not currently used by any source or stream. Sets all the attributes
+ * appropriately. Only Ogg Vorbis and MPEG audio are supported since WAVE
+ * files are not compressed.
+ *
+ * @param cbuf      the compressed buffer to receive the loaded data
+ * @param filename  the filename of the audio
+ * @param fmt       the format of the audio file; automatic recognition of the
+ *                  audio format will be attempted if `fmt' is
+ *                  `SEAL_UNKNOWN_FMT'
+ */
+seal_err_t SEAL_API seal_load2cbuf(
+    seal_cbuf_t*,
+    const char* /*filename*/,
+    seal_fmt_t
+);
+
+/*
+ * Opens a stream that decodes from a compressed buffer. The compressed buffer
+ * must outlive the stream. Call `seal_close_stream' to close the stream.
+ *
+ * @param stream    the stream to open
+ * @param cbuf      the compressed buffer to decode from
+ */
+seal_err_t SEAL_API seal_open_cbuf_stream(seal_stream_t*, seal_cbuf_t*);
+
+/*
+ * Gets the size, in bytes, of the encoded data in a compressed buffer. The
+ * default is 0.
+ *
+ * @param cbuf  the compressed buffer to retrive the size of
+ * @param psize the receiver of the size
+ */
+seal_err_t SEAL_API seal_get_cbuf_size(seal_cbuf_t*, int* /*psize*/);
+
+/*
+ * Gets the frequency (sample rate) of the audio contained in a compressed
+ * buffer. The default is 0.
+ *
+ * @param cbuf  the compressed buffer to retrive the frequency of
+ * @param pfreq the receiver of the frequency
+ */
+seal_err_t SEAL_API seal_get_cbuf_freq(seal_cbuf_t*, int* /*pfreq*/);
+
+/*
+ * Gets the bit depth (bits per sample) of the decoded audio of a compressed
+ * buffer. The default is 16.
+ *
+ * @param cbuf  the compressed buffer to retrive the bit depth of
+ * @param pbps  the receiver of the bit depth
+ */
+seal_err_t SEAL_API seal_get_cbuf_bps(seal_cbuf_t*, int* /*pbps*/);
+
+/*
+ * Gets the number of channels of the audio contained in a compressed buffer.
+ * The default is 1.
+ *
+ * @param cbuf          the compressed buffer to retrive the number of
+ *                      channels of
+ * @param pnchannels    the receiver of the number of channels
+ */
+seal_err_t SEAL_API seal_get_cbuf_nchannels(seal_cbuf_t*,
+                                            int* /*pnchannels*/);
+
+#ifdef __cplusplus
+}
+#endif
+
+/*
+ *****************************************************************************
+ * Below are **implementation details**.
+ *****************************************************************************
+ */
+
+struct seal_cbuf_t
+{
+    /* The encoded audio file content. */
+    void*           data;
+    size_t          size;
+    seal_fmt_t      fmt;
+    seal_raw_attr_t attr;
+};
+
+#endif /* _SEAL_CBUF_H_ */
@@ -0,0 +1,142 @@
+/*
+ * Interfaces for audio contexts, each of which renders its own sources and
+ * listener on a device of its own, isolated from the other contexts. The
+ * context created by `seal_startup' is current for the whole process; more
+ * contexts can be opened and bound to single threads so that different
+ * threads drive different contexts in parallel. Seal objects are created in
+ * the context current on the calling thread and must only be used there,
+ * except that buffers can be used by every context on the same device.
+ *
+ * Binding contexts to threads needs the `ALC_EXT_thread_local_context'
+ * extension. Without it, binding a context makes it current for the whole
+ * process instead.
+ */
+
+#ifndef _SEAL_CONTEXT_H_
+#define _SEAL_CONTEXT_H_
+
+#include <stddef.h>
+#include "core.h"
+#include "err.h"
+
+typedef struct seal_context_t seal_context_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Opens a device and creates a context on it, in addition to the ones Seal
+ * already uses. Must be called after `seal_startup'. If the context is no
+ * longer needed, call `seal_close_context' to release the resources used by
+ * it, which has to be done before `seal_cleanup'.
+ *
+ * @param context       the context to open
+ * @param device_name   the name of a device; 0 to use the default one
+ */
+seal_err_t SEAL_API seal_open_context(
+    seal_context_t*,
+    const char* /*device_name*/
+);
+
+/*
+ * Destroys a context and closes its device. Objects created in the context
+ * are invalidated. The calling thread goes back to the context created by
+ * `seal_startup' if it was using this one; unbind the context from the
+ * other threads first.
+ *
+ * @param context   the context to close
+ */
+seal_err_t SEAL_API seal_close_context(seal_context_t*);
+
+/*
+ * Binds a context to the calling thread, so that Seal calls made on the
+ * thread use it whatever the other threads use. Falls back to making the
+ * context current for the whole process if contexts cannot be bound to
+ * threads. Threads should unbind before exiting, which also releases what
+ * Seal keeps for the batches of the thread.
+ *
+ * @param context   the context to bind, or 0 for the calling thread to go
+ *                  back to the context current for the process
+ */
+seal_err_t SEAL_API seal_use_context(seal_context_t*);
+
+/*
+ * @return  the context bound to the calling thread by `seal_use_context', or
+ *          0 if the thread uses the context current for the process
+ */
+seal_context_t* SEAL_API seal_get_context(void);
+
+/*
+ * @return  1 if contexts can be bound to single threads or otherwise 0;
+ *          only known after `seal_startup'
+ */
+char SEAL_API seal_has_thread_local_context(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+/*
+ *****************************************************************************
+ * Below are **implementation details**.
+ *****************************************************************************
+ */
+
+struct seal_context_t
+{
+    void*   device;
+    void*   context;
+    int     per_src_effect_limit;
+    int     device_freq;
+    /*
+     * Copies of the properties of the listener, which OpenAL keeps per
+     * context; see listener.c.
+     */
+    float   listener_gain;
+    float   listener_pos[3];
+    float   listener_vel[3];
+};
+
+/*
+ * @return  the context used by the calling thread, which is the context
+ *          created by `seal_startup' (or not yet opened) unless another is
+ *          bound; never 0
+ */
+seal_context_t* _seal_get_context(void);
+
+/*
+ * Opens the context created by `seal_startup', makes it current for the
+ * process and looks up the thread-local context extension.
+ */
+seal_err_t _seal_open_default_context(const char* /*device_name*/);
+
+/*
+ * Opens the context created by `seal_startup_loopback' on a loopback device
+ * rendering the given format, and makes it current for the process.
+ */
+seal_err_t _seal_open_loopback_context(
+    int /*freq*/,
+    int /*nchannels*/,
+    seal_sample_type_t
+);
+
+/* Closes the context created by `seal_startup' or `seal_startup_loopback'. */
+void _seal_close_default_context(void);
+
+/*
+ * @return  1 if the calling thread uses the context created by
+ *          `seal_startup_loopback' or otherwise 0
+ */
+char _seal_is_loopback(void);
+
+/*
+ * @return  the size in bytes of a sample frame rendered by the loopback
+ *          device, or 0 if Seal was not started on one
+ */
+size_t _seal_get_loopback_frame_size(void);
+
+/* Mixes a number of sample frames of the loopback device into `dst'. */
+void _seal_render_loopback(void* /*dst*/, size_t /*nframes*/);
+
+#endif /* _SEAL_CONTEXT_H_ */
@@ -6,30 +6,260 @@
 #define _SEAL_CORE_H_
 
 #include <stddef.h>
+#include "raw.h"
 #include "err.h"
 
+/*
+ * Models of how the gain of sources falls off with their distance to the
+ * listener, same as the OpenAL distance models. The non-clamped models apply
+ * to any distance while the clamped ones stop attenuating beyond the maximum
+ * distance of each source and do not amplify closer than its reference
+ * distance. `SEAL_NO_DISTANCE' disables distance attenuation.
+ */
+enum seal_distance_model_t
+{
+    SEAL_NO_DISTANCE,
+    SEAL_INVERSE_DISTANCE,
+    SEAL_INVERSE_DISTANCE_CLAMPED,
+    SEAL_LINEAR_DISTANCE,
+    SEAL_LINEAR_DISTANCE_CLAMPED,
+    SEAL_EXPONENT_DISTANCE,
+    SEAL_EXPONENT_DISTANCE_CLAMPED
+};
+
+/* Types of the samples rendered by `seal_render'. */
+enum seal_sample_type_t
+{
+    SEAL_U8_SAMPLE,
+    SEAL_S16_SAMPLE,
+    SEAL_FLOAT_SAMPLE
+};
+
+/* Scheduling policies of the threads that stream audio to sources. */
+enum seal_sched_policy_t
+{
+    SEAL_DEFAULT_SCHED,
+    /* Real-time policies, which usually need privileges. */
+    SEAL_FIFO_SCHED,
+    SEAL_RR_SCHED
+};
+
+typedef enum seal_distance_model_t seal_distance_model_t;
+typedef enum seal_sample_type_t seal_sample_type_t;
+typedef enum seal_sched_policy_t seal_sched_policy_t;
+typedef struct seal_sched_t seal_sched_t;
+
+/*
+ * policy   the scheduling policy
+ * priority the real-time priority under `SEAL_FIFO_SCHED' and
+ *          `SEAL_RR_SCHED', clamped to what the system supports; ignored
+ *          under `SEAL_DEFAULT_SCHED'
+ * nice     the change to the nice level, negative to be scheduled more;
+ *          only applies under `SEAL_DEFAULT_SCHED'
+ * cpu_mask the processors to run on, bit i for processor i, or 0 for any
+ */
+struct seal_sched_t
+{
+    seal_sched_policy_t policy;
+    int                 priority;
+    int                 nice;
+    unsigned long       cpu_mask;
+};
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 /*
- * Initializes Seal by specifying the device name. This function is not
- * re-entrant nor thread-safe and should be called only once per Seal session.
+ * Initializes Seal by specifying the device name, on which the context
+ * current for the process is created. This function is not re-entrant nor
+ * thread-safe and should be called only once per Seal session.
  * Match a call to `seal_startup' with a call to `seal_cleanup' and never call
  * `seal_starup' twice in a row.
  *
+ * Only the device and context are set up here. The effect extension is
+ * looked up when the first reverb or effect slot is initialized, which fails
+ * with `SEAL_NO_EFX' on devices without it, and libmpg123 is initialized
+ * when MPEG audio is first opened; decoding needs no startup at all.
+ *
  * @param device_name   the name of a device; 0 to use the default one
  */
 seal_err_t SEAL_API seal_startup(const char* /*device_name*/);
 
+/*
+ * Initializes Seal on a loopback device instead of a real one, for rendering
+ * offline: nothing is played, and the mix is only produced, as fast as it
+ * can be computed, when asked for by `seal_render'. Streaming sources in the
+ * context of the loopback device get no updater threads; `seal_render'
+ * updates them in step with the mix, so the output only depends on what is
+ * done between the calls. Needs the `ALC_SOFT_loopback' extension. Same
+ * restrictions as `seal_startup' apply.
+ *
+ * @param freq          the sample rate to render at
+ * @param nchannels     the number of channels to render, one of 1, 2, 4, 6,
+ *                      7 and 8
+ * @param sample_type   the type of the samples to render
+ */
+seal_err_t SEAL_API seal_startup_loopback(
+    int /*freq*/,
+    int /*nchannels*/,
+    seal_sample_type_t /*sample_type*/
+);
+
+/*
+ * Renders sample frames from the loopback device opened by
+ * `seal_startup_loopback', advancing the mix and the streaming sources by
+ * the same amount of time. The frames are written interleaved in the format
+ * given at startup. Call from the thread that drives the sources.
+ *
+ * @param dst       the receiver of the frames
+ * @param nframes   the number of frames to render
+ * @return          `SEAL_BAD_OP' if Seal is not started on a loopback device
+ */
+seal_err_t SEAL_API seal_render(void* /*dst*/, size_t /*nframes*/);
+
 /* Uninitializes Seal and invalidate all Seal objects. Thread-unsafe. */
 void SEAL_API seal_cleanup(void);
 
 /*
- * @return  the maximum number of effect slots a source can feed concurrently.
+ * @return  the maximum number of effect slots a source can feed concurrently
+ *          in the context used by the calling thread.
  */
 int SEAL_API seal_get_per_src_effect_limit(void);
 
+/*
+ * @return  the mixing frequency of the device of the context used by the
+ *          calling thread, or 0 if Seal is not started
+ */
+int SEAL_API seal_get_device_freq(void);
+
+/*
+ * Sets whether audio is resampled to the mixing frequency of the device
+ * before being handed to OpenAL, both when loaded to buffers and when
+ * streamed by sources. Resampling once at load time (or once per chunk for
+ * streaming sources) spares OpenAL from resampling every playing source on
+ * every mix, at the cost of possibly larger buffers. Only affects audio loaded
+ * or streamed afterwards. The default is 0 (off).
+ *
+ * @param resampling    1 to resample or otherwise 0
+ */
+void SEAL_API seal_set_resampling(char /*resampling*/);
+
+/*
+ * @return  1 if audio is resampled to the mixing frequency of the device or
+ *          otherwise 0
+ */
+char SEAL_API seal_is_resampling(void);
+
+/*
+ * Opens a batch of updates. Until the matching `seal_commit_batch', the
+ * position, velocity, gain and other float properties set on sources, the
+ * listener, reverbs and effect slots are only recorded, and setting the same
+ * property of the same object again replaces the recorded value, so each
+ * property reaches OpenAL at most once per batch. Committing makes all the
+ * recorded changes and lets the mixer apply them at once, using
+ * `AL_SOFT_deferred_updates' where available or suspending the context
+ * otherwise, so that the mix never reflects half of a frame's update.
+ *
+ * Batches may nest, in which case only the outermost commit takes effect.
+ * Errors from recorded changes are not reported by the setters but by the
+ * commit. Getters and other calls that depend on recorded changes see them.
+ * Each thread has batches of its own: open, fill and commit a batch on one
+ * thread, in the context used by that thread.
+ */
+seal_err_t SEAL_API seal_begin_batch(void);
+
+/*
+ * Commits the batch of updates opened by `seal_begin_batch'.
+ *
+ * @return  the first error caused by the changes made in the batch, or
+ *          `SEAL_BAD_OP' if no batch is open
+ */
+seal_err_t SEAL_API seal_commit_batch(void);
+
+/*
+ * Sets the distance model applied to all sources. The default is
+ * `SEAL_INVERSE_DISTANCE_CLAMPED'.
+ *
+ * @param model the distance model to set
+ */
+seal_err_t SEAL_API seal_set_distance_model(seal_distance_model_t);
+
+/*
+ * Gets the distance model applied to all sources.
+ *
+ * @see             seal_set_distance_model
+ * @param pmodel    the receiver of the distance model
+ */
+seal_err_t SEAL_API seal_get_distance_model(seal_distance_model_t*
+                                            /*pmodel*/);
+
+/*
+ * Sets the number of worker threads, which run background work such as
+ * opening streams with `seal_open_stream_async'. The workers are started on
+ * demand; if they are running, this waits for them to finish the work
+ * submitted so far and stops them, and the next piece of work starts the
+ * new number of them. The default is one less than the number of processors,
+ * and at least 1. Must not be called from work run by the workers.
+ *
+ * @param count the number of worker threads, at least 1
+ */
+seal_err_t SEAL_API seal_set_worker_count(size_t /*count*/);
+
+/* @return  the number of worker threads */
+size_t SEAL_API seal_get_worker_count(void);
+
+/*
+ * Sets whether each worker thread asks to be kept on a processor of its own,
+ * which keeps the data of its work in the cache of one processor. Only a
+ * hint, supported on Linux and Windows. Restarts running workers like
+ * `seal_set_worker_count'. The default is 0 (off).
+ *
+ * @param affinity  1 to pin the workers or otherwise 0
+ */
+seal_err_t SEAL_API seal_set_worker_affinity(char /*affinity*/);
+
+/* @return  1 if the worker threads ask to be pinned or otherwise 0 */
+char SEAL_API seal_has_worker_affinity(void);
+
+/*
+ * Sets how the updater threads of streaming sources are scheduled, so that
+ * they keep their queues filled while the other threads saturate the
+ * processors. The settings are tried on a thread first, and each part that
+ * is not permitted, typically a real-time policy or a negative nice level
+ * without privileges, falls back to what the thread already had; if the
+ * real-time policy is refused, the nice level is tried instead. What was
+ * obtained is used by updater threads started afterwards. Real-time
+ * policies are emulated with the highest thread priority on Windows, which
+ * is obtained as `SEAL_DEFAULT_SCHED' with a nice level of -20, and nice
+ * levels and affinity are only supported on Linux and Windows.
+ *
+ * @param sched     the settings to ask for
+ * @param pobtained the receiver of the settings obtained, or 0
+ */
+seal_err_t SEAL_API seal_set_streaming_sched(
+    const seal_sched_t* /*sched*/,
+    seal_sched_t* /*pobtained*/
+);
+
+/*
+ * Gets the settings the updater threads of streaming sources are scheduled
+ * with, as obtained by `seal_set_streaming_sched'.
+ *
+ * @param psched    the receiver of the settings
+ */
+seal_err_t SEAL_API seal_get_streaming_sched(seal_sched_t* /*psched*/);
+
+/*
+ * Sets a flag that long operations made afterwards on the calling thread
+ * check as they go: loading buffers, streaming and waiting for streams being
+ * opened. Once the flag is set to nonzero, which any thread may do, they
+ * give up with `SEAL_CANCELED'. Lets blocking calls be interrupted.
+ *
+ * @param flag  the flag to check, or 0 to check none
+ */
+void SEAL_API seal_set_cancel_flag(volatile char* /*flag*/);
+
 /*
  * Gets the Seal version string.
  *
@@ -49,6 +279,32 @@ const char* SEAL_API seal_get_version(void);
 
 void _seal_sleep(unsigned int millisec);
 
+/*
+ * Looks up the effect extension functions the first time it is called;
+ * called before initializing effects and effect slots.
+ *
+ * @return  `SEAL_NO_EFX' if the device of the context used by the calling
+ *          thread has no effect extension, or an error if its functions are
+ *          missing
+ */
+seal_err_t _seal_init_efx(void);
+
+/*
+ * @return  1 if the flag set by `seal_set_cancel_flag' on the calling thread,
+ *          if any, is set or otherwise 0
+ */
+int _seal_is_canceled(void);
+
+/* @return  1 if the calling thread has a cancel flag or otherwise 0 */
+int _seal_is_cancelable(void);
+
+/*
+ * @param attr  the attribute of some audio
+ * @return      the frequency to resample the audio to, or 0 if it should be
+ *              left as it is
+ */
+int _seal_get_resampling_freq(seal_raw_attr_t*);
+
 /* Common types. */
 typedef void _seal_openal_initializer_t(int, unsigned int*);
 typedef void _seal_openal_destroyer_t(int, const unsigned int*);
@@ -94,4 +350,12 @@ extern void (*alAuxiliaryEffectSlotf)(unsigned int, int, float);
 extern void (*alGetAuxiliaryEffectSloti)(unsigned int, int, int*);
 extern void (*alGetAuxiliaryEffectSlotf)(unsigned int, int, float*);
 
+/*
+ * `AL_SOFT_deferred_updates' functions, which batch changes so that they are
+ * applied to the mix at once; suspend and process the current context
+ * instead if the extension is unavailable.
+ */
+extern void (*alDeferUpdatesSOFT)(void);
+extern void (*alProcessUpdatesSOFT)(void);
+
 #endif /* _SEAL_CORE_H_ */
@@ -0,0 +1,138 @@
+/*
+ * Interfaces for culling sources by distance. A culler indexes sources in a
+ * uniform grid keyed by their positions so that, once per frame, it can
+ * pause the playing sources that have gone beyond their maximum distance
+ * from the listener and resume the ones it paused as soon as the listener
+ * comes back within range, without visiting every source it paused. Paused
+ * streaming sources stop being refilled, so sources out of range cost
+ * neither mixing nor decoding.
+ */
+
+#ifndef _SEAL_CULLER_H_
+#define _SEAL_CULLER_H_
+
+#include <stddef.h>
+#include "src.h"
+#include "err.h"
+
+typedef struct seal_culler_t seal_culler_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Initializes a new culler. If the culler is no longer needed, call
+ * `seal_destroy_culler' to release the resources used by it.
+ *
+ * @param culler    the culler to initialize
+ * @param cell_size the edge length of the grid cells, which works best
+ *                  around the typical maximum distance of the sources
+ */
+seal_err_t SEAL_API seal_init_culler(seal_culler_t*, float /*cell_size*/);
+
+/*
+ * Destroys a culler. Sources culled at the time are left paused.
+ *
+ * @param culler    the culler to destroy
+ */
+seal_err_t SEAL_API seal_destroy_culler(seal_culler_t*);
+
+/*
+ * Adds a source to a culler. A source can be in at most one culler at a time
+ * and is removed from it automatically when destroyed. Sources whose maximum
+ * distance is `FLT_MAX' or which are relative to the listener are indexed
+ * but never culled.
+ *
+ * @param culler    the culler to add the source to
+ * @param src       the source to add
+ */
+seal_err_t SEAL_API seal_add_culled_src(seal_culler_t*, seal_src_t*);
+
+/*
+ * Removes a source from a culler. Does nothing if the source is not in the
+ * culler. The source is left paused if it is culled at the time.
+ *
+ * @param culler    the culler to remove the source from
+ * @param src       the source to remove
+ */
+seal_err_t SEAL_API seal_remove_culled_src(seal_culler_t*, seal_src_t*);
+
+/*
+ * Runs a cull pass, usually once per frame. Playing sources farther from the
+ * listener than their maximum distance are paused, and culled sources within
+ * their maximum distance are resumed. Static sources resume where they would
+ * have been had they kept playing, wrapping around if looping or stopping if
+ * not; streams cannot seek so streaming sources resume where they were
+ * paused. Playing, pausing, stopping or rewinding a culled source makes it
+ * no longer culled.
+ *
+ * @param culler    the culler to run the pass of
+ * @param dt        the time in seconds elapsed since the last pass
+ * @return          the first error encountered; the pass still goes through
+ *                  the other sources
+ */
+seal_err_t SEAL_API seal_cull_srcs(seal_culler_t*, float /*dt*/);
+
+/*
+ * Gets the number of sources in a culler.
+ *
+ * @param culler    the culler
+ * @param psize     the receiver of the number of sources
+ */
+seal_err_t SEAL_API seal_get_culler_size(seal_culler_t*, size_t* /*psize*/);
+
+/*
+ * Determines if a source is paused by the culler it is in.
+ *
+ * @param src       the source
+ * @param pculled   the receiver of the flag, 1 if culled or otherwise 0
+ */
+seal_err_t SEAL_API seal_is_src_culled(seal_src_t*, char* /*pculled*/);
+
+#ifdef __cplusplus
+}
+#endif
+
+/*
+ *****************************************************************************
+ * Below are **implementation details**.
+ *****************************************************************************
+ */
+
+struct seal_culler_t
+{
+    float   cell_size;
+    /* The largest finite maximum distance any source has had. */
+    float   reach;
+    /* The sum of the time steps of all the passes. */
+    double  time;
+    /* Array of entries, some of which may be free. */
+    void*   entries;
+    size_t  nentries;
+    size_t  capacity;
+    /* The number of entries in use. */
+    size_t  nsrcs;
+    /* One-based index of the first free entry or 0. */
+    size_t  free;
+    /* Indices of the entries checked on every pass. */
+    size_t* active;
+    size_t  nactive;
+    /* Heads of the lists of entries whose grid cells hash to them. */
+    size_t* buckets;
+    size_t  nbuckets;
+};
+
+/*
+ * Moves a source to the grid cell of its position and takes its maximum
+ * distance into account; called whenever either changes.
+ */
+void _seal_update_culled_src(seal_src_t*);
+
+/*
+ * Makes a source checked on every pass again and no longer culled; called
+ * when the source is played.
+ */
+void _seal_wake_culled_src(seal_src_t*);
+
+#endif /* _SEAL_CULLER_H_ */
@@ -56,6 +56,8 @@ enum seal_err_t
     SEAL_CANNOT_READ_MPG,
     SEAL_CANNOT_REWIND_MPG,
     SEAL_CANNOT_CLOSE_MPG,
+
+    SEAL_CANCELED
 };
 
 typedef enum seal_err_t seal_err_t;
@@ -72,6 +74,36 @@ extern "C" {
  */
 const char* SEAL_API seal_get_err_msg(seal_err_t);
 
+/*
+ * Sets whether float properties of sources, the listener, reverbs and effect
+ * slots are set and got unchecked. OpenAL reports errors through
+ * `alGetError', which costs about as much as the call it checks; in
+ * unchecked mode such calls skip it and always succeed, and the first error
+ * they cause is kept until `seal_get_deferred_err' is called, say once per
+ * frame. Calls whose failure would leave Seal objects inconsistent, such as
+ * creating objects or queuing buffers, are always checked; they first set
+ * aside any error left by unchecked calls, from any thread, so that they
+ * only fail for their own errors. Values got by failed unchecked calls are
+ * undefined. The default is 0 (checked) unless
+ * Seal is built with `SEAL_UNCHECKED' defined.
+ *
+ * @param unchecked 1 to skip checks or otherwise 0
+ */
+void SEAL_API seal_set_unchecked(char /*unchecked*/);
+
+/*
+ * @return  1 if float properties are set and got unchecked or otherwise 0
+ */
+char SEAL_API seal_is_unchecked(void);
+
+/*
+ * Gets the first error caused by unchecked calls since the last check and
+ * clears it. Use this to poll errors of calls made in unchecked mode.
+ *
+ * @return  the error, or `SEAL_OK' if there is none
+ */
+seal_err_t SEAL_API seal_get_deferred_err(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -87,4 +119,18 @@ const char* SEAL_API seal_get_err_msg(seal_err_t);
  */
 seal_err_t _seal_get_openal_err(void);
 
+/*
+ * Sets aside the error left by unchecked calls, if any, for
+ * `seal_get_deferred_err'. Called before making checked OpenAL calls so that
+ * their check does not pick up the error. Does nothing in checked mode.
+ */
+void _seal_drain_openal_err(void);
+
+/*
+ * Same as `_seal_get_openal_err' except that it checks nothing and returns
+ * `SEAL_OK' in unchecked mode. Used after setting or getting float
+ * properties, which is done many times per frame.
+ */
+seal_err_t _seal_get_openal_prop_err(void);
+
 #endif /* _SEAL_ERR_H_ */
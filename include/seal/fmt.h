@@ -6,6 +6,7 @@
 #define _SEAL_FMT_H_
 
 #include "err.h"
+#include "io.h"
 
 enum seal_fmt_t
 {
@@ -35,6 +36,17 @@ extern "C" {
  */
 seal_err_t seal_recognize_fmt(const char* /*filename*/, seal_fmt_t* /*pfmt*/);
 
+/*
+ * Same as `seal_recognize_fmt' except that the header is peeked from an I/O
+ * object. The I/O object is seeked back to where it was afterwards, so it
+ * must be able to seek.
+ *
+ * @param io        the I/O object of the audio
+ * @param pfmt      the receiver of the format if recognized or otherwise
+ *                  `SEAL_UNKNOWN_FMT'
+ */
+seal_err_t seal_recognize_io_fmt(seal_io_t*, seal_fmt_t* /*pfmt*/);
+
 /*
  * Ensures an audio format is known.
  *
@@ -0,0 +1,76 @@
+/*
+ * Interfaces for plugging custom byte sources into the decoders. An I/O
+ * object is a set of callbacks over an opaque handle, so that audio can be
+ * loaded or streamed from archives, encrypted packs, network caches or any
+ * other virtual file system without going through temporary files. Streams
+ * and buffers opened from files use the same interface internally.
+ */
+
+#ifndef _SEAL_IO_H_
+#define _SEAL_IO_H_
+
+#include <stddef.h>
+#include "err.h"
+
+/* Callbacks over a custom byte source. */
+typedef struct seal_io_t seal_io_t;
+
+/*
+ * handle  the user data passed to all the callbacks
+ * read    reads up to `nbytes' bytes to `dst' and returns the number of
+ *         bytes read; returns 0 on end of input or error
+ * seek    same semantics as `fseek'; input that cannot seek should always
+ *         return -1, in which case streams opened on it cannot be rewound
+ * tell    same semantics as `ftell'
+ * close   releases `handle'; returns 0 on success
+ */
+struct seal_io_t
+{
+    void*  handle;
+    size_t (*read)(void* /*handle*/, void* /*dst*/, size_t /*nbytes*/);
+    int    (*seek)(void* /*handle*/, long /*offset*/, int /*whence*/);
+    long   (*tell)(void* /*handle*/);
+    int    (*close)(void* /*handle*/);
+};
+
+/*
+ *****************************************************************************
+ * Below are **implementation details**.
+ *****************************************************************************
+ */
+
+/*
+ * Opens an I/O object on a file. Call `close' on the I/O object to release
+ * the file.
+ *
+ * @param io        the I/O object to open
+ * @param filename  the filename to open
+ */
+seal_err_t _seal_open_file_io(seal_io_t*, const char* /*filename*/);
+
+/*
+ * Same as `_seal_open_file_io' except that every read also asks the OS to
+ * prefetch the window of the file right after it, so that the decoder reading
+ * sequentially through the I/O object rarely blocks on the disk.
+ *
+ * @param io        the I/O object to open
+ * @param filename  the filename to open
+ * @param readahead points to the size, in bytes, of the read-ahead window,
+ *                  which is read on every read so it can be changed at any
+ *                  time; must stay valid until `close' is called
+ */
+seal_err_t _seal_open_readahead_file_io(seal_io_t*,
+                                        const char* /*filename*/,
+                                        const size_t* /*readahead*/);
+
+/*
+ * Opens an I/O object on a block of memory. The memory is not copied so it
+ * must stay valid until `close' is called on the I/O object.
+ *
+ * @param io        the I/O object to open
+ * @param data      the memory to read from
+ * @param size      the size, in bytes, of the memory
+ */
+seal_err_t _seal_open_mem_io(seal_io_t*, const void* /*data*/, size_t);
+
+#endif /* _SEAL_IO_H_ */
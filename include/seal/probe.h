@@ -0,0 +1,132 @@
+/*
+ * Interfaces for learning about audio files without decoding them. Probing a
+ * file only reads as much of it as needed to know its format, attributes and
+ * length, so that tools and loaders can plan memory use and decide between
+ * buffers and streams up front.
+ *
+ * Probing thousands of files on every run can still be slow, so probe results
+ * can be kept in a manifest, which is a cache saved to disk. An entry in a
+ * manifest is keyed by the path of the file as passed in together with its
+ * size and modification time, so a file that changes is probed again.
+ */
+
+#ifndef _SEAL_PROBE_H_
+#define _SEAL_PROBE_H_
+
+#include <stddef.h>
+#include "raw.h"
+#include "fmt.h"
+#include "err.h"
+
+typedef struct seal_audio_info_t seal_audio_info_t;
+typedef struct seal_manifest_t seal_manifest_t;
+
+/*
+ * fmt      the format of the audio file
+ * attr     the attribute of the PCM data the file decodes to
+ * nframes  the total number of sample frames or 0 if unknown; estimated from
+ *          the bitrate for MPEG audio without a Xing or LAME header
+ * seekable 1 if the file can be seeked or otherwise 0
+ */
+struct seal_audio_info_t
+{
+    seal_fmt_t      fmt;
+    seal_raw_attr_t attr;
+    size_t          nframes;
+    char            seekable;
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Probes an audio file for its format, attributes and length without
+ * decoding it.
+ *
+ * @param filename  the filename of the audio
+ * @param info      the receiver of the information
+ */
+seal_err_t SEAL_API seal_probe(const char* /*filename*/, seal_audio_info_t*);
+
+/*
+ * Initializes a new, empty manifest. If the manifest is no longer needed,
+ * call `seal_destroy_manifest' to release the resources used by it.
+ *
+ * @param manifest  the manifest to initialize
+ */
+seal_err_t SEAL_API seal_init_manifest(seal_manifest_t*);
+
+/*
+ * Destroys a manifest.
+ *
+ * @param manifest  the manifest to destroy
+ */
+seal_err_t SEAL_API seal_destroy_manifest(seal_manifest_t*);
+
+/*
+ * Adds the entries saved in a manifest file to a manifest. Entries already
+ * in the manifest are replaced. A missing manifest file is treated as an
+ * empty one and malformed lines are skipped, since a manifest is only a
+ * cache.
+ *
+ * @param manifest  the manifest to add the entries to
+ * @param filename  the filename of the manifest file
+ */
+seal_err_t SEAL_API seal_load_manifest(seal_manifest_t*,
+                                       const char* /*filename*/);
+
+/*
+ * Saves all the entries of a manifest to a manifest file, overwriting it.
+ *
+ * @param manifest  the manifest to save
+ * @param filename  the filename of the manifest file
+ */
+seal_err_t SEAL_API seal_save_manifest(seal_manifest_t*,
+                                       const char* /*filename*/);
+
+/*
+ * Same as `seal_probe' except that the information is taken from a manifest
+ * if it has an entry for the file with the current size and modification
+ * time of the file, in which case only the metadata of the file is read.
+ * Otherwise the file is probed and the result recorded in the manifest.
+ *
+ * @param manifest  the manifest to look up and update
+ * @param filename  the filename of the audio
+ * @param info      the receiver of the information
+ */
+seal_err_t SEAL_API seal_probe_cached(seal_manifest_t*,
+                                      const char* /*filename*/,
+                                      seal_audio_info_t*);
+
+/*
+ * Gets the number of entries in a manifest.
+ *
+ * @param manifest  the manifest
+ * @param psize     the receiver of the number of entries
+ */
+seal_err_t SEAL_API seal_get_manifest_size(seal_manifest_t*,
+                                           size_t* /*psize*/);
+
+#ifdef __cplusplus
+}
+#endif
+
+/*
+ *****************************************************************************
+ * Below are **implementation details**.
+ *****************************************************************************
+ */
+
+struct seal_manifest_t
+{
+    /* Array of entries. */
+    void*  entries;
+    size_t nentries;
+    size_t capacity;
+    /* Open-addressing hash table of one-based indices into `entries'. */
+    size_t* buckets;
+    size_t nbuckets;
+};
+
+#endif /* _SEAL_PROBE_H_ */
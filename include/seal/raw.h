@@ -75,6 +75,27 @@ seal_err_t seal_extend_raw_data(seal_raw_t*);
  */
 seal_err_t seal_ensure_raw_data_size(seal_raw_t*, size_t);
 
+/*
+ * Resamples 8- or 16-bit mono or stereo PCM data to another frequency with a
+ * high-quality polyphase filter.
+ *
+ * @param raw   the raw structure with the `data' field to resample; the
+ *              `data' field will be reallocated and the `size' and `freq'
+ *              fields adjusted; will be left untouched if an error occurs
+ * @param freq  the frequency to resample to
+ */
+seal_err_t seal_resample_raw(seal_raw_t*, int /*freq*/);
+
+/*
+ * Downmixes 8- or 16-bit stereo PCM data to mono in place by averaging the
+ * two channels. Data with any other number of channels is left untouched.
+ *
+ * @param raw   the raw structure with the `data' field to downmix; the `data'
+ *              field will be shrunk and the `size' and `nchannels' fields
+ *              adjusted
+ */
+seal_err_t seal_downmix_raw(seal_raw_t*);
+
 #ifdef __cplusplus
 }
 #endif
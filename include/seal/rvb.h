@@ -163,6 +163,29 @@ enum seal_rvb_preset_t
 
 typedef struct seal_rvb_t seal_rvb_t;
 typedef enum seal_rvb_preset_t seal_rvb_preset_t;
+typedef struct seal_rvb_params_t seal_rvb_params_t;
+
+/*
+ * The parameters of a reverb, each of which is described along with its
+ * `seal_set_rvb_*' setter. Holding them in a struct lets a preset or a blend
+ * of presets be computed without touching a reverb object.
+ */
+struct seal_rvb_params_t
+{
+    float   density;
+    float   diffusion;
+    float   gain;
+    float   hfgain;
+    float   decay_time;
+    float   hfdecay_ratio;
+    float   reflections_gain;
+    float   reflections_delay;
+    float   late_gain;
+    float   late_delay;
+    float   air_absorbtion_hfgain;
+    float   room_rolloff_factor;
+    char    hfdecay_limited;
+};
 
 #ifdef __cplusplus
 extern "C" {
@@ -194,6 +217,29 @@ seal_err_t SEAL_API seal_destroy_rvb(seal_rvb_t*);
  */
 seal_err_t SEAL_API seal_load_rvb(seal_rvb_t*, seal_rvb_preset_t);
 
+/*
+ * Gets the parameters of a reverb preset without loading it into a reverb.
+ *
+ * @param preset    the preset
+ * @param params    the receiver of the parameters
+ */
+seal_err_t SEAL_API seal_get_rvb_preset(
+    seal_rvb_preset_t,
+    seal_rvb_params_t* /*params*/
+);
+
+/*
+ * Sets all the parameters of a reverb at once, checking for errors once
+ * rather than after every parameter.
+ *
+ * @param reverb    the reverb to set the parameters of
+ * @param params    the parameters to set
+ */
+seal_err_t SEAL_API seal_set_rvb_params(
+    seal_rvb_t*,
+    const seal_rvb_params_t* /*params*/
+);
+
 /*
  * Sets the modal density of a reverb in the interval [0.0f, 1.0f]. The
  * density controls the coloration of the late reverb. The Lower the value,
@@ -11,6 +11,7 @@
 #include <stddef.h>
 #include "buf.h"
 #include "stream.h"
+#include "cbuf.h"
 #include "efs.h"
 #include "err.h"
 
@@ -76,7 +77,10 @@ seal_err_t SEAL_API seal_destroy_src(seal_src_t*);
  * rewind the stream to the beginning. Applying to a `SEAL_INITIAL' or
  * `SEAL_STOPPED' source will start start playing and change its state to
  * `SEAL_PLAYING'. Applying to a `SEAL_PAUSED' source will resume playing and
- * change its state to `SEAL_PLAYING'.
+ * change its state to `SEAL_PLAYING'. If the attached stream is still being
+ * opened by `seal_open_stream_async', this returns immediately and the
+ * source stays in its current state until a background thread has filled
+ * the queue once the stream is opened, at which point playback starts.
  *
  * @param src   the source to play
  */
@@ -120,6 +124,20 @@ seal_err_t SEAL_API seal_rewind_src(seal_src_t*);
  */
 seal_err_t SEAL_API seal_move_src(seal_src_t*);
 
+/*
+ * Moves many sources at once, adding to the position of each source its
+ * velocity scaled by `dt'. Only the positions of sources that are moving are
+ * sent to OpenAL, all in one batch, so this is much faster than calling
+ * `seal_move_src' on each source.
+ *
+ * @param srcs  the array of sources to move
+ * @param n     the number of sources
+ * @param dt    the factor to scale the velocities by, usually the time
+ *              elapsed since the last move
+ */
+seal_err_t SEAL_API seal_move_srcs(seal_src_t** /*srcs*/, size_t /*n*/,
+                                   float /*dt*/);
+
 /*
  * Associates a buffer with a source so that the source is ready to play the
  * audio contained in the buffer. Can be applied only to sources in the
@@ -142,13 +160,34 @@ seal_err_t SEAL_API seal_set_src_buf(seal_src_t*, seal_buf_t*);
  * at the front of the streaming queue waiting to be played. If successful,
  * the source will become or remain the `SEAL_STREAMING' type. The streaming
  * queue will be filled after this call returns; after the queue starts to be
- * played, `seal_update_src' should be called to refill the queue.
+ * played, `seal_update_src' should be called to refill the queue. A stream
+ * still being opened by `seal_open_stream_async' can be attached as well, in
+ * which case any old queue is emptied and the queue is filled later by
+ * `seal_play_src' without blocking.
  *
  * @param src       the source to associate the stream `stream' with
  * @param stream    the stream to associate the source `src' with
  */
 seal_err_t SEAL_API seal_set_src_stream(seal_src_t*, seal_stream_t*);
 
+/*
+ * Associates a loaded compressed buffer with a source. The source opens a
+ * private stream on the memory of the compressed buffer and decodes from it
+ * as it plays, so it behaves like a source associated with a stream. Can be
+ * applied to sources in any playing state but not on the `SEAL_STATIC' type
+ * of source nor on sources associated with a stream by
+ * `seal_set_src_stream'. Replacing an attached compressed buffer with a
+ * different one stops the source. If successful, the source will become or
+ * remain the `SEAL_STREAMING' type. The compressed buffer must outlive the
+ * association. Passing 0 (null pointer) detaches the compressed buffer like
+ * `seal_detach_src_audio', and does nothing if there is none.
+ *
+ * @param src   the source to associate the compressed buffer `cbuf' with
+ * @param cbuf  the compressed buffer to associate the source `src' with, or
+ *              0 to detach the current one
+ */
+seal_err_t SEAL_API seal_set_src_cbuf(seal_src_t*, seal_cbuf_t*);
+
 /*
  * Feeds an effect slot with the output of a source so the output is filtered
  * based on the effect attached to the slot. Later calls to this function with
@@ -247,6 +286,27 @@ seal_err_t SEAL_API seal_set_src_vel(
     float /*z*/
 );
 
+/*
+ * Sets the positions and velocities of many sources at once. This is much
+ * faster than setting them one source at a time since OpenAL errors are only
+ * checked once at the end, and the changes are applied to the mix at once
+ * where `AL_SOFT_deferred_updates' is available. Use of NaN and infinity is
+ * undefined.
+ *
+ * @param srcs  the array of sources to set the transforms of
+ * @param n     the number of sources
+ * @param pos   the array of `n' packed x, y, z positions, or 0 to leave the
+ *              positions alone
+ * @param vel   the array of `n' packed x, y, z velocities, or 0 to leave the
+ *              velocities alone
+ */
+seal_err_t SEAL_API seal_set_src_transforms(
+    seal_src_t** /*srcs*/,
+    size_t /*n*/,
+    const float* /*pos*/,
+    const float* /*vel*/
+);
+
 /*
  * Sets the pitch shift multiplier of a source. 1.0f means identity; each
  * reduction by 1/2 means a pitch shift of -12 semitones; each doubling means
@@ -266,6 +326,39 @@ seal_err_t SEAL_API seal_set_src_pitch(seal_src_t*, float /*pitch*/);
  */
 seal_err_t SEAL_API seal_set_src_gain(seal_src_t*, float /*gain*/);
 
+/*
+ * Sets the rolloff factor of a source, which scales how fast its gain falls
+ * off with distance under the distance model set by
+ * `seal_set_distance_model'. 0.0f disables distance attenuation for the
+ * source.
+ *
+ * @param src       the source to set the rolloff factor of
+ * @param factor    the rolloff factor in the interval [0.0f, +inf.)
+ */
+seal_err_t SEAL_API seal_set_src_rolloff_factor(seal_src_t*,
+                                                float /*factor*/);
+
+/*
+ * Sets the reference distance of a source, the distance at which its gain is
+ * not attenuated by distance. Clamped distance models do not amplify the
+ * source any closer.
+ *
+ * @param src   the source to set the reference distance of
+ * @param dist  the reference distance in the interval [0.0f, +inf.)
+ */
+seal_err_t SEAL_API seal_set_src_ref_dist(seal_src_t*, float /*dist*/);
+
+/*
+ * Sets the maximum distance of a source, beyond which clamped distance models
+ * stop attenuating it. Linear clamped models attenuate it to silence at the
+ * maximum distance. Sources added to a culler are also culled beyond their
+ * maximum distance; see `seal_cull_srcs'.
+ *
+ * @param src   the source to set the maximum distance of
+ * @param dist  the maximum distance in the interval [0.0f, +inf.)
+ */
+seal_err_t SEAL_API seal_set_src_max_dist(seal_src_t*, float /*dist*/);
+
 /*
  * Sets whether a source should be automatically updated asynchronously by a
  * background thread. If this thread is running, user calls to seal_update_src
@@ -316,6 +409,15 @@ seal_buf_t* SEAL_API seal_get_src_buf(seal_src_t*);
  */
 seal_stream_t* SEAL_API seal_get_src_stream(seal_src_t*);
 
+/*
+ * Gets the compressed buffer of a source. The default is 0 (null pointer).
+ *
+ * @see         seal_set_src_cbuf
+ * @param src   the source to get the compressed buffer of
+ * @return      the compressed buffer
+ */
+seal_cbuf_t* SEAL_API seal_get_src_cbuf(seal_src_t*);
+
 /*
  * Gets the size, in byte, of a source's streaming queue. The default is 3.
  *
@@ -385,6 +487,35 @@ seal_err_t SEAL_API seal_get_src_pitch(seal_src_t*, float* /*ppitch*/);
  */
 seal_err_t SEAL_API seal_get_src_gain(seal_src_t*, float* /*pgain*/);
 
+/*
+ * Gets the rolloff factor of a source. The default is 1.0f.
+ *
+ * @see             seal_set_src_rolloff_factor
+ * @param src       the source to get the rolloff factor of
+ * @param pfactor   the receiver of the rolloff factor
+ */
+seal_err_t SEAL_API seal_get_src_rolloff_factor(seal_src_t*,
+                                                float* /*pfactor*/);
+
+/*
+ * Gets the reference distance of a source. The default is 1.0f.
+ *
+ * @see         seal_set_src_ref_dist
+ * @param src   the source to get the reference distance of
+ * @param pdist the receiver of the reference distance
+ */
+seal_err_t SEAL_API seal_get_src_ref_dist(seal_src_t*, float* /*pdist*/);
+
+/*
+ * Gets the maximum distance of a source. The default is `FLT_MAX', which
+ * means no maximum distance.
+ *
+ * @see         seal_set_src_max_dist
+ * @param src   the source to get the maximum distance of
+ * @param pdist the receiver of the maximum distance
+ */
+seal_err_t SEAL_API seal_get_src_max_dist(seal_src_t*, float* /*pdist*/);
+
 /*
  * Determines if a source is automatically updated. The default is true
  * (nonzero).
@@ -458,6 +589,54 @@ struct seal_src_t
     unsigned int   looping      : 1;
     unsigned int   automatic    : 1;
     unsigned int   early_stop   : 1;
+    /*
+     * The updater `updater' only primes the queue of a manual source whose
+     * stream was still being opened, after which the caller takes over.
+     */
+    unsigned int   priming      : 1;
+    /* Copy of `AL_SOURCE_RELATIVE'. */
+    unsigned int   relative     : 1;
+    /* Paused by the culler `culler' rather than by the caller. */
+    unsigned int   culled       : 1;
+    /* The stream `stream' is privately opened on this if not 0. */
+    seal_cbuf_t*   cbuf;
+    /* Resamples streamed chunks to the mixing frequency if not 0. */
+    void*          resampler;
+    /*
+     * Copies of the properties last set, so that reading or integrating them
+     * never has to go through OpenAL.
+     */
+    float          pos[3];
+    float          vel[3];
+    float          gain;
+    float          pitch;
+    float          max_dist;
+    /*
+     * The culler indexing this source if not 0, and the slot of the source
+     * in it.
+     */
+    void*          culler;
+    size_t         cull_slot;
+    /*
+     * The context bound to the thread that created the source, which the
+     * updater thread binds too; 0 for the context current for the process.
+     */
+    void*          context;
 };
 
+/*
+ * Does one round of the work of updater threads on the sources rendered by
+ * `seal_render', which get no updater threads.
+ *
+ * @return  the first error encountered; the round still goes through the
+ *          other sources
+ */
+seal_err_t _seal_update_rendered_srcs(void);
+
+/* Sets up the list of sources rendered by `seal_render' on loopback. */
+seal_err_t _seal_init_rendered_srcs(void);
+
+/* Releases the list of sources rendered by `seal_render'. */
+void _seal_forget_rendered_srcs(void);
+
 #endif /* _SEAL_SRC_H_ */
@@ -20,10 +20,21 @@
 #include <stddef.h>
 #include "raw.h"
 #include "fmt.h"
+#include "io.h"
 
 /* Audio stream data. */
 typedef struct seal_stream_t seal_stream_t;
 
+/*
+ * Called when a stream opened by `seal_open_stream_async' is opened or has
+ * failed to open.
+ *
+ * @param stream    the stream
+ * @param err       the result of opening the stream
+ * @param data      the user data passed to `seal_open_stream_async'
+ */
+typedef void seal_stream_cb_t(seal_stream_t*, seal_err_t, void* /*data*/);
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -44,6 +55,74 @@ seal_err_t SEAL_API seal_open_stream(
     seal_fmt_t
 );
 
+/*
+ * Same as `seal_open_stream' except that the encoded audio is read through
+ * the callbacks of an I/O object rather than from a file, so that audio can
+ * be streamed from archives or other virtual file systems. The callbacks are
+ * called on whatever thread reads from the stream, including the updater
+ * threads of streaming sources. Read-ahead hints only apply to files, so the
+ * I/O object is responsible for its own buffering.
+ *
+ * @param stream    the stream to open
+ * @param io        the I/O object to read the audio from; the stream takes
+ *                  the ownership of it whether or not this function succeeds
+ *                  and calls `io->close' when the stream is closed
+ * @param fmt       the format of the audio; automatic recognition of the
+ *                  audio format will be attempted if the passed-in `fmt' is
+ *                  `SEAL_UNKNOWN_FMT', in which case `io' must be able to
+ *                  seek
+ */
+seal_err_t SEAL_API seal_open_stream_io(seal_stream_t*, seal_io_t*,
+                                        seal_fmt_t);
+
+/*
+ * Same as `seal_open_stream' except that the stream is opened on a worker
+ * thread (see `seal_set_worker_count'), so that parsing headers (and, for
+ * Ogg Vorbis, seeking across the file to find its length) does not block the
+ * caller. The stream can be attached to a source and the source played right
+ * away; the source will start once the stream is opened and its queue is
+ * filled. Other operations on the stream block until the stream is opened.
+ * Call `seal_close_stream' when the stream is no longer needed even if it
+ * fails to open.
+ *
+ * @param stream    the stream to open
+ * @param filename  the filename of the audio
+ * @param fmt       the format of the audio file; automatic recognition of the
+ *                  audio format will be attempted if the passed-in `fmt' is
+ *                  `SEAL_UNKNOWN_FMT'
+ * @param callback  called on a worker thread once the stream is opened or
+ *                  has failed to open, or 0; must not call
+ *                  `seal_close_stream' on the stream
+ * @param data      the user data passed to `callback'
+ */
+seal_err_t SEAL_API seal_open_stream_async(
+    seal_stream_t*,
+    const char* /*filename*/,
+    seal_fmt_t,
+    seal_stream_cb_t* /*callback*/,
+    void* /*data*/
+);
+
+/*
+ * Determines if a stream is still being opened by `seal_open_stream_async'.
+ *
+ * @param stream    the stream
+ * @param popening  the receiver of 1 if the stream is still being opened or
+ *                  otherwise 0
+ */
+seal_err_t SEAL_API seal_is_stream_opening(seal_stream_t*,
+                                           char* /*popening*/);
+
+/*
+ * Waits until a stream opened by `seal_open_stream_async' is opened or has
+ * failed to open. Returns immediately for streams opened otherwise. Gives up
+ * with `SEAL_CANCELED' once the flag set by `seal_set_cancel_flag' is set.
+ *
+ * @param stream    the stream to wait for
+ * @return          the result of opening the stream
+ */
+seal_err_t SEAL_API seal_wait_stream(seal_stream_t*);
+
 /*
  * Streams from an opened stream.
  *
@@ -65,6 +144,28 @@ seal_err_t SEAL_API seal_stream(
     size_t* /*psize*/
 );
 
+/*
+ * Same as `seal_stream' except that the PCM data are decoded to memory
+ * supplied by the caller instead of newly allocated memory, so that the same
+ * memory can be reused for every chunk.
+ *
+ * @param stream    the opened stream to stream from
+ * @param raw       the receiver of the streamed PCM data; `raw->data' should
+ *                  point to `raw->size' bytes of writable memory prior to this
+ *                  call; `raw->size' and `raw->attr' will be set to the size
+ *                  and attribute of the streamed data if successful; ADPCM
+ *                  WAVE streams decode whole blocks only, so `raw->size' must
+ *                  be at least the size of a decoded block, commonly 2 to 8
+ *                  KiB, or `SEAL_BAD_VAL' is returned
+ * @param psize     the receiver of the actual size, in bytes, of streamed
+ *                  data, which is 0 at the end of the stream
+ */
+seal_err_t SEAL_API seal_stream_into(
+    seal_stream_t*,
+    seal_raw_t*,
+    size_t* /*psize*/
+);
+
 /*
  * Rewinds a stream to the beginning.
  *
@@ -80,16 +181,72 @@ seal_err_t SEAL_API seal_rewind_stream(seal_stream_t*);
  */
 seal_err_t SEAL_API seal_close_stream(seal_stream_t*);
 
+/*
+ * Sets whether streams are opened in fast mode. Opening an Ogg Vorbis file
+ * normally seeks across the whole file to find its chained links and total
+ * length before the first sample can be decoded. In fast mode that scan is
+ * skipped and decoding starts right after the headers; rewinding decodes the
+ * file from the start again. Chained files still play through, but the audio
+ * format must not change between links. Only affects file streams opened
+ * afterwards. The default is 0 (off).
+ *
+ * @param fast  1 to open streams in fast mode or otherwise 0
+ */
+void SEAL_API seal_set_fast_stream_open(char /*fast*/);
+
+/*
+ * @return  1 if streams are opened in fast mode or otherwise 0
+ */
+char SEAL_API seal_is_fast_stream_open(void);
+
+/*
+ * Sets the size of the read-ahead window of a stream opened from a file. Each
+ * time the stream reads from the file, it asks the OS to fetch this many
+ * bytes past the read into the page cache in the background, so that later
+ * reads done when sources are refilled rarely block on the disk. Takes effect
+ * immediately and is reset by `seal_open_stream'. 0 disables read-ahead
+ * hints.
+ *
+ * @param stream    the stream to set the read-ahead window of
+ * @param size      the size, in bytes, of the read-ahead window
+ */
+seal_err_t SEAL_API seal_set_stream_readahead(seal_stream_t*,
+                                              size_t /*size*/);
+
+/*
+ * Gets the size of the read-ahead window of a stream. The default is 262144.
+ *
+ * @param stream    the stream to get the read-ahead window of
+ * @param psize     the receiver of the size, in bytes
+ */
+seal_err_t SEAL_API seal_get_stream_readahead(seal_stream_t*,
+                                              size_t* /*psize*/);
+
 #ifdef __cplusplus
 }
 #endif
 
+/*
+ *****************************************************************************
+ * Below are **implementation details**.
+ *****************************************************************************
+ */
+
 struct seal_stream_t
 {
     /* Tagged union of identifiers used by different decoder libraries. */
     void*           id;
     seal_fmt_t      fmt;
     seal_raw_attr_t attr;
+    /* Size of the read-ahead window of file streams. */
+    size_t          readahead;
+    /* State of `seal_open_stream_async' if not 0. */
+    void*           opener;
 };
 
+/*
+ * @return  non-zero if the stream is still being opened in the background
+ */
+int _seal_is_stream_opening(seal_stream_t*);
+
 #endif /* _SEAL_STREAM_H_ */
@@ -0,0 +1,89 @@
+/*
+ * Interfaces for writing audio to WAVE files, such as a mix rendered by
+ * `seal_render' or PCM data decoded from streams. Samples are converted to
+ * the bit depth of the file as they are written and collected in a large
+ * buffer so that the file is written in few big blocks; the sizes in the
+ * header are filled in when the writer is closed.
+ */
+
+#ifndef _SEAL_WRITER_H_
+#define _SEAL_WRITER_H_
+
+#include <stddef.h>
+#include "raw.h"
+#include "err.h"
+
+typedef struct seal_writer_t seal_writer_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Creates or truncates a WAVE file and opens a writer on it. If the writer
+ * is no longer needed, call `seal_close_writer' to finish the file and
+ * release the resources used by the writer.
+ *
+ * @param writer    the writer to open
+ * @param filename  the filename of the file to write
+ * @param attr      the attribute of the file; `bit_depth' is 16 or 24 for
+ *                  integer samples or 32 for float samples
+ */
+seal_err_t SEAL_API seal_open_writer(
+    seal_writer_t*,
+    const char* /*filename*/,
+    const seal_raw_attr_t* /*attr*/
+);
+
+/*
+ * Writes PCM data, as filled by `seal_stream' or rendered by `seal_render',
+ * to a writer. The data must have the same number of channels and frequency
+ * as the writer and be made of whole frames; 8-bit samples are unsigned,
+ * 16-bit and float samples are in native byte order and 24-bit samples are
+ * little-endian. A `bit_depth' of 32 means float samples.
+ *
+ * @param writer    the writer to write to
+ * @param raw       the data to write
+ */
+seal_err_t SEAL_API seal_write_raw(seal_writer_t*, const seal_raw_t* /*raw*/);
+
+/*
+ * Writes what is left in the buffer of a writer, fills in the header and
+ * closes the file. Does nothing if the writer is already closed.
+ *
+ * @param writer    the writer to close
+ */
+seal_err_t SEAL_API seal_close_writer(seal_writer_t*);
+
+/*
+ * Gets the number of frames written to a writer.
+ *
+ * @param writer    the writer
+ * @param pnframes  the receiver of the number of frames
+ */
+seal_err_t SEAL_API seal_get_writer_nframes(seal_writer_t*,
+                                            size_t* /*pnframes*/);
+
+#ifdef __cplusplus
+}
+#endif
+
+/*
+ *****************************************************************************
+ * Below are **implementation details**.
+ *****************************************************************************
+ */
+
+struct seal_writer_t
+{
+    void*           file;
+    seal_raw_attr_t attr;
+    /* The samples converted but not yet written to the file. */
+    unsigned char*  buf;
+    size_t          buf_len;
+    size_t          buf_cap;
+    /* The size of the samples written so far, in bytes. */
+    unsigned long   data_size;
+};
+
+#endif /* _SEAL_WRITER_H_ */
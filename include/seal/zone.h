@@ -0,0 +1,129 @@
+/*
+ * Interfaces for reverb zones, which change the reverberation of effect slots
+ * as the listener moves between places. A zone is a sphere with the reverb
+ * parameters of the place; the listener hears it fully inside and fading out
+ * over some distance beyond. Where zones overlap, their parameters are
+ * interpolated by how much the listener is in each of them, so walking from
+ * one room into another changes the reverberation gradually. A zone set owns
+ * a small pool of effect slots, each with its own reverb, and writes to the
+ * reverbs once per frame only the parameters that changed. Sources are fed
+ * to the slots like to any other effect slot.
+ */
+
+#ifndef _SEAL_ZONE_H_
+#define _SEAL_ZONE_H_
+
+#include <stddef.h>
+#include "efs.h"
+#include "rvb.h"
+#include "err.h"
+
+typedef struct seal_zone_t seal_zone_t;
+typedef struct seal_zones_t seal_zones_t;
+
+/*
+ * pos      the center of the zone
+ * radius   the distance from the center within which the listener is fully
+ *          in the zone
+ * fade     the distance beyond `radius' over which the zone fades out
+ * slot     the index of the effect slot the zone sets the reverb of
+ * params   the reverb parameters of the zone
+ */
+struct seal_zone_t
+{
+    float               pos[3];
+    float               radius;
+    float               fade;
+    size_t              slot;
+    seal_rvb_params_t   params;
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Initializes a new zone set with its pool of effect slots, each of which is
+ * loaded with a reverb. The slots are muted until the listener gets in one
+ * of their zones. If the zone set is no longer needed, call
+ * `seal_destroy_zones' to release the resources used by it.
+ *
+ * There is a limit on the number of allocated effect slots. This function
+ * returns an error if it is exceeding the limit.
+ *
+ * @param zones     the zone set to initialize
+ * @param nslots    the number of effect slots
+ */
+seal_err_t SEAL_API seal_init_zones(seal_zones_t*, size_t /*nslots*/);
+
+/*
+ * Destroys a zone set along with its effect slots.
+ *
+ * @param zones     the zone set to destroy
+ */
+seal_err_t SEAL_API seal_destroy_zones(seal_zones_t*);
+
+/*
+ * Replaces the zones of a zone set with copies of some zones. The effect
+ * slots change on the next update.
+ *
+ * @param zones     the zone set
+ * @param zone_arr  the zones to copy
+ * @param nzones    the number of zones
+ */
+seal_err_t SEAL_API seal_set_zones(
+    seal_zones_t*,
+    const seal_zone_t* /*zone_arr*/,
+    size_t /*nzones*/
+);
+
+/*
+ * Updates the effect slots of a zone set for the current listener position,
+ * usually once per frame. The reverb of each slot gets the parameters of its
+ * zones weighted by how much the listener is in each of them, and the slot
+ * gain becomes the sum of the weights up to 1, so a slot fades out as the
+ * listener leaves all its zones. Nothing is written for parameters that
+ * have not changed since the last update.
+ *
+ * @param zones     the zone set to update
+ */
+seal_err_t SEAL_API seal_update_zones(seal_zones_t*);
+
+/*
+ * Gets an effect slot of a zone set, which sources can be fed to with
+ * `seal_feed_efs'. Its effect and gain are managed by the zone set.
+ *
+ * @param zones     the zone set
+ * @param slot      the index of the effect slot
+ * @return          the effect slot or 0 if the index is out of range
+ */
+seal_efs_t* SEAL_API seal_get_zones_efs(seal_zones_t*, size_t /*slot*/);
+
+/*
+ * Gets the number of zones in a zone set.
+ *
+ * @param zones     the zone set
+ * @param psize     the receiver of the number of zones
+ */
+seal_err_t SEAL_API seal_get_zones_size(seal_zones_t*, size_t* /*psize*/);
+
+#ifdef __cplusplus
+}
+#endif
+
+/*
+ *****************************************************************************
+ * Below are **implementation details**.
+ *****************************************************************************
+ */
+
+struct seal_zones_t
+{
+    /* Array of the effect slots along with their reverbs and last writes. */
+    void*           slots;
+    size_t          nslots;
+    seal_zone_t*    zones;
+    size_t          nzones;
+};
+
+#endif /* _SEAL_ZONE_H_ */
@@ -1,4 +1,5 @@
 require 'spec_helper'
+require 'objspace'
 
 describe Buffer do
   it_behaves_like 'an audio object with format'
@@ -15,6 +16,50 @@ describe Buffer do
     end
   end
 
+  [IMA_ADPCM_PATH, MS_ADPCM_PATH].each do |path|
+    context "read from #{File.basename(path)}" do
+      subject { Buffer.new(path) }
+      its(:channel_count) { is_expected.to eq 1 }
+      its(:frequency) { is_expected.to eq 11_025 }
+      # Either kept in ADPCM by OpenAL or decoded to 16-bit PCM.
+      its(:bit_depth) { is_expected.to eq(4).or eq(16) }
+    end
+  end
+
+  context 'read from a stereo file' do
+    it 'keeps both channels by default' do
+      buffer = Buffer.new(STEREO_WAV_PATH)
+      expect(buffer.channel_count).to eq 2
+      expect(buffer.size).to eq 4500
+    end
+
+    it 'can be downmixed to mono' do
+      buffer = Buffer.new(STEREO_WAV_PATH, mono: true)
+      expect(buffer.channel_count).to eq 1
+      expect(buffer.size).to eq 2250
+      buffer.load(STEREO_WAV_PATH, Format::WAV, mono: true)
+      expect(buffer.channel_count).to eq 1
+    end
+  end
+
+  describe 'created from PCM data' do
+    let(:pcm) { Stream.new(STEREO_WAV_PATH).read(4500) }
+
+    it 'takes the given attributes' do
+      buffer = Buffer.from_pcm(pcm, frequency: 11_025, channels: 2,
+                                    bit_depth: 8)
+      expect(buffer.size).to eq 4500
+      expect(buffer.frequency).to eq 11_025
+      expect(buffer.channel_count).to eq 2
+      expect(buffer.bit_depth).to eq 8
+    end
+
+    it 'requires all the attributes' do
+      expect { Buffer.from_pcm(pcm, frequency: 11_025, channels: 2) }
+        .to raise_error KeyError
+    end
+  end
+
   it 'cannot be changed if it is being used by a source' do
     error_pattern = /Invalid operation/
     source = Source.new
@@ -34,4 +79,32 @@ describe Buffer do
     # Not being used by any source.
     expect { buffer.load(WAV_PATH) }.to_not raise_error
   end
+
+  it 'can be loaded on other threads while the main thread runs' do
+    ticks = 0
+    loader = Thread.new { Array.new(4) { Buffer.new(OV_PATH) } }
+    ticks += 1 while loader.alive?
+    expect(loader.value.map(&:frequency)).to all eq 44_100
+    expect(ticks).to be > 0
+  end
+
+  it 'can be loaded on other Ractors and shared once frozen' do
+    skip 'native extension only' if defined?(SealAPI)
+    skip 'Ractor is not supported' unless defined?(Ractor)
+    ractor = Ractor.new(OV_PATH) do |path|
+      Ractor.make_shareable(Seal::Buffer.new(path))
+    end
+    buffer = ractor.take
+    expect(Ractor.shareable?(buffer)).to be true
+    expect(buffer.frequency).to eq 44_100
+    expect { buffer.load(WAV_PATH) }.to raise_error FrozenError
+  end
+
+  it 'reports the size of its audio to ObjectSpace' do
+    skip 'native extension only' if defined?(SealAPI)
+    buffer = Buffer.new(WAV_PATH)
+    expect(ObjectSpace.memsize_of(buffer)).to be >= buffer.size
+    buffer.load(OV_PATH)
+    expect(ObjectSpace.memsize_of(buffer)).to be >= buffer.size
+  end
 end
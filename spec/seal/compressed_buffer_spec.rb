@@ -0,0 +1,47 @@
+require 'spec_helper'
+
+describe CompressedBuffer do
+  context 'read from the Ogg Vorbis file' do
+    subject { CompressedBuffer.new(OV_PATH) }
+    its(:bit_depth) { is_expected.to eq 16 }
+    its(:channel_count) { is_expected.to eq 1 }
+    its(:frequency) { is_expected.to eq 44_100 }
+    its(:size) { is_expected.to eq File.size(OV_PATH) }
+  end
+
+  it 'fails when reading the WAVE file' do
+    expect { CompressedBuffer.new(WAV_PATH) }.to raise_error /unsupported/
+  end
+
+  it 'fails when reading OV with MPG format specified' do
+    expect do
+      CompressedBuffer.new(OV_PATH, Format::MPG)
+    end.to raise_error /MPEG/
+  end
+
+  it 'can be shared by several sources' do
+    compressed_buffer = CompressedBuffer.new(OV_PATH)
+    sources = Array.new(2) { Source.new }
+    sources.each do |source|
+      source.compressed_buffer = compressed_buffer
+      expect(source.compressed_buffer).to be compressed_buffer
+      expect(source.type).to be Source::Type::STREAMING
+      source.play
+    end
+    sources.each { |source| source.compressed_buffer = nil }
+  end
+
+  it 'cannot be attached to a source with a buffer or stream' do
+    compressed_buffer = CompressedBuffer.new(OV_PATH)
+    source = Source.new
+    source.buffer = Buffer.new(OV_PATH)
+    expect do
+      source.compressed_buffer = compressed_buffer
+    end.to raise_error /Cannot attach/
+    source.buffer = nil
+    source.stream = Stream.new(OV_PATH)
+    expect do
+      source.compressed_buffer = compressed_buffer
+    end.to raise_error /Cannot attach/
+  end
+end
@@ -0,0 +1,46 @@
+require 'spec_helper'
+
+describe Context do
+  let(:context) { Context.new }
+
+  after { Seal.listener.position = [0, 0, 0] }
+
+  it 'tells whether contexts can be bound to threads' do
+    expect([true, false]).to include Seal.thread_local_context?
+  end
+
+  it 'fails to open unknown devices' do
+    expect { Context.new('no such device') }.to raise_error SealError
+  end
+
+  it 'is used for the duration of a block' do
+    expect(context.use { Source.new; 42 }).to eq 42
+    expect(context.use).to be context
+    expect(Context.unbind).to be nil
+  end
+
+  it 'keeps a listener of its own' do
+    Seal.listener.position = [1, 2, 3]
+    context.use do
+      expect(Seal.listener.position).to eq [0, 0, 0]
+      Seal.listener.position = [4, 5, 6]
+    end
+    expect(Seal.listener.position).to eq [1, 2, 3]
+    context.use { expect(Seal.listener.position).to eq [4, 5, 6] }
+  end
+
+  it 'can be driven by a thread of its own' do
+    next unless Seal.thread_local_context?
+    contexts = Array.new(2) { Context.new }
+    threads = contexts.each_with_index.map do |context, i|
+      Thread.new do
+        context.use do
+          100.times { Seal.batch { Seal.listener.position = [i, 0, 0] } }
+          Seal.listener.position
+        end
+      end
+    end
+    expect(threads.map(&:value)).to eq [[0, 0, 0], [1, 0, 0]]
+    expect(Seal.listener.position).to eq [0, 0, 0]
+  end
+end
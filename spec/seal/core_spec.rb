@@ -37,6 +37,229 @@ describe Seal do
     expect(Seal.per_source_effect_limit).to be_an Integer
   end
 
+  it 'reports the mixing frequency of the device' do
+    expect(Seal.device_frequency).to be > 0
+  end
+
+  it 'can resample to the mixing frequency of the device' do
+    expect(Seal.resampling?).to be false
+    Seal.resampling = true
+    begin
+      expect(Seal.resampling?).to be true
+      buffer = Buffer.new(WAV_PATH)
+      expect(buffer.frequency).to eq Seal.device_frequency
+    ensure
+      Seal.resampling = false
+    end
+  end
+
+  describe 'unchecked mode' do
+    after { Seal.unchecked = false }
+
+    it 'is off by default' do
+      expect(Seal.unchecked?).to be false
+    end
+
+    it 'defers errors of float attributes until they are checked' do
+      reverb = Reverb.new
+      Seal.unchecked = true
+      expect(Seal.unchecked?).to be true
+      reverb.density = 0.5
+      expect(reverb.density).to be_within(TOLERANCE).of(0.5)
+      expect { reverb.density = 2 }.to_not raise_error
+      expect { Seal.check_deferred_errors }.to raise_error SealError
+      expect { Seal.check_deferred_errors }.to_not raise_error
+    end
+
+    it 'keeps checked calls of streaming sources from failing' do
+      source = Source.new
+      source.stream = Stream.open(WAV_PATH)
+      source.looping = true
+      source.queue_size = 2
+      source.play
+      Seal.unchecked = true
+      Reverb.new.density = 2
+      # Long enough for the updater to queue buffers a few times.
+      sleep 0.5
+      expect(source.state).to be Source::State::PLAYING
+      expect { Seal.check_deferred_errors }.to raise_error SealError
+      source.stop
+    end
+  end
+
+  describe 'batch' do
+    let(:source) { Source.new }
+
+    it 'applies the last value set to each attribute' do
+      result = Seal.batch do
+        source.gain = 0.5
+        source.position = [1, 2, 3]
+        source.gain = 0.25
+        Seal.listener.position = [4, 5, 6]
+        :done
+      end
+      expect(result).to be :done
+      expect(source.gain).to be_within(TOLERANCE).of(0.25)
+      expect(source.position).to eq [1, 2, 3]
+      expect(Seal.listener.position).to eq [4, 5, 6]
+    end
+
+    it 'lets attributes be read back within the batch' do
+      Seal.batch do
+        source.pitch = 2
+        expect(source.pitch).to be_within(TOLERANCE).of(2)
+      end
+    end
+
+    it 'raises errors of batched updates when it ends' do
+      reverb = Reverb.new
+      expect { Seal.batch { reverb.density = 2 } }.to raise_error SealError
+    end
+
+    it 'ends when the block raises' do
+      expect { Seal.batch { raise 'oops' } }.to raise_error 'oops'
+      expect { Seal.batch { source.gain = 0.5 } }.to_not raise_error
+      expect(source.gain).to be_within(TOLERANCE).of(0.5)
+    end
+  end
+
+  describe 'distance model' do
+    after { Seal.distance_model = :inverse_clamped }
+
+    it 'is inverse clamped by default' do
+      expect(Seal.distance_model).to be :inverse_clamped
+    end
+
+    it 'can be set' do
+      %i(none inverse linear linear_clamped exponent exponent_clamped)
+        .each do |model|
+        Seal.distance_model = model
+        expect(Seal.distance_model).to be model
+      end
+      expect { Seal.distance_model = :cubic }.to raise_error SealError
+    end
+  end
+
+  describe 'worker threads' do
+    before { @count = Seal.worker_count }
+    after do
+      Seal.worker_count = @count
+      Seal.worker_affinity = false
+    end
+
+    it 'has at least one worker by default' do
+      expect(Seal.worker_count).to be >= 1
+      expect(Seal.worker_affinity?).to be false
+    end
+
+    it 'opens streams with the number of workers set' do
+      Seal.worker_count = 3
+      Seal.worker_affinity = true
+      expect(Seal.worker_count).to eq 3
+      expect(Seal.worker_affinity?).to be true
+      streams = Array.new(8) { Stream.open_async(WAV_PATH) }
+      streams.each do |stream|
+        stream.wait
+        expect(stream.frequency).to eq 11025
+        stream.close
+      end
+    end
+
+    it 'fails to have no workers' do
+      expect { Seal.worker_count = 0 }.to raise_error SealError
+    end
+  end
+
+  describe 'streaming schedule' do
+    after { Seal.schedule_streaming }
+
+    it 'is the normal scheduling by default' do
+      expect(Seal.streaming_schedule).to eq(
+        policy: :default, priority: 0, nice: 0, cpu_mask: 0
+      )
+    end
+
+    it 'reports what was obtained' do
+      obtained = Seal.schedule_streaming(policy: :rr, priority: 10, nice: 5,
+                                         cpu_mask: 1)
+      expect([:default, :rr]).to include obtained[:policy]
+      expect(Seal.streaming_schedule).to eq obtained
+      source = Source.new
+      source.stream = Stream.open(WAV_PATH)
+      expect { source.play }.to_not raise_error
+      source.stop
+    end
+
+    it 'fails on unknown policies' do
+      expect do
+        Seal.schedule_streaming(policy: :foo)
+      end.to raise_error SealError
+    end
+  end
+
+  describe 'loopback rendering' do
+    # Same as above: the loopback device replaces the one started globally.
+    before { Seal.cleanup }
+    prepend_after do
+      Seal.cleanup
+      Seal.startup
+    end
+
+    it 'renders frames of the requested format' do
+      Seal.startup_loopback 44100, 2, :float
+      expect(Seal.device_frequency).to eq 44100
+      expect(Seal.render(1000).bytesize).to eq 1000 * 2 * 4
+    end
+
+    it 'defaults to 16-bit samples' do
+      Seal.startup_loopback 22050, 1
+      expect(Seal.render(10).bytesize).to eq 20
+    end
+
+    it 'rejects frame counts too large for a string' do
+      Seal.startup_loopback 44100, 2, :float
+      expect { Seal.render(2**62) }.to raise_error /Invalid parameter value/
+    end
+
+    it 'streams sources in step with the rendering' do
+      Seal.startup_loopback 22050, 2
+      source = Source.new
+      source.stream = Stream.open(OV_PATH)
+      source.play
+      pcm = Seal.render(22050)
+      expect(pcm.unpack('s*').any? { |sample| sample != 0 }).to be true
+      expect(source.state).to be :playing
+    end
+
+    it 'renders the same scene the same way' do
+      renderings = 2.times.map do
+        Seal.startup_loopback 22050, 2
+        source = Source.new
+        source.stream = Stream.open(OV_PATH)
+        source.play
+        pcm = Seal.render(11025)
+        source.stop
+        Seal.cleanup
+        pcm
+      end
+      Seal.startup_loopback 22050, 2
+      expect(renderings[0]).to eq renderings[1]
+    end
+
+    it 'fails on unsupported formats' do
+      expect { Seal.startup_loopback 44100, 3 }.to raise_error SealError
+      expect do
+        Seal.startup_loopback 44100, 2, :s24
+      end.to raise_error SealError
+      Seal.startup_loopback 44100, 2
+    end
+
+    it 'cannot render on a real device' do
+      Seal.startup
+      expect { Seal.render 10 }.to raise_error SealError
+    end
+  end
+
   it 'defines a version string' do
     expect(Seal::VERSION).to match /\d\.\d\.\d/
   end
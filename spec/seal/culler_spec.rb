@@ -0,0 +1,67 @@
+require 'spec_helper'
+
+describe Culler do
+  let(:culler) { Culler.new(10) }
+  let(:buffer) { Buffer.new(WAV_PATH) }
+  let(:source) do
+    Source.new.tap do |source|
+      source.buffer = buffer
+      source.looping = true
+      source.max_distance = 5
+    end
+  end
+
+  after { Seal.listener.position = [0, 0, 0] }
+
+  it 'validates the cell size' do
+    expect { Culler.new(0) }.to raise_error SealError
+    expect { Culler.new(-1) }.to raise_error SealError
+  end
+
+  it 'adds and removes sources' do
+    expect(culler.add(source)).to be culler
+    culler.add(source)
+    expect(culler.size).to eq 1
+    expect { Culler.new(10).add(source) }.to raise_error SealError
+    expect(culler.remove(source)).to be culler
+    culler.remove(source)
+    expect(culler.size).to eq 0
+  end
+
+  it 'pauses playing sources out of range and resumes them in range' do
+    culler.add(source)
+    source.play
+    source.position = [20, 0, 0]
+    culler.cull(0.1)
+    expect(source).to be_culled
+    expect(source.state).to be Source::State::PAUSED
+    Seal.listener.position = [18, 0, 0]
+    culler.cull(0.1)
+    expect(source).not_to be_culled
+    expect(source.state).to be Source::State::PLAYING
+  end
+
+  it 'leaves sources in range and sources without a maximum distance' do
+    far = Source.new
+    far.buffer = buffer
+    far.position = [1000, 0, 0]
+    culler.add(source).add(far)
+    source.play
+    far.play
+    culler.cull(0.1)
+    expect(source).not_to be_culled
+    expect(far).not_to be_culled
+  end
+
+  it 'does not resume culled sources the caller stopped' do
+    culler.add(source)
+    source.position = [20, 0, 0]
+    source.play
+    culler.cull(0.1)
+    source.stop
+    expect(source).not_to be_culled
+    Seal.listener.position = [20, 0, 0]
+    culler.cull(0.1)
+    expect(source.state).to be Source::State::STOPPED
+  end
+end
@@ -0,0 +1,47 @@
+require 'spec_helper'
+require 'tmpdir'
+
+describe Manifest do
+  it 'probes the Ogg Vorbis file' do
+    info = Seal.probe(OV_PATH)
+    expect(info[:format]).to eq Format::OV
+    expect(info[:frequency]).to eq 44_100
+    expect(info[:channel_count]).to eq 1
+    expect(info[:frame_count]).to eq 42_671
+    expect(info[:seekable]).to be true
+  end
+
+  it 'probes the WAVE file' do
+    info = Seal.probe(WAV_PATH)
+    expect(info[:format]).to eq Format::WAV
+    expect(info[:bit_depth]).to eq 8
+  end
+
+  it 'fails when probing a missing file' do
+    expect { Seal.probe('nonexistent') }.to raise_error SealError
+  end
+
+  it 'caches probe results' do
+    manifest = Manifest.new
+    expect(manifest.size).to eq 0
+    info = manifest.probe(OV_PATH)
+    expect(info).to eq Seal.probe(OV_PATH)
+    manifest.probe(OV_PATH)
+    expect(manifest.size).to eq 1
+    manifest.probe(WAV_PATH)
+    expect(manifest.size).to eq 2
+  end
+
+  it 'saves and loads the cache' do
+    Dir.mktmpdir do |dir|
+      path = File.join(dir, 'manifest.txt')
+      manifest = Manifest.new
+      manifest.probe(OV_PATH)
+      manifest.probe(WAV_PATH)
+      manifest.save(path)
+      loaded = Manifest.new(path)
+      expect(loaded.size).to eq 2
+      expect(loaded.probe(OV_PATH)).to eq Seal.probe(OV_PATH)
+    end
+  end
+end
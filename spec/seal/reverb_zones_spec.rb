@@ -0,0 +1,52 @@
+require 'spec_helper'
+
+describe ReverbZones do
+  let(:reverb_zones) { ReverbZones.new(2) }
+  let(:room) do
+    { position: [0, 0, 0], radius: 10, fade: 5,
+      preset: Reverb::Preset::STONEROOM }
+  end
+  let(:hallway) do
+    { position: [20, 0, 0], radius: 5, fade: 5, slot: 1,
+      preset: Reverb::Preset::HALLWAY }
+  end
+
+  after { Seal.listener.position = [0, 0, 0] }
+
+  it 'needs at least one effect slot' do
+    expect { ReverbZones.new(0) }.to raise_error SealError
+  end
+
+  it 'replaces its zones' do
+    expect(reverb_zones.size).to eq 0
+    reverb_zones.zones = [room, hallway]
+    expect(reverb_zones.size).to eq 2
+    reverb_zones.zones = [room]
+    expect(reverb_zones.size).to eq 1
+    reverb_zones.zones = []
+    expect(reverb_zones.size).to eq 0
+  end
+
+  it 'validates zones' do
+    reverb_zones.zones = [room]
+    expect { reverb_zones.zones = [room.merge(slot: 2)] }.to raise_error SealError
+    expect { reverb_zones.zones = [room.merge(radius: -1)] }.to raise_error SealError
+    expect { reverb_zones.zones = [room.merge(fade: -1)] }.to raise_error SealError
+    expect { reverb_zones.zones = [room.merge(preset: -1)] }.to raise_error SealError
+    expect(reverb_zones.size).to eq 1
+  end
+
+  it 'updates as the listener moves between zones' do
+    reverb_zones.zones = [room, hallway]
+    [[0, 0, 0], [12, 0, 0], [14, 0, 0], [14, 0, 0], [100, 0, 0]].each do |pos|
+      Seal.listener.position = pos
+      expect(reverb_zones.update).to be reverb_zones
+    end
+  end
+
+  it 'feeds its effect slots with sources' do
+    source = Source.new
+    expect(reverb_zones.feed(source, 1, 0)).to be reverb_zones
+    expect { reverb_zones.feed(source, 2, 0) }.to raise_error SealError
+  end
+end
@@ -16,9 +16,12 @@ describe Source do
     its(:chunk_size) { is_expected.to eq 36_864 }
     its(:gain) { is_expected.to be_within(TOLERANCE).of(1.0) }
     its(:looping) { is_expected.to be_falsey }
+    its(:max_distance) { is_expected.to be > 1e38 }
     its(:pitch) { is_expected.to be_within(TOLERANCE).of(1.0) }
     its(:queue_size) { is_expected.to eq 3 }
+    its(:reference_distance) { is_expected.to be_within(TOLERANCE).of(1.0) }
     its(:relative) { is_expected.to be_falsey }
+    its(:rolloff_factor) { is_expected.to be_within(TOLERANCE).of(1.0) }
     its(:state) { is_expected.to be INITIAL }
     its(:stream) { is_expected.to be_nil }
     its(:type) { is_expected.to be UNDETERMINED }
@@ -28,6 +31,10 @@ describe Source do
   it_validates 'the boolean attribute', :auto
   it_validates 'the bounded float attribute', :pitch, '[0, +inf.)'
   it_validates 'the bounded float attribute', :gain, '[0, +inf.)'
+  it_validates 'the bounded float attribute', :rolloff_factor, '[0, +inf.)'
+  it_validates 'the bounded float attribute', :reference_distance,
+               '[0, +inf.)'
+  it_validates 'the bounded float attribute', :max_distance, '[0, +inf.)'
   it_defines 'boolean reader aliases', %i(auto relative looping)
 
   it 'validates its queue size is in [2, 63]' do
@@ -68,6 +75,32 @@ describe Source do
     expect { source.chunk_size = 234_923_428 }.to raise_error error_pattern
   end
 
+  it 'updates positions and velocities of many sources at once' do
+    sources = Array.new(3) { Source.new }
+    positions = [[1.0, 2.0, 3.0], [4.0, 5.0, 6.0], [7.0, 8.0, 9.0]]
+    velocities = [[0.5, 0.0, 0.0], [0.0, 0.5, 0.0], [0.0, 0.0, 0.5]]
+    transforms = positions.flatten.pack('f*')
+    expect(Source.update_transforms(sources, transforms)).to eq sources
+    expect(sources.map(&:position)).to eq positions
+    transforms << velocities.flatten.pack('f*')
+    Source.update_transforms(sources, transforms)
+    expect(sources.map(&:position)).to eq positions
+    expect(sources.map(&:velocity)).to eq velocities
+    expect { Source.update_transforms(sources, ([1.0] * 4).pack('f*')) }
+      .to raise_error ArgumentError
+  end
+
+  it 'moves many sources at once' do
+    sources = Array.new(2) { Source.new }
+    sources[0].position = [1, 2, 3]
+    sources[0].velocity = [2, 0, -4]
+    sources[1].position = [4, 5, 6]
+    expect(Source.move_all(sources, 0.5)).to eq sources
+    expect(sources[0].position).to eq [2, 2, 1]
+    expect(sources[1].position).to eq [4, 5, 6]
+    Source.move_all([], 1)
+  end
+
   context 'with a buffer' do
     before(:each) { source.buffer = buffer }
 
@@ -218,6 +251,22 @@ describe Source do
       sleep(0.5)
       expect(source.state).to be STOPPED
     end
+
+    it 'can be driven from several threads at once' do
+      threads = Array.new(4) do
+        Thread.new do
+          10.times do
+            source.play
+            source.position = [1, 2, 3]
+            source.pause
+            source.stop
+          end
+        end
+      end
+      expect { threads.each(&:join) }.to_not raise_error
+      source.play
+      expect(source.state).to be PLAYING
+    end
   end
 
   describe 'looping' do
@@ -26,6 +26,123 @@ describe Stream do
     its(:frequency) { is_expected.to eq 0 }
   end
 
+  [IMA_ADPCM_PATH, MS_ADPCM_PATH].each do |path|
+    context "read from #{File.basename(path)}" do
+      subject { Stream.new(path) }
+      its(:bit_depth) { is_expected.to eq 16 }
+      its(:channel_count) { is_expected.to eq 1 }
+      its(:frequency) { is_expected.to eq 11_025 }
+    end
+  end
+
+  context 'opened asynchronously' do
+    subject { Stream.open_async(OV_PATH) }
+
+    it 'can be waited for' do
+      expect(subject.wait).to be subject
+      expect(subject).not_to be_opening
+      expect(subject.frequency).to eq 44_100
+    end
+
+    it 'can be played before it is opened' do
+      source = Source.new
+      source.stream = subject
+      source.play
+      subject.wait
+      sleep 0.3
+      expect(source.state).to be PLAYING
+      source.stop
+    end
+
+    it 'lets manual sources played before it is opened be updated' do
+      source = Source.new
+      source.auto = false
+      source.looping = true
+      source.queue_size = 2
+      source.chunk_size = 9216
+      source.stream = subject
+      source.play
+      subject.wait
+      # The primed queue alone lasts about 0.1 seconds.
+      20.times do
+        sleep 0.05
+        source.update
+      end
+      expect(source.state).to be PLAYING
+      source.stop
+    end
+
+    it 'raises the error of opening on waiting' do
+      stream = Stream.open_async(File.join(FIXTURE_DIR, 'missing.ogg'))
+      expect { stream.wait }.to raise_error SealError
+    end
+  end
+
+  context 'opened in fast mode' do
+    before { Stream.fast_open = true }
+    after { Stream.fast_open = false }
+
+    subject { Stream.new(OV_PATH) }
+
+    its(:frequency) { is_expected.to eq 44_100 }
+
+    it 'can be rewound while playing' do
+      source = Source.new
+      source.stream = subject
+      source.play
+      sleep 0.2
+      source.play
+      expect(source.state).to be PLAYING
+      source.stop
+    end
+  end
+
+  describe 'read-ahead window' do
+    subject { Stream.new(OV_PATH) }
+
+    its(:read_ahead) { is_expected.to eq 262_144 }
+
+    it 'can be changed while streaming' do
+      stream = subject
+      source = Source.new
+      source.stream = stream
+      stream.read_ahead = 4096
+      expect(stream.read_ahead).to eq 4096
+      stream.read_ahead = 0
+      expect(stream.read_ahead).to eq 0
+      source.play
+      source.stop
+    end
+  end
+
+  describe 'reading' do
+    subject { Stream.new(WAV_PATH) }
+
+    it 'decodes chunks until the end' do
+      chunks = []
+      while (chunk = subject.read(1000))
+        expect(chunk.encoding).to eq Encoding::BINARY
+        chunks << chunk
+      end
+      expect(chunks.map(&:bytesize)).to eq [1000, 1000, 250]
+      expect(chunks.join).to eq File.binread(WAV_PATH)[44, 2250]
+    end
+
+    it 'decodes into a given string' do
+      string = 'old content'
+      expect(subject.read(2000, into: string)).to be string
+      expect(string.bytesize).to eq 2000
+      expect(subject.read(2000, into: string)).to be string
+      expect(string.bytesize).to eq 250
+      expect(subject.read(2000, into: string)).to be_nil
+      expect(string).to be_empty
+    end
+
+    it 'rejects negative lengths' do
+      expect { subject.read(-1) }.to raise_error ArgumentError
+    end
+  end
+
   example 'rewinding prevents source from stopping' do
     source.play
     6.times do
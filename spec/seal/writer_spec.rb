@@ -0,0 +1,85 @@
+require 'spec_helper'
+require 'tmpdir'
+
+describe Writer do
+  let(:path) { File.join(Dir.tmpdir, "seal_writer_spec_#{$$}.wav") }
+
+  after { File.delete(path) if File.exist?(path) }
+
+  def header(path)
+    File.binread(path, 44).unpack('a4Va4a4VvvVVvva4V')
+  end
+
+  it 'validates the format of the file' do
+    expect do
+      Writer.new(path, frequency: 44100, channels: 2, bit_depth: 8)
+    end.to raise_error SealError
+    expect do
+      Writer.new(path, frequency: 0, channels: 2)
+    end.to raise_error SealError
+  end
+
+  it 'writes 16-bit PCM and fills in the header on close' do
+    writer = Writer.new(path, frequency: 22050, channels: 2)
+    expect(writer.write([1, -2, 3, -4].pack('s*'))).to be writer
+    expect(writer.frame_count).to eq 2
+    expect(writer.close).to be_nil
+    expect(File.size(path)).to eq 44 + 8
+    fields = header(path)
+    expect(fields.values_at(0, 2, 3)).to eq %w(RIFF WAVE fmt\ )
+    expect(fields[1]).to eq 36 + 8
+    expect(fields.values_at(5, 6, 7, 10)).to eq [1, 2, 22050, 16]
+    expect(fields.values_at(11, 12)).to eq ['data', 8]
+    expect(File.binread(path, 8, 44).unpack('s<*')).to eq [1, -2, 3, -4]
+  end
+
+  it 'converts samples to 24 bits' do
+    writer = Writer.new(path, frequency: 44100, channels: 1, bit_depth: 24)
+    writer.write([0x1234, -1].pack('s*'), bit_depth: 16)
+    writer.write([128].pack('C'), bit_depth: 8)
+    writer.close
+    fields = header(path)
+    expect(fields.values_at(9, 10, 12)).to eq [3, 24, 9]
+    expect(File.binread(path, 10, 44).bytes)
+      .to eq [0, 0x34, 0x12, 0, 0xff, 0xff, 0, 0, 0, 0]
+  end
+
+  it 'writes float samples' do
+    writer = Writer.new(path, frequency: 44100, channels: 2, bit_depth: 32)
+    writer.write([0.5, -0.25].pack('f*'))
+    writer.write([16384, -32768].pack('s*'), bit_depth: 16)
+    writer.close
+    data = File.binread(path)
+    expect(data[20, 2].unpack('v')[0]).to eq 3
+    expect(data[-16..-1].unpack('e*')).to eq [0.5, -0.25, 0.5, -1.0]
+  end
+
+  it 'writes large data in few blocks' do
+    writer = Writer.new(path, frequency: 44100, channels: 2)
+    chunk = "\x01\x00" * 100_000
+    10.times { writer.write(chunk) }
+    expect(writer.frame_count).to eq 500_000
+    writer.close
+    expect(File.size(path)).to eq 44 + 2_000_000
+  end
+
+  it 'writes streams' do
+    stream = Stream.open(WAV_PATH)
+    writer = Writer.new(path, frequency: stream.frequency,
+                              channels: stream.channel_count)
+    while (pcm = stream.read(4096))
+      writer.write(pcm, bit_depth: stream.bit_depth)
+    end
+    expect(writer.frame_count).to be > 0
+    writer.close
+  end
+
+  it 'rejects data of another format' do
+    writer = Writer.new(path, frequency: 44100, channels: 2)
+    expect { writer.write('abc') }.to raise_error SealError
+    expect { writer.write('abcd', bit_depth: 12) }.to raise_error SealError
+    writer.close
+    expect { writer.write('abcd') }.to raise_error SealError
+    expect(writer.close).to be_nil
+  end
+end
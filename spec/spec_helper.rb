@@ -8,6 +8,9 @@ TOLERANCE = 0.00001
 FIXTURE_DIR = File.join File.dirname(__FILE__), 'fixtures'
 WAV_PATH = File.join FIXTURE_DIR, 'tone_up.wav'
 OV_PATH = File.join FIXTURE_DIR, 'heal.ogg'
+IMA_ADPCM_PATH = File.join FIXTURE_DIR, 'tone_up_ima_adpcm.wav'
+MS_ADPCM_PATH = File.join FIXTURE_DIR, 'tone_up_ms_adpcm.wav'
+STEREO_WAV_PATH = File.join FIXTURE_DIR, 'tone_up_stereo.wav'
 
 RSpec.configure do |config|
   config.instance_eval do
@@ -1,6 +1,11 @@
 #include <stdlib.h>
+#include <limits.h>
 #include <seal.h>
 #include "ruby.h"
+#include "ruby/encoding.h"
+#ifdef HAVE_RB_THREAD_CALL_WITHOUT_GVL
+# include "ruby/thread.h"
+#endif
 
 static const char WAV_SYM[] = "wav";
 static const char OV_SYM[] = "ov";
@@ -15,15 +20,82 @@ static const char PLAYING_SYM[] = "playing";
 static const char PAUSED_SYM[] = "paused";
 static const char STOPPED_SYM[] = "stopped";
 
+/* Indexed by `seal_distance_model_t'. */
+static const char* const DISTANCE_MODEL_SYMS[] = {
+    "none",
+    "inverse",
+    "inverse_clamped",
+    "linear",
+    "linear_clamped",
+    "exponent",
+    "exponent_clamped"
+};
+#define NDISTANCE_MODELS (sizeof DISTANCE_MODEL_SYMS                        \
+                          / sizeof DISTANCE_MODEL_SYMS[0])
+
+/* Indexed by `seal_sample_type_t'. */
+static const char* const SAMPLE_TYPE_SYMS[] = { "u8", "s16", "float" };
+static const size_t SAMPLE_SIZES[] = { 1, 2, 4 };
+#define NSAMPLE_TYPES (sizeof SAMPLE_TYPE_SYMS / sizeof SAMPLE_TYPE_SYMS[0])
+
+/* Indexed by `seal_sched_policy_t'. */
+static const char* const SCHED_POLICY_SYMS[] = { "default", "fifo", "rr" };
+#define NSCHED_POLICIES (sizeof SCHED_POLICY_SYMS                           \
+                         / sizeof SCHED_POLICY_SYMS[0])
+
+/* The size of the frames rendered by Seal.render, or 0 if not on loopback. */
+static size_t loopback_frame_size = 0;
+
+/* Typical heap usage of opened decoders, measured with the bundled audio. */
+enum
+{
+    WAV_DECODER_SIZE = 4096,
+    OV_DECODER_SIZE = 131072,
+    MPG_DECODER_SIZE = 65536
+};
+
+/*
+ * Sharing of objects with other Ractors. Objects of most types keep state in
+ * C that is not safe to touch from several Ractors at once, so they stay in
+ * the Ractor that created them; buffers and the like hold audio that never
+ * changes once loaded, so they can be shared once frozen.
+ */
+#define RACTOR_LOCAL 0
+#ifdef HAVE_RB_EXT_RACTOR_SAFE
+# define SHAREABLE_WHEN_FROZEN 0, 0, RUBY_TYPED_FROZEN_SHAREABLE
+#else
+# define SHAREABLE_WHEN_FROZEN RACTOR_LOCAL
+#endif
+
 static VALUE mSeal;
 static VALUE eSealError;
 
-#define DEFINE_ALLOCATOR(obj)                                               \
+/*
+ * Defines the allocator along with the data type, which also tells the GC
+ * and `ObjectSpace.memsize_of' how much memory an object holds. Objects are
+ * not freed immediately so that closing streams and joining updater threads
+ * happen outside of GC.
+ */
+#define DEFINE_ALLOCATOR(obj, sharing)                                      \
+static const rb_data_type_t obj##_type = {                                  \
+    "seal_" #obj,                                                           \
+    { 0, free_##obj, memsize_##obj },                                       \
+    sharing                                                                 \
+};                                                                          \
+                                                                            \
 static                                                                      \
 VALUE                                                                       \
 alloc_##obj(VALUE klass)                                                    \
 {                                                                           \
-    return alloc(klass, sizeof (seal_##obj##_t), free_##obj);               \
+    return alloc(klass, sizeof (seal_##obj##_t), &obj##_type);              \
+}
+
+#define DEFINE_MEMSIZE(obj)                                                 \
+static                                                                      \
+size_t                                                                      \
+memsize_##obj(const void* obj)                                              \
+{                                                                           \
+    return sizeof (seal_##obj##_t);                                         \
 }
 
 #define DEFINE_DEALLOCATOR(obj)                                             \
@@ -58,6 +130,183 @@ check_seal_err(seal_err_t err)
         rb_raise(eSealError, "%s", seal_get_err_msg(err));
 }
 
+/*
+ * Arguments and result of a Seal call made without holding the GVL. Such
+ * calls must not touch any Ruby object.
+ */
+typedef struct nogvl_call_t
+{
+    void*       func;
+    void*       obj;
+    const char* filename;
+    seal_fmt_t  fmt;
+    seal_raw_t* raw;
+    size_t      size;
+    seal_err_t  err;
+    void*       (*routine)(void*);
+    volatile char canceled;
+} nogvl_call_t;
+
+static
+void*
+call_op(void* args)
+{
+    nogvl_call_t* call = args;
+
+    call->err = ((seal_err_t (*)(void*)) call->func)(call->obj);
+
+    return 0;
+}
+
+static
+void*
+call_input(void* args)
+{
+    nogvl_call_t* call = args;
+
+    call->err = ((seal_err_t (*)(void*, const char*, seal_fmt_t)) call->func)(
+        call->obj, call->filename, call->fmt
+    );
+
+    return 0;
+}
+
+static
+void*
+call_probe(void* args)
+{
+    nogvl_call_t* call = args;
+
+    call->err = seal_probe(call->filename, call->obj);
+
+    return 0;
+}
+
+static
+void*
+call_stream_into(void* args)
+{
+    nogvl_call_t* call = args;
+
+    call->err = seal_stream_into(call->obj, call->raw, &call->size);
+
+    return 0;
+}
+
+static
+void*
+call_write_raw(void* args)
+{
+    nogvl_call_t* call = args;
+
+    call->err = seal_write_raw(call->obj, call->raw);
+
+    return 0;
+}
+
+static
+void*
+call_render(void* args)
+{
+    nogvl_call_t* call = args;
+
+    call->err = seal_render(call->obj, call->size);
+
+    return 0;
+}
+
+static
+void*
+call_set_worker_count(void* args)
+{
+    nogvl_call_t* call = args;
+
+    call->err = seal_set_worker_count(call->size);
+
+    return 0;
+}
+
+static
+void*
+call_set_worker_affinity(void* args)
+{
+    nogvl_call_t* call = args;
+
+    call->err = seal_set_worker_affinity(call->size != 0);
+
+    return 0;
+}
+
+/* Runs the actual call with the cancel flag of the calling thread set. */
+static
+void*
+call_cancelably(void* args)
+{
+    nogvl_call_t* call = args;
+
+    seal_set_cancel_flag(&call->canceled);
+    call->routine(call);
+    seal_set_cancel_flag(0);
+
+    return 0;
+}
+
+/* Unblocks a call when the Ruby thread making it is interrupted. */
+static
+void
+cancel_call(void* args)
+{
+    ((nogvl_call_t*) args)->canceled = 1;
+}
+
+/*
+ * Releases the GVL around calls that decode audio or wait for other threads,
+ * so that other Ruby threads keep running meanwhile. Interrupts such as
+ * `Thread#raise' cancel loading, streaming and waiting for streams being
+ * opened, which then fail with `SEAL_CANCELED'; other calls run to the end.
+ */
+static
+seal_err_t
+call_without_gvl(void* (*func)(void*), nogvl_call_t* call)
+{
+    call->routine = func;
+    call->canceled = 0;
+    /* In case the call is interrupted before it starts. */
+    call->err = SEAL_CANCELED;
+#ifdef HAVE_RB_THREAD_CALL_WITHOUT_GVL
+    rb_thread_call_without_gvl(call_cancelably, call, cancel_call, call);
+#else
+    rb_thread_blocking_region((VALUE (*)(void*)) call_cancelably, call,
+                              cancel_call, call);
+#endif
+
+    return call->err;
+}
+
+static
+seal_err_t
+op_without_gvl(void* obj, void* op)
+{
+    nogvl_call_t call;
+
+    call.func = op;
+    call.obj = obj;
+
+    return call_without_gvl(call_op, &call);
+}
+
+/*
+ * Freezes a copy of `rstr' so that other Ruby threads cannot modify the
+ * string while the GVL is released.
+ */
+static
+VALUE
+freeze_str(VALUE rstr)
+{
+    return rb_str_new_frozen(rb_convert_type(rstr, T_STRING, "String",
+                                             "to_str"));
+}
+
 static
 void
 free_obj(void* obj, void *destroy)
@@ -66,10 +315,76 @@ free_obj(void* obj, void *destroy)
     free(obj);
 }
 
+/*
+ * Tells the GC about memory held outside of the Ruby heap (such as PCM data
+ * owned by OpenAL) so that it collects garbage accordingly.
+ */
+static
+void
+adjust_memory_usage(long diff)
+{
+#ifdef HAVE_RB_GC_ADJUST_MEMORY_USAGE
+    if (diff != 0)
+        rb_gc_adjust_memory_usage(diff);
+#endif
+}
+
+static
+size_t
+get_buf_nbytes(seal_buf_t* buf)
+{
+    int size = 0;
+
+    /* Fails harmlessly if the buffer is not initialized. */
+    seal_get_buf_size(buf, &size);
+
+    return size;
+}
+
+static
+size_t
+get_decoder_size(const seal_stream_t* stream)
+{
+    char opening = 0;
+
+    seal_is_stream_opening((seal_stream_t*) stream, &opening);
+    if (opening || stream->id == 0)
+        return 0;
+
+    switch (stream->fmt) {
+    case SEAL_WAV_FMT:
+        return WAV_DECODER_SIZE;
+    case SEAL_OV_FMT:
+        return OV_DECODER_SIZE;
+    case SEAL_MPG_FMT:
+        return MPG_DECODER_SIZE;
+    default:
+        return 0;
+    }
+}
+
 DEFINE_DEALLOCATOR(src)
-DEFINE_DEALLOCATOR(buf)
 DEFINE_DEALLOCATOR(rvb)
 DEFINE_DEALLOCATOR(efs)
+DEFINE_DEALLOCATOR(manifest)
+DEFINE_DEALLOCATOR(culler)
+DEFINE_DEALLOCATOR(zones)
+
+static
+void
+free_buf(void* buf)
+{
+    adjust_memory_usage(-(long) get_buf_nbytes(buf));
+    free_obj(buf, seal_destroy_buf);
+}
+
+static
+void
+free_cbuf(void* cbuf)
+{
+    adjust_memory_usage(-(long) ((seal_cbuf_t*) cbuf)->size);
+    free_obj(cbuf, seal_destroy_cbuf);
+}
 
 static
 void
@@ -78,22 +393,138 @@ free_stream(void* stream)
     free_obj(stream, seal_close_stream);
 }
 
+static
+void
+free_context(void* context)
+{
+    free_obj(context, seal_close_context);
+}
+
+static
+void
+free_writer(void* writer)
+{
+    free_obj(writer, seal_close_writer);
+}
+
+DEFINE_MEMSIZE(rvb)
+DEFINE_MEMSIZE(efs)
+DEFINE_MEMSIZE(manifest)
+DEFINE_MEMSIZE(culler)
+DEFINE_MEMSIZE(zones)
+DEFINE_MEMSIZE(context)
+
+static
+size_t
+memsize_writer(const void* writer)
+{
+    return sizeof (seal_writer_t) + ((const seal_writer_t*) writer)->buf_cap;
+}
+
+/* Streaming sources hold their queued chunks in OpenAL. */
+static
+size_t
+memsize_src(const void* _src)
+{
+    const seal_src_t* src = _src;
+    size_t size = sizeof (seal_src_t);
+
+    if (src->stream != 0) {
+        size += src->queue_size * src->chunk_size;
+        /* Sources privately open streams on compressed buffers. */
+        if (src->cbuf != 0)
+            size += sizeof (seal_stream_t) + get_decoder_size(src->stream);
+    }
+
+    return size;
+}
+
+static
+size_t
+memsize_buf(const void* buf)
+{
+    return sizeof (seal_buf_t) + get_buf_nbytes((seal_buf_t*) buf);
+}
+
+static
+size_t
+memsize_cbuf(const void* cbuf)
+{
+    return sizeof (seal_cbuf_t) + ((const seal_cbuf_t*) cbuf)->size;
+}
+
+static
+size_t
+memsize_stream(const void* stream)
+{
+    return sizeof (seal_stream_t) + get_decoder_size(stream);
+}
+
 static
 VALUE
-alloc(VALUE klass, size_t size, void* free)
+alloc(VALUE klass, size_t size, const rb_data_type_t* type)
 {
     void* obj;
 
     obj = validate_memory(calloc(1, size));
 
-    return Data_Wrap_Struct(klass, 0, free, obj);
+    return TypedData_Wrap_Struct(klass, type, obj);
+}
+
+DEFINE_ALLOCATOR(src, RACTOR_LOCAL)
+DEFINE_ALLOCATOR(buf, SHAREABLE_WHEN_FROZEN)
+DEFINE_ALLOCATOR(cbuf, SHAREABLE_WHEN_FROZEN)
+DEFINE_ALLOCATOR(stream, RACTOR_LOCAL)
+DEFINE_ALLOCATOR(rvb, RACTOR_LOCAL)
+DEFINE_ALLOCATOR(efs, RACTOR_LOCAL)
+DEFINE_ALLOCATOR(manifest, RACTOR_LOCAL)
+DEFINE_ALLOCATOR(culler, RACTOR_LOCAL)
+DEFINE_ALLOCATOR(zones, RACTOR_LOCAL)
+DEFINE_ALLOCATOR(context, RACTOR_LOCAL)
+DEFINE_ALLOCATOR(writer, RACTOR_LOCAL)
+
+/*
+ * Gets the mutex serializing calls on a source, which is needed since some
+ * of them run without the GVL. It is kept in an instance variable without
+ * the `@' prefix so that Ruby code cannot see it.
+ */
+static
+VALUE
+get_src_lock(VALUE rsrc)
+{
+    ID id = rb_intern("__lock__");
+
+    if (!rb_ivar_defined(rsrc, id))
+        rb_ivar_set(rsrc, id, rb_mutex_new());
+
+    return rb_ivar_get(rsrc, id);
+}
+
+/* Locks `robj' if it is a source; nothing between may raise. */
+static
+VALUE
+lock_obj(VALUE robj)
+{
+    if (!rb_typeddata_is_kind_of(robj, &src_type))
+        return Qnil;
+
+    return rb_mutex_lock(get_src_lock(robj));
+}
+
+static
+void
+unlock_obj(VALUE lock)
+{
+    if (!NIL_P(lock))
+        rb_mutex_unlock(lock);
 }
 
-DEFINE_ALLOCATOR(src)
-DEFINE_ALLOCATOR(buf)
-DEFINE_ALLOCATOR(stream)
-DEFINE_ALLOCATOR(rvb)
-DEFINE_ALLOCATOR(efs)
+/* The listener has no state of its own so it is always shared. */
+static const rb_data_type_t listener_type = {
+    "seal_listener",
+    { 0, 0, 0 },
+    SHAREABLE_WHEN_FROZEN
+};
 
 static
 void
@@ -118,9 +549,13 @@ static
 VALUE
 set_obj_float(VALUE robj, VALUE rflt, void* set)
 {
-    check_seal_err(((seal_err_t (*)(void*, float)) set)(
-        DATA_PTR(robj), NUM2DBL(rflt)
-    ));
+    float flt = NUM2DBL(rflt);
+    VALUE lock = lock_obj(robj);
+    seal_err_t err;
+
+    err = ((seal_err_t (*)(void*, float)) set)(DATA_PTR(robj), flt);
+    unlock_obj(lock);
+    check_seal_err(err);
 
     return rflt;
 }
@@ -129,9 +564,13 @@ static
 VALUE
 set_obj_int(VALUE robj, VALUE rnum, void* set)
 {
-    check_seal_err(((seal_err_t (*)(void*, int)) set)(
-        DATA_PTR(robj), NUM2INT(rnum)
-    ));
+    int num = NUM2INT(rnum);
+    VALUE lock = lock_obj(robj);
+    seal_err_t err;
+
+    err = ((seal_err_t (*)(void*, int)) set)(DATA_PTR(robj), num);
+    unlock_obj(lock);
+    check_seal_err(err);
 
     return rnum;
 }
@@ -140,9 +579,12 @@ static
 VALUE
 set_obj_char(VALUE robj, VALUE rbool, void* set)
 {
-    check_seal_err(((seal_err_t (*)(void*, char)) set)(
-        DATA_PTR(robj), RTEST(rbool)
-    ));
+    VALUE lock = lock_obj(robj);
+    seal_err_t err;
+
+    err = ((seal_err_t (*)(void*, char)) set)(DATA_PTR(robj), RTEST(rbool));
+    unlock_obj(lock);
+    check_seal_err(err);
 
     return rbool;
 }
@@ -152,11 +594,16 @@ VALUE
 set_obj_3float(VALUE robj, VALUE rarr, void* set)
 {
     float x, y, z;
+    VALUE lock;
+    seal_err_t err;
 
     extract_3float(rarr, &x, &y, &z);
-    check_seal_err(((seal_err_t (*)(void*, float, float, float)) set)(
+    lock = lock_obj(robj);
+    err = ((seal_err_t (*)(void*, float, float, float)) set)(
         DATA_PTR(robj), x, y, z
-    ));
+    );
+    unlock_obj(lock);
+    check_seal_err(err);
 
     return rarr;
 }
@@ -165,9 +612,12 @@ static
 void
 get_obj_attr(VALUE robj, void* pvalue, void* get)
 {
-    check_seal_err(((seal_err_t (*)(void*, void*)) get)(
-        DATA_PTR(robj), pvalue
-    ));
+    VALUE lock = lock_obj(robj);
+    seal_err_t err;
+
+    err = ((seal_err_t (*)(void*, void*)) get)(DATA_PTR(robj), pvalue);
+    unlock_obj(lock);
+    check_seal_err(err);
 }
 
 static
@@ -209,10 +659,14 @@ get_obj_3float(VALUE robj, void* get)
 {
     float tuple[3];
     VALUE rtuple[3];
+    VALUE lock = lock_obj(robj);
+    seal_err_t err;
 
-    check_seal_err(((seal_err_t (*)(void*, float*, float*, float*)) get)(
+    err = ((seal_err_t (*)(void*, float*, float*, float*)) get)(
         DATA_PTR(robj), tuple, tuple + 1, tuple + 2
-    ));
+    );
+    unlock_obj(lock);
+    check_seal_err(err);
     convert_bulk_float(rtuple, tuple, 3);
 
     return rb_ary_new4(3, rtuple);
@@ -246,9 +700,91 @@ input_audio(int argc, VALUE* argv, void* media, void* _input)
     VALUE format;
 
     inputter_t* input = (inputter_t*) _input;
+    nogvl_call_t call;
+
     rb_scan_args(argc, argv, "11", &filename, &format);
-    check_seal_err(input(media, rb_string_value_ptr(&filename),
-                         map_format(format)));
+    filename = freeze_str(filename);
+    call.func = input;
+    call.obj = media;
+    call.filename = RSTRING_PTR(filename);
+    call.fmt = map_format(format);
+    check_seal_err(call_without_gvl(call_input, &call));
+    RB_GC_GUARD(filename);
+}
+
+/*
+ * Same as `input_audio' with `seal_load2buf' except that it also takes an
+ * optional hash of options; `mono: true' downmixes stereo audio to mono.
+ */
+static
+void
+load_audio2buf(int argc, VALUE* argv, seal_buf_t* buf)
+{
+    VALUE filename;
+    VALUE format;
+    VALUE options;
+    int mono = 0;
+    size_t size = get_buf_nbytes(buf);
+    nogvl_call_t call;
+
+    rb_scan_args(argc, argv, "11:", &filename, &format, &options);
+    if (!NIL_P(options))
+        mono = RTEST(rb_hash_aref(options, name2sym("mono")));
+    filename = freeze_str(filename);
+    call.func = mono ? seal_load_mono2buf : seal_load2buf;
+    call.obj = buf;
+    call.filename = RSTRING_PTR(filename);
+    call.fmt = map_format(format);
+    check_seal_err(call_without_gvl(call_input, &call));
+    RB_GC_GUARD(filename);
+    adjust_memory_usage((long) get_buf_nbytes(buf) - (long) size);
+}
+
+/*
+ * Same as `input_audio' with `seal_load2cbuf' except that the GC is told
+ * about the change in size of the encoded data.
+ */
+static
+void
+load_audio2cbuf(int argc, VALUE* argv, seal_cbuf_t* cbuf)
+{
+    size_t size = cbuf->size;
+
+    input_audio(argc, argv, cbuf, seal_load2cbuf);
+    adjust_memory_usage((long) cbuf->size - (long) size);
+}
+
+static
+VALUE
+fmt2sym(seal_fmt_t fmt)
+{
+    switch (fmt) {
+    case SEAL_WAV_FMT:
+        return name2sym(WAV_SYM);
+    case SEAL_OV_FMT:
+        return name2sym(OV_SYM);
+    case SEAL_MPG_FMT:
+        return name2sym(MPG_SYM);
+    default:
+        return Qnil;
+    }
+}
+
+static
+VALUE
+info2hash(seal_audio_info_t* info)
+{
+    VALUE rhash = rb_hash_new();
+
+    rb_hash_aset(rhash, name2sym("format"), fmt2sym(info->fmt));
+    rb_hash_aset(rhash, name2sym("frequency"), INT2NUM(info->attr.freq));
+    rb_hash_aset(rhash, name2sym("bit_depth"), INT2NUM(info->attr.bit_depth));
+    rb_hash_aset(rhash, name2sym("channel_count"),
+                 INT2NUM(info->attr.nchannels));
+    rb_hash_aset(rhash, name2sym("frame_count"), SIZET2NUM(info->nframes));
+    rb_hash_aset(rhash, name2sym("seekable"), info->seekable ? Qtrue : Qfalse);
+
+    return rhash;
 }
 
 static
@@ -296,184 +832,1073 @@ get_listener_float(seal_err_t (*get)(float*))
     return rb_float_new(value);
 }
 
+/* Runs a source operation that is cheap enough to keep the GVL. */
 static
 VALUE
 src_op(VALUE rsrc, seal_err_t (*op)(seal_src_t*))
 {
-    check_seal_err(op(DATA_PTR(rsrc)));
+    VALUE lock = lock_obj(rsrc);
+    seal_err_t err;
+
+    err = op(DATA_PTR(rsrc));
+    unlock_obj(lock);
+    check_seal_err(err);
 
     return rsrc;
 }
 
+typedef struct blocking_src_op_t
+{
+    VALUE       rsrc;
+    seal_err_t  (*op)(seal_src_t*);
+    seal_err_t  err;
+} blocking_src_op_t;
+
+static
+VALUE
+run_blocking_src_op(VALUE args)
+{
+    blocking_src_op_t* call = (blocking_src_op_t*) args;
+    seal_src_t* src = DATA_PTR(call->rsrc);
+
+    /*
+     * Only streaming sources decode audio or join their updaters. Sources in
+     * a culler keep the GVL since cullers are not otherwise serialized.
+     */
+    if (src->stream != 0 && src->culler == 0)
+        call->err = op_without_gvl(src, call->op);
+    else
+        call->err = call->op(src);
+
+    return Qnil;
+}
+
+/*
+ * Runs a source operation that may decode audio or join the updater of the
+ * source. The lock is released even if an interrupt raises afterward.
+ */
+static
+VALUE
+blocking_src_op(VALUE rsrc, seal_err_t (*op)(seal_src_t*))
+{
+    blocking_src_op_t call;
+
+    call.rsrc = rsrc;
+    call.op = op;
+    rb_mutex_synchronize(get_src_lock(rsrc), run_blocking_src_op,
+                         (VALUE) &call);
+    check_seal_err(call.err);
+
+    return rsrc;
+}
+
+static
+seal_stream_t*
+extract_stream(VALUE rstream)
+{
+    /* Attributes are not known until the stream is opened. */
+    op_without_gvl(DATA_PTR(rstream), seal_wait_stream);
+
+    return DATA_PTR(rstream);
+}
+
+/*
+ *  call-seq:
+ *      Seal.startup       -> nil
+ *      Seal.startup(str)  -> nil
+ *
+ * Initializes Seal by specifying the device name _str_. This function is
+ * not re-entrant nor thread-safe and should be called only once per Seal
+ * session. Match a call to <code>seal_startup</code> with a call to
+ * <code>seal_cleanup</code> and never call <code>seal_starup</code> twice in
+ * a row.
+ */
+static
+VALUE
+startup(int argc, VALUE* argv)
+{
+    VALUE rstring;
+
+    rb_scan_args(argc, argv, "01", &rstring);
+    check_seal_err(seal_startup(NIL_P(rstring)
+                   ? 0 : rb_string_value_ptr(&rstring)));
+
+    return Qnil;
+}
+
+/*
+ *  call-seq:
+ *      Seal.startup_loopback(freq, channels)         -> nil
+ *      Seal.startup_loopback(freq, channels, sym)    -> nil
+ *
+ * Initializes Seal on a loopback device that renders _channels_ channels of
+ * samples of type _sym_ (:u8, :s16 or :float; :s16 by default) at _freq_ Hz,
+ * instead of playing on a real device. Nothing is heard; the mix is only
+ * produced by Seal.render, as fast as it can be computed, and streaming
+ * sources are updated in step with it rather than by updater threads, so
+ * the same scene always renders the same. Same restrictions as Seal.startup
+ * apply.
+ */
+static
+VALUE
+startup_loopback(int argc, VALUE* argv)
+{
+    VALUE rfreq, rnchannels, rtype;
+    VALUE symbol;
+    int nchannels;
+    size_t type = 1;
+
+    rb_scan_args(argc, argv, "21", &rfreq, &rnchannels, &rtype);
+    if (!NIL_P(rtype)) {
+        symbol = rb_convert_type(rtype, T_SYMBOL, "Symbol", "to_sym");
+        for (type = 0; type < NSAMPLE_TYPES; ++type)
+            if (symbol == name2sym(SAMPLE_TYPE_SYMS[type]))
+                break;
+        if (type == NSAMPLE_TYPES)
+            check_seal_err(SEAL_BAD_ENUM);
+    }
+    nchannels = NUM2INT(rnchannels);
+    check_seal_err(seal_startup_loopback(NUM2INT(rfreq), nchannels, type));
+    loopback_frame_size = nchannels * SAMPLE_SIZES[type];
+
+    return Qnil;
+}
+
+/*
+ *  call-seq:
+ *      Seal.render(frames)    -> str
+ *
+ * Renders _frames_ sample frames from the loopback device opened by
+ * Seal.startup_loopback and returns them as a binary string of interleaved
+ * samples in native byte order, advancing the mix and the streaming sources
+ * by the same amount of time.
+ */
+static
+VALUE
+render(VALUE rmod, VALUE rnframes)
+{
+    long nframes = NUM2LONG(rnframes);
+    VALUE rstr;
+    nogvl_call_t call;
+
+    if (loopback_frame_size == 0)
+        check_seal_err(SEAL_BAD_OP);
+    if (nframes < 0 || (size_t) nframes > LONG_MAX / loopback_frame_size)
+        check_seal_err(SEAL_BAD_VAL);
+    rstr = rb_str_new(0, nframes * loopback_frame_size);
+    /* Rendering refills the queues of streaming sources. */
+    call.obj = RSTRING_PTR(rstr);
+    call.size = nframes;
+    check_seal_err(call_without_gvl(call_render, &call));
+
+    return rstr;
+}
+
+/*
+ *  call-seq:
+ *      Seal.cleanup   -> nil
+ *
+ * Uninitializes Seal and invalidate all Seal objects. Thread-unsafe.
+ */
+static
+VALUE
+cleanup()
+{
+    seal_cleanup();
+    loopback_frame_size = 0;
+
+    return Qnil;
+}
+
+/*
+ *  call-seq:
+ *      Seal.per_source_effect_limit    -> fixnum
+ *
+ * Returns the maximum number of effect slots a source can feed concurrently.
+ */
+static
+VALUE
+per_source_effect_limit()
+{
+    return INT2NUM(seal_get_per_src_effect_limit());
+}
+
+/*
+ *  call-seq:
+ *      Seal.device_frequency   -> fixnum
+ *
+ * Returns the mixing frequency of the device, or 0 if Seal is not started.
+ */
+static
+VALUE
+device_frequency()
+{
+    return INT2NUM(seal_get_device_freq());
+}
+
+/*
+ *  call-seq:
+ *      Seal.resampling = true or false -> true or false
+ *
+ * Sets whether audio is resampled to the mixing frequency of the device once
+ * when loaded to buffers or streamed by sources, instead of being resampled
+ * by OpenAL on every mix. Only affects audio loaded or streamed afterwards.
+ * The default is false.
+ */
+static
+VALUE
+set_resampling(VALUE rmod, VALUE value)
+{
+    seal_set_resampling(RTEST(value));
+
+    return value;
+}
+
+/*
+ *  call-seq:
+ *      Seal.resampling     -> true or false
+ *
+ * Determines whether audio is resampled to the mixing frequency of the
+ * device.
+ */
+static
+VALUE
+is_resampling()
+{
+    return seal_is_resampling() ? Qtrue : Qfalse;
+}
+
+/*
+ *  call-seq:
+ *      Seal.unchecked = true or false  -> true or false
+ *
+ * Sets whether float attributes such as positions, velocities and gains of
+ * sources, the listener, reverbs and effect slots are set and got unchecked.
+ * Checking each call for errors costs about as much as the call itself; in
+ * unchecked mode these calls never raise, and the first error they cause is
+ * kept until Seal.check_deferred_errors is called, say once per frame. Other
+ * calls are still checked and may raise an error left by an unchecked call.
+ * Values got by failed unchecked calls are undefined. The default is false.
+ */
+static
+VALUE
+set_unchecked(VALUE rmod, VALUE value)
+{
+    seal_set_unchecked(RTEST(value));
+
+    return value;
+}
+
+/*
+ *  call-seq:
+ *      Seal.unchecked  -> true or false
+ *
+ * Determines whether float attributes are set and got unchecked.
+ */
+static
+VALUE
+is_unchecked()
+{
+    return seal_is_unchecked() ? Qtrue : Qfalse;
+}
+
+/*
+ *  call-seq:
+ *      Seal.check_deferred_errors  -> nil
+ *
+ * Raises the first error caused since the last check, if any, and clears it.
+ * Use this to poll errors of calls made in unchecked mode.
+ */
+static
+VALUE
+check_deferred_errs()
+{
+    check_seal_err(seal_get_deferred_err());
+
+    return Qnil;
+}
+
+/*
+ *  call-seq:
+ *      Seal.distance_model = sym   -> sym
+ *
+ * Sets the model of how the gain of all sources falls off with their
+ * distance to the listener: one of :none, :inverse, :inverse_clamped,
+ * :linear, :linear_clamped, :exponent or :exponent_clamped, as defined by
+ * OpenAL. The clamped models stop attenuating sources beyond their
+ * Source#max_distance and do not amplify them closer than their
+ * Source#reference_distance. The default is :inverse_clamped.
+ */
+static
+VALUE
+set_distance_model(VALUE rmod, VALUE value)
+{
+    VALUE symbol = rb_convert_type(value, T_SYMBOL, "Symbol", "to_sym");
+    size_t i;
+
+    for (i = 0; i < NDISTANCE_MODELS; ++i) {
+        if (symbol == name2sym(DISTANCE_MODEL_SYMS[i])) {
+            check_seal_err(seal_set_distance_model(i));
+            return value;
+        }
+    }
+    check_seal_err(SEAL_BAD_ENUM);
+
+    return value;
+}
+
+/*
+ *  call-seq:
+ *      Seal.distance_model -> sym
+ *
+ * Gets the distance model applied to all sources.
+ */
+static
+VALUE
+get_distance_model()
+{
+    seal_distance_model_t model;
+
+    check_seal_err(seal_get_distance_model(&model));
+
+    return name2sym(DISTANCE_MODEL_SYMS[model]);
+}
+
+/*
+ *  call-seq:
+ *      Seal.batch { block }    -> obj
+ *
+ * Batches the updates made in _block_ and returns its result. Float
+ * attributes such as positions, velocities and gains set on sources, the
+ * listener, reverbs and effect slots within _block_ reach OpenAL only once
+ * per attribute, with the last value set, when _block_ returns; the mixer
+ * then applies them all at once so that no mix reflects half of an update.
+ * Batches may nest. Errors caused by the batched updates are raised when the
+ * outermost batch ends.
+ */
+static
+VALUE
+batch(VALUE rmod)
+{
+    VALUE result;
+    int state;
+    seal_err_t err;
+
+    rb_need_block();
+    check_seal_err(seal_begin_batch());
+    result = rb_protect(rb_yield, Qnil, &state);
+    err = seal_commit_batch();
+    if (state != 0)
+        rb_jump_tag(state);
+    check_seal_err(err);
+
+    return result;
+}
+
+/*
+ *  call-seq:
+ *      Seal.thread_local_context?  -> true or false
+ *
+ * Returns whether contexts can be bound to single threads with
+ * Context#use. Only known after Seal.startup.
+ */
+static
+VALUE
+has_thread_local_context()
+{
+    return seal_has_thread_local_context() ? Qtrue : Qfalse;
+}
+
+/*
+ *  call-seq:
+ *      Seal.worker_count = count   -> count
+ *
+ * Sets the number of worker threads, which open streams for
+ * Seal::Stream.open_async among other background work. Running workers
+ * finish the work given so far and are stopped first; the new number of
+ * them is started on demand. The default is one less than the number of
+ * processors, and at least 1.
+ */
+static
+VALUE
+set_worker_count(VALUE rmod, VALUE rcount)
+{
+    nogvl_call_t call;
+    long count = NUM2LONG(rcount);
+
+    call.size = count > 0 ? (size_t) count : 0;
+    check_seal_err(call_without_gvl(call_set_worker_count, &call));
+
+    return rcount;
+}
+
+/*
+ *  call-seq:
+ *      Seal.worker_count   -> integer
+ *
+ * Gets the number of worker threads.
+ */
+static
+VALUE
+get_worker_count()
+{
+    return SIZET2NUM(seal_get_worker_count());
+}
+
+/*
+ *  call-seq:
+ *      Seal.worker_affinity = true or false    -> true or false
+ *
+ * Sets whether each worker thread asks to be kept on a processor of its
+ * own. Only a hint, honored on Linux and Windows. Restarts running workers
+ * like Seal.worker_count=. The default is false.
+ */
+static
+VALUE
+set_worker_affinity(VALUE rmod, VALUE value)
+{
+    nogvl_call_t call;
+
+    call.size = RTEST(value);
+    check_seal_err(call_without_gvl(call_set_worker_affinity, &call));
+
+    return value;
+}
+
+/*
+ *  call-seq:
+ *      Seal.worker_affinity    -> true or false
+ *
+ * Determines whether the worker threads ask to be pinned to processors.
+ */
+static
+VALUE
+has_worker_affinity()
+{
+    return seal_has_worker_affinity() ? Qtrue : Qfalse;
+}
+
+static
+VALUE
+sched2hash(seal_sched_t* sched)
+{
+    VALUE rhash = rb_hash_new();
+
+    rb_hash_aset(rhash, name2sym("policy"),
+                 name2sym(SCHED_POLICY_SYMS[sched->policy]));
+    rb_hash_aset(rhash, name2sym("priority"), INT2NUM(sched->priority));
+    rb_hash_aset(rhash, name2sym("nice"), INT2NUM(sched->nice));
+    rb_hash_aset(rhash, name2sym("cpu_mask"), ULONG2NUM(sched->cpu_mask));
+
+    return rhash;
+}
+
+/*
+ *  call-seq:
+ *      Seal.schedule_streaming(policy: sym, priority: p, nice: n,
+ *                              cpu_mask: m)    -> hash
+ *
+ * Sets how the threads that keep streaming sources fed are scheduled, so
+ * that they are not starved when other threads keep all the processors busy.
+ * _policy_ is :default, or :fifo or :rr for the real-time policies with
+ * priority _priority_; _nice_ is added to the nice level of the threads
+ * under the :default policy; _cpu_mask_ has bit i set for each processor i
+ * to run on, 0 for any. All are optional and default to the normal
+ * scheduling. Whatever is not permitted, such as real-time scheduling
+ * without privileges, falls back to what threads normally get, and a
+ * refused real-time policy falls back to the nice level. Returns what was
+ * obtained in the same form, which applies to the threads of sources
+ * started afterwards. On Windows, a real-time policy gets the highest thread
+ * priority, which is returned as the :default policy with a nice level of
+ * -20.
+ */
+static
+VALUE
+schedule_streaming(int argc, VALUE* argv)
+{
+    VALUE options;
+    VALUE value;
+    seal_sched_t sched, obtained;
+
+    rb_scan_args(argc, argv, "0:", &options);
+    if (NIL_P(options))
+        options = rb_hash_new();
+    sched.policy = SEAL_DEFAULT_SCHED;
+    value = rb_hash_aref(options, name2sym("policy"));
+    if (!NIL_P(value)) {
+        VALUE symbol = rb_convert_type(value, T_SYMBOL, "Symbol", "to_sym");
+        size_t i;
+
+        for (i = 0; i < NSCHED_POLICIES; ++i)
+            if (symbol == name2sym(SCHED_POLICY_SYMS[i]))
+                break;
+        if (i == NSCHED_POLICIES)
+            check_seal_err(SEAL_BAD_ENUM);
+        sched.policy = i;
+    }
+    value = rb_hash_aref(options, name2sym("priority"));
+    sched.priority = NIL_P(value) ? 0 : NUM2INT(value);
+    value = rb_hash_aref(options, name2sym("nice"));
+    sched.nice = NIL_P(value) ? 0 : NUM2INT(value);
+    value = rb_hash_aref(options, name2sym("cpu_mask"));
+    sched.cpu_mask = NIL_P(value) ? 0 : NUM2ULONG(value);
+    check_seal_err(seal_set_streaming_sched(&sched, &obtained));
+
+    return sched2hash(&obtained);
+}
+
+/*
+ *  call-seq:
+ *      Seal.streaming_schedule -> hash
+ *
+ * Gets how the threads that keep streaming sources fed are scheduled, as
+ * returned by Seal.schedule_streaming.
+ */
+static
+VALUE
+get_streaming_schedule()
+{
+    seal_sched_t sched;
+
+    check_seal_err(seal_get_streaming_sched(&sched));
+
+    return sched2hash(&sched);
+}
+
+/*
+ *  call-seq:
+ *      Seal::Context.new           -> context
+ *      Seal::Context.new(device)   -> context
+ *
+ * Opens _device_, or the default device if not given, and creates a context
+ * on it, in addition to the one created by Seal.startup. The context is
+ * closed when garbage collected, which invalidates the objects created in
+ * it.
+ */
+static
+VALUE
+init_context(int argc, VALUE* argv, VALUE rcontext)
+{
+    VALUE rstring;
+
+    rb_scan_args(argc, argv, "01", &rstring);
+    check_seal_err(seal_open_context(
+        DATA_PTR(rcontext),
+        NIL_P(rstring) ? 0 : rb_string_value_ptr(&rstring)
+    ));
+
+    return rcontext;
+}
+
+/*
+ *  call-seq:
+ *      context.use             -> context
+ *      context.use { block }   -> obj
+ *
+ * Binds _context_ to the current thread, so that Seal objects created and
+ * used on the thread belong to _context_ whatever the other threads use.
+ * Falls back to making _context_ current for the whole process unless
+ * Seal.thread_local_context? is true. With a block, binds _context_ only
+ * for the block and returns its result.
+ */
+static
+VALUE
+use_context(VALUE rcontext)
+{
+    seal_context_t* prev;
+    VALUE result;
+    int state;
+    seal_err_t err;
+
+    if (!rb_block_given_p()) {
+        check_seal_err(seal_use_context(DATA_PTR(rcontext)));
+        return rcontext;
+    }
+
+    prev = seal_get_context();
+    check_seal_err(seal_use_context(DATA_PTR(rcontext)));
+    result = rb_protect(rb_yield, Qnil, &state);
+    err = seal_use_context(prev);
+    if (state != 0)
+        rb_jump_tag(state);
+    check_seal_err(err);
+
+    return result;
+}
+
+/*
+ *  call-seq:
+ *      Seal::Context.unbind    -> nil
+ *
+ * Unbinds the context bound to the current thread, which goes back to the
+ * context current for the process. Threads that bound a context should
+ * unbind before exiting.
+ */
+static
+VALUE
+unbind_context(VALUE rklass)
+{
+    check_seal_err(seal_use_context(0));
+
+    return Qnil;
+}
+
+/*
+ *  call-seq:
+ *      Seal.probe(filename)    -> hash
+ *
+ * Learns about the audio file _filename_ without decoding it. Returns a hash
+ * with the keys :format, :frequency, :bit_depth, :channel_count,
+ * :frame_count and :seekable. :frame_count is 0 if unknown, and is estimated
+ * for MPEG audio without a Xing or LAME header.
+ */
+static
+VALUE
+probe(VALUE rmod, VALUE filename)
+{
+    seal_audio_info_t info;
+    nogvl_call_t call;
+
+    filename = freeze_str(filename);
+    call.obj = &info;
+    call.filename = RSTRING_PTR(filename);
+    check_seal_err(call_without_gvl(call_probe, &call));
+    RB_GC_GUARD(filename);
+
+    return info2hash(&info);
+}
+
+/*
+ *  call-seq:
+ *      Seal::Manifest.new              -> manifest
+ *      Seal::Manifest.new(filename)    -> manifest
+ *
+ * Initializes a new manifest, which caches the results of Seal.probe, and
+ * loads the entries saved in _filename_ if given. See Manifest#load.
+ */
+static
+VALUE
+init_manifest(int argc, VALUE* argv, VALUE rmanifest)
+{
+    VALUE filename;
+
+    rb_scan_args(argc, argv, "01", &filename);
+    check_seal_err(seal_init_manifest(DATA_PTR(rmanifest)));
+    if (!NIL_P(filename))
+        check_seal_err(seal_load_manifest(DATA_PTR(rmanifest),
+                                          rb_string_value_ptr(&filename)));
+
+    return rmanifest;
+}
+
+/*
+ *  call-seq:
+ *      manifest.load(filename) -> manifest
+ *
+ * Adds the entries saved in the manifest file _filename_ to _manifest_. A
+ * missing file is treated as an empty one.
+ */
+static
+VALUE
+load_manifest(VALUE rmanifest, VALUE filename)
+{
+    check_seal_err(seal_load_manifest(DATA_PTR(rmanifest),
+                                      rb_string_value_ptr(&filename)));
+
+    return rmanifest;
+}
+
+/*
+ *  call-seq:
+ *      manifest.save(filename) -> manifest
+ *
+ * Saves all the entries of _manifest_ to the manifest file _filename_.
+ */
+static
+VALUE
+save_manifest(VALUE rmanifest, VALUE filename)
+{
+    check_seal_err(seal_save_manifest(DATA_PTR(rmanifest),
+                                      rb_string_value_ptr(&filename)));
+
+    return rmanifest;
+}
+
+/*
+ *  call-seq:
+ *      manifest.probe(filename)    -> hash
+ *
+ * Same as Seal.probe except that the result is taken from _manifest_ if the
+ * size and modification time of _filename_ have not changed since it was
+ * recorded. Otherwise _filename_ is probed and the result recorded.
+ */
+static
+VALUE
+probe_cached(VALUE rmanifest, VALUE filename)
+{
+    seal_audio_info_t info;
+
+    check_seal_err(seal_probe_cached(DATA_PTR(rmanifest),
+                                     rb_string_value_ptr(&filename), &info));
+
+    return info2hash(&info);
+}
+
+/*
+ *  call-seq:
+ *      manifest.size   -> fixnum
+ *
+ * Gets the number of entries in _manifest_.
+ */
+static
+VALUE
+get_manifest_size(VALUE rmanifest)
+{
+    size_t size;
+
+    check_seal_err(seal_get_manifest_size(DATA_PTR(rmanifest), &size));
+
+    return SIZET2NUM(size);
+}
+
+/*
+ *  call-seq:
+ *      Seal::Buffer.new(filename [, format] [, mono: false])   -> buffer
+ *
+ * Initializes a new buffer and loads it with audio from _filename_. _format_
+ * specifies the format of the audio file; automatic recognition of the audio
+ * format will be attempted if _format_ is not specified. See Seal::Format for
+ * possible values. Sets all the attributes appropriately. If _mono_ is true,
+ * stereo audio is downmixed to mono so that it can be positioned in 3D space,
+ * which OpenAL only does for mono buffers.
+ *
+ * There is a limit on the number of allocated buffers. This method raises an
+ * error if it is exceeding the limit.
+ */
+static
+VALUE
+init_buf(int argc, VALUE* argv, VALUE rbuf)
+{
+    seal_buf_t* buf;
+
+    buf = DATA_PTR(rbuf);
+    check_seal_err(seal_init_buf(buf));
+    load_audio2buf(argc, argv, buf);
+
+    return rbuf;
+}
+
+/*
+ *  call-seq:
+ *      buffer.load(filename [, format] [, mono: false])   -> buffer
+ *
+ * Loads audio from _filename_ to _buffer_ which must not be currently used by
+ * any source. Sets all the attributes appropriately. _format_ specifies the
+ * format of the audio file; automatic recognition of the audio format will be
+ * attempted if _format_ is not specified. See Seal::Format for possible
+ * values.Sets all the attributes appropriately. If _mono_ is true, stereo
+ * audio is downmixed to mono.
+ */
+static
+VALUE
+load_buf(int argc, VALUE* argv, VALUE rbuf)
+{
+    rb_check_frozen(rbuf);
+    load_audio2buf(argc, argv, DATA_PTR(rbuf));
+
+    return rbuf;
+}
+
+/*
+ *  call-seq:
+ *      Seal::Buffer.from_pcm(string, frequency: f, channels: n, bit_depth: b)
+ *          -> buffer
+ *
+ * Initializes a new buffer with the raw PCM data in _string_, which is
+ * handed to OpenAL as is without being copied first, so that procedurally
+ * generated audio and audio read from archives need not go through files.
+ * Samples are interleaved; 8-bit samples are unsigned and 16-bit samples are
+ * signed in native byte order. _channels_ is 1 or 2 and _bit_depth_ is 8 or
+ * 16.
+ */
+static
+VALUE
+buf_from_pcm(int argc, VALUE* argv, VALUE klass)
+{
+    VALUE rpcm;
+    VALUE options;
+    VALUE rbuf = rb_obj_alloc(klass);
+    seal_buf_t* buf = DATA_PTR(rbuf);
+    seal_raw_t raw;
+
+    rb_scan_args(argc, argv, "1:", &rpcm, &options);
+    StringValue(rpcm);
+    if (NIL_P(options))
+        options = rb_hash_new();
+    raw.attr.freq = NUM2INT(rb_hash_fetch(options, name2sym("frequency")));
+    raw.attr.nchannels = NUM2INT(rb_hash_fetch(options, name2sym("channels")));
+    raw.attr.bit_depth = NUM2INT(rb_hash_fetch(options,
+                                               name2sym("bit_depth")));
+    raw.data = RSTRING_PTR(rpcm);
+    raw.size = RSTRING_LEN(rpcm);
+
+    check_seal_err(seal_init_buf(buf));
+    check_seal_err(seal_raw2buf(buf, &raw));
+    RB_GC_GUARD(rpcm);
+    adjust_memory_usage((long) get_buf_nbytes(buf));
+
+    return rbuf;
+}
+
+/*
+ *  call-seq:
+ *      buffer.size ->  fixnum
+ *
+ * Gets the size, in bytes, of _buffer_.
+ */
+static
+VALUE
+get_buf_size(VALUE rbuf)
+{
+    return get_obj_int(rbuf, seal_get_buf_size);
+}
+
+/*
+ *  call-seq:
+ *      buffer.frequency    -> fixnum
+ *
+ * Gets the frequency (sample rate) of the audio contained in _buffer_.
+ */
+static
+VALUE
+get_buf_freq(VALUE rbuf)
+{
+    return get_obj_int(rbuf, seal_get_buf_freq);
+}
+
+/*
+ *  call-seq:
+ *      buffer.bit_depth    -> fixnum
+ *
+ * Gets the bit depth (bits per sample) of the audio contained in _buffer_.
+ */
+static
+VALUE
+get_buf_bps(VALUE rbuf)
+{
+    return get_obj_int(rbuf, seal_get_buf_bps);
+}
+
+/*
+ *  call-seq:
+ *      buffer.channel_count    -> fixnum
+ *
+ * Gets the number of channels of the audio contained in _buffer_.
+ */
+static
+VALUE
+get_buf_nchannels(VALUE rbuf)
+{
+    return get_obj_int(rbuf, seal_get_buf_nchannels);
+}
+
+/*
+ *  call-seq:
+ *      Seal::CompressedBuffer.new(filename [, format])   -> compressed_buffer
+ *
+ * Initializes a new compressed buffer and loads it with the encoded audio
+ * from _filename_. _format_ specifies the format of the audio file; automatic
+ * recognition of the audio format will be attempted if _format_ is nil. See
+ * Seal::Format for possible values. WAVE files are not supported.
+ */
+static
+VALUE
+init_cbuf(int argc, VALUE* argv, VALUE rcbuf)
+{
+    seal_cbuf_t* cbuf;
+
+    cbuf = DATA_PTR(rcbuf);
+    check_seal_err(seal_init_cbuf(cbuf));
+    load_audio2cbuf(argc, argv, cbuf);
+
+    return rcbuf;
+}
+
+/*
+ *  call-seq:
+ *      compressed_buffer.load(filename [, format])   -> compressed_buffer
+ *
+ * Loads the encoded audio from _filename_ to _compressed_buffer_ which must
+ * not be currently used by any source. _format_ specifies the format of the
+ * audio file; automatic recognition of the audio format will be attempted if
+ * _format_ is nil. See Seal::Format for possible values.
+ */
 static
-seal_stream_t*
-extract_stream(VALUE rstream)
+VALUE
+load_cbuf(int argc, VALUE* argv, VALUE rcbuf)
 {
-    return DATA_PTR(rstream);
+    rb_check_frozen(rcbuf);
+    load_audio2cbuf(argc, argv, DATA_PTR(rcbuf));
+
+    return rcbuf;
 }
 
 /*
  *  call-seq:
- *      Seal.startup       -> nil
- *      Seal.startup(str)  -> nil
+ *      compressed_buffer.size ->  fixnum
  *
- * Initializes Seal by specifying the device name _str_. This function is
- * not re-entrant nor thread-safe and should be called only once per Seal
- * session. Match a call to <code>seal_startup</code> with a call to
- * <code>seal_cleanup</code> and never call <code>seal_starup</code> twice in
- * a row.
+ * Gets the size, in bytes, of the encoded audio in _compressed_buffer_.
  */
 static
 VALUE
-startup(int argc, VALUE* argv)
+get_cbuf_size(VALUE rcbuf)
 {
-    VALUE rstring;
-
-    rb_scan_args(argc, argv, "01", &rstring);
-    check_seal_err(seal_startup(NIL_P(rstring)
-                   ? 0 : rb_string_value_ptr(&rstring)));
-
-    return Qnil;
+    return get_obj_int(rcbuf, seal_get_cbuf_size);
 }
 
 /*
  *  call-seq:
- *      Seal.cleanup   -> nil
+ *      compressed_buffer.frequency    -> fixnum
  *
- * Uninitializes Seal and invalidate all Seal objects. Thread-unsafe.
+ * Gets the frequency (sample rate) of the audio contained in
+ * _compressed_buffer_.
  */
 static
 VALUE
-cleanup()
+get_cbuf_freq(VALUE rcbuf)
 {
-    seal_cleanup();
-
-    return Qnil;
+    return get_obj_int(rcbuf, seal_get_cbuf_freq);
 }
 
 /*
  *  call-seq:
- *      Seal.per_source_effect_limit    -> fixnum
+ *      compressed_buffer.bit_depth    -> fixnum
  *
- * Returns the maximum number of effect slots a source can feed concurrently.
+ * Gets the bit depth (bits per sample) of the decoded audio of
+ * _compressed_buffer_.
  */
 static
 VALUE
-per_source_effect_limit()
+get_cbuf_bps(VALUE rcbuf)
 {
-    return INT2NUM(seal_get_per_src_effect_limit());
+    return get_obj_int(rcbuf, seal_get_cbuf_bps);
 }
 
 /*
  *  call-seq:
- *      Seal::Buffer.new(filename [, format])   -> buffer
+ *      compressed_buffer.channel_count    -> fixnum
  *
- * Initializes a new buffer and loads it with audio from _filename_. _format_
- * specifies the format of the audio file; automatic recognition of the audio
- * format will be attempted if _format_ is not specified. See Seal::Format for
- * possible values. Sets all the attributes appropriately.
- *
- * There is a limit on the number of allocated buffers. This method raises an
- * error if it is exceeding the limit.
+ * Gets the number of channels of the audio contained in _compressed_buffer_.
  */
 static
 VALUE
-init_buf(int argc, VALUE* argv, VALUE rbuf)
+get_cbuf_nchannels(VALUE rcbuf)
 {
-    seal_buf_t* buf;
-
-    buf = DATA_PTR(rbuf);
-    check_seal_err(seal_init_buf(buf));
-    input_audio(argc, argv, buf, seal_load2buf);
-
-    return rbuf;
+    return get_obj_int(rcbuf, seal_get_cbuf_nchannels);
 }
 
 /*
  *  call-seq:
- *      buffer.load(filename [, format])   -> buffer
+ *      Seal::Stream.new(filename [, format])   -> stream
+ *      Seal::Stream.open(filename [, format])  -> stream
  *
- * Loads audio from _filename_ to _buffer_ which must not be currently used by
- * any source. Sets all the attributes appropriately. _format_ specifies the
- * format of the audio file; automatic recognition of the audio format will be
- * attempted if _format_ is not specified. See Seal::Format for possible
- * values.Sets all the attributes appropriately.
+ * Opens a audio stream from _filename_. _format_ specifies the format of the
+ * audio file; automatic recognition of the audio format will be attempted if
+ * _format_ is nil. See Seal::Format for possible values.
  */
 static
 VALUE
-load_buf(int argc, VALUE* argv, VALUE rbuf)
+init_stream(int argc, VALUE* argv, VALUE rstream)
 {
-    input_audio(argc, argv, DATA_PTR(rbuf), seal_load2buf);
+    input_audio(argc, argv, DATA_PTR(rstream), seal_open_stream);
 
-    return rbuf;
+    return rstream;
 }
 
 /*
  *  call-seq:
- *      buffer.size ->  fixnum
+ *      Seal::Stream.open_async(filename [, format])    -> stream
  *
- * Gets the size, in bytes, of _buffer_.
+ * Same as Seal::Stream.open except that the stream is opened on a worker
+ * thread (see Seal.worker_count=) so that this returns immediately. The
+ * returned stream can be attached to a source and played right away;
+ * playback starts once the stream is opened. Other methods of the stream wait
+ * until it is opened. Use Stream#opening? to poll and Stream#wait to wait for
+ * it.
  */
 static
 VALUE
-get_buf_size(VALUE rbuf)
+open_stream_async(int argc, VALUE* argv, VALUE klass)
 {
-    return get_obj_int(rbuf, seal_get_buf_size);
+    VALUE filename;
+    VALUE format;
+    VALUE rstream = rb_obj_alloc(klass);
+
+    rb_scan_args(argc, argv, "11", &filename, &format);
+    check_seal_err(seal_open_stream_async(DATA_PTR(rstream),
+                                          rb_string_value_ptr(&filename),
+                                          map_format(format), 0, 0));
+
+    return rstream;
 }
 
 /*
  *  call-seq:
- *      buffer.frequency    -> fixnum
+ *      Seal::Stream.fast_open = true or false  -> true or false
  *
- * Gets the frequency (sample rate) of the audio contained in _buffer_.
+ * Sets whether streams are opened in fast mode. Opening an Ogg Vorbis file
+ * normally seeks across the whole file to find its chained links and length
+ * before anything can be decoded; fast mode skips that so playback can start
+ * sooner. Rewinding a fast-opened stream decodes the file from the start
+ * again. Only affects streams opened afterwards. The default is false.
  */
 static
 VALUE
-get_buf_freq(VALUE rbuf)
+set_fast_stream_open(VALUE klass, VALUE value)
 {
-    return get_obj_int(rbuf, seal_get_buf_freq);
+    seal_set_fast_stream_open(RTEST(value));
+
+    return value;
 }
 
 /*
  *  call-seq:
- *      buffer.bit_depth    -> fixnum
+ *      Seal::Stream.fast_open  -> true or false
  *
- * Gets the bit depth (bits per sample) of the audio contained in _buffer_.
+ * Determines whether streams are opened in fast mode.
  */
 static
 VALUE
-get_buf_bps(VALUE rbuf)
+is_fast_stream_open()
 {
-    return get_obj_int(rbuf, seal_get_buf_bps);
+    return seal_is_fast_stream_open() ? Qtrue : Qfalse;
 }
 
 /*
  *  call-seq:
- *      buffer.channel_count    -> fixnum
+ *      stream.opening? -> true or false
  *
- * Gets the number of channels of the audio contained in _buffer_.
+ * Determines if _stream_ is still being opened by Seal::Stream.open_async.
  */
 static
 VALUE
-get_buf_nchannels(VALUE rbuf)
+is_stream_opening(VALUE rstream)
 {
-    return get_obj_int(rbuf, seal_get_buf_nchannels);
+    return get_obj_char(rstream, seal_is_stream_opening);
 }
 
 /*
  *  call-seq:
- *      Seal::Stream.new(filename [, format])   -> stream
- *      Seal::Stream.open(filename [, format])  -> stream
+ *      stream.wait -> stream
  *
- * Opens a audio stream from _filename_. _format_ specifies the format of the
- * audio file; automatic recognition of the audio format will be attempted if
- * _format_ is nil. See Seal::Format for possible values.
+ * Waits until _stream_ opened by Seal::Stream.open_async is opened. Raises an
+ * error if it failed to open.
  */
 static
 VALUE
-init_stream(int argc, VALUE* argv, VALUE rstream)
+wait_stream(VALUE rstream)
 {
-    input_audio(argc, argv, DATA_PTR(rstream), seal_open_stream);
+    check_seal_err(op_without_gvl(DATA_PTR(rstream), seal_wait_stream));
 
     return rstream;
 }
@@ -520,6 +1945,92 @@ get_stream_nchannels(VALUE rstream)
     return INT2NUM(extract_stream(rstream)->attr.nchannels);
 }
 
+/*
+ *  call-seq:
+ *      stream.read_ahead = fixnum  -> fixnum
+ *
+ * Sets the size, in bytes, of the read-ahead window of _stream_. Each time
+ * _stream_ reads from its file, the OS is asked to fetch this many bytes past
+ * the read in the background, so that sources refilled from _stream_ rarely
+ * wait for the disk. 0 disables read-ahead.
+ */
+static
+VALUE
+set_stream_read_ahead(VALUE rstream, VALUE value)
+{
+    return set_obj_int(rstream, value, seal_set_stream_readahead);
+}
+
+/*
+ *  call-seq:
+ *      stream.read_ahead   -> fixnum
+ *
+ * Gets the size, in bytes, of the read-ahead window of _stream_. The default
+ * is 262144 for streams opened from files and 0 for streams opened on
+ * compressed buffers.
+ */
+static
+VALUE
+get_stream_read_ahead(VALUE rstream)
+{
+    return get_obj_int(rstream, seal_get_stream_readahead);
+}
+
+/*
+ *  call-seq:
+ *      stream.read(nbytes [, into: string])  -> string or nil
+ *
+ * Decodes up to _nbytes_ bytes of PCM data from _stream_ and returns them as
+ * a binary string, or nil at the end of _stream_. If _string_ is given, the
+ * data are decoded into it in place and it is returned, so that analysis
+ * loops can reuse one string instead of allocating one per chunk. ADPCM WAVE
+ * streams only decode whole blocks, so _nbytes_ must be at least the size of
+ * a decoded block.
+ */
+static
+VALUE
+read_stream(int argc, VALUE* argv, VALUE rstream)
+{
+    VALUE rnbytes;
+    VALUE options;
+    VALUE rstr = Qnil;
+    long nbytes;
+    seal_raw_t raw;
+    nogvl_call_t call;
+
+    rb_scan_args(argc, argv, "1:", &rnbytes, &options);
+    nbytes = NUM2LONG(rnbytes);
+    if (nbytes < 0)
+        rb_raise(rb_eArgError, "negative length %ld given", nbytes);
+    if (!NIL_P(options))
+        rstr = rb_hash_aref(options, name2sym("into"));
+    if (NIL_P(rstr)) {
+        rstr = rb_str_buf_new(nbytes);
+    } else {
+        StringValue(rstr);
+        rb_str_modify(rstr);
+        if (nbytes > RSTRING_LEN(rstr))
+            rb_str_modify_expand(rstr, nbytes - RSTRING_LEN(rstr));
+        rb_enc_associate(rstr, rb_ascii8bit_encoding());
+    }
+    if (nbytes == 0) {
+        rb_str_set_len(rstr, 0);
+        return rstr;
+    }
+
+    raw.data = RSTRING_PTR(rstr);
+    raw.size = nbytes;
+    call.obj = DATA_PTR(rstream);
+    call.raw = &raw;
+    rb_str_locktmp(rstr);
+    call_without_gvl(call_stream_into, &call);
+    rb_str_unlocktmp(rstr);
+    check_seal_err(call.err);
+    rb_str_set_len(rstr, call.size);
+
+    return call.size == 0 ? Qnil : rstr;
+}
+
 /*
  *  call-seq:
  *      stream.rewind   -> stream
@@ -584,7 +2095,7 @@ static
 VALUE
 play_src(VALUE rsrc)
 {
-    return src_op(rsrc, seal_play_src);
+    return blocking_src_op(rsrc, seal_play_src);
 }
 
 /*
@@ -614,7 +2125,7 @@ static
 VALUE
 stop_src(VALUE rsrc)
 {
-    return src_op(rsrc, seal_stop_src);
+    return blocking_src_op(rsrc, seal_stop_src);
 }
 
 /*
@@ -671,12 +2182,17 @@ VALUE
 set_src_buf(VALUE rsrc, VALUE rbuf)
 {
     seal_buf_t* buf;
+    VALUE lock;
+    seal_err_t err;
 
     if (NIL_P(rbuf)) {
         src_op(rsrc, seal_detach_src_audio);
     } else {
-        Data_Get_Struct(rbuf, seal_buf_t, buf);
-        check_seal_err(seal_set_src_buf(DATA_PTR(rsrc), buf));
+        TypedData_Get_Struct(rbuf, seal_buf_t, &buf_type, buf);
+        lock = lock_obj(rsrc);
+        err = seal_set_src_buf(DATA_PTR(rsrc), buf);
+        unlock_obj(lock);
+        check_seal_err(err);
     }
     rb_iv_set(rsrc, "@buffer", rbuf);
 
@@ -721,18 +2237,74 @@ VALUE
 set_src_stream(VALUE rsrc, VALUE rstream)
 {
     seal_stream_t* stream;
+    VALUE lock;
+    seal_err_t err;
 
     if (NIL_P(rstream)) {
         src_op(rsrc, seal_detach_src_audio);
     } else {
-        Data_Get_Struct(rstream, seal_stream_t, stream);
-        check_seal_err(seal_set_src_stream(DATA_PTR(rsrc), stream));
+        TypedData_Get_Struct(rstream, seal_stream_t, &stream_type, stream);
+        lock = lock_obj(rsrc);
+        err = seal_set_src_stream(DATA_PTR(rsrc), stream);
+        unlock_obj(lock);
+        check_seal_err(err);
     }
     rb_iv_set(rsrc, "@stream", rstream);
 
     return rstream;
 }
 
+/*
+ *  call-seq:
+ *      source.compressed_buffer = compressed_buffer  -> compressed_buffer
+ *      source.compressed_buffer = nil                -> nil
+ *
+ * Associates _compressed_buffer_ with _source_ so that the source decodes
+ * and plays the audio in memory as it goes. Can be applied to sources in any
+ * playing state but not on static sources nor on sources with a stream
+ * assigned through #stream=. Replacing an attached compressed buffer with a
+ * different one stops the source. If successful, the source will become or
+ * remain as Type::STREAMING.
+ *
+ * If nil is specified, the source will give up the compressed buffer it has
+ * and will reset the source to Type::UNDETERMINED and the source state to
+ * State::STOPPED. It will not free the compressed buffer.
+ */
+static
+VALUE
+set_src_cbuf(VALUE rsrc, VALUE rcbuf)
+{
+    seal_cbuf_t* cbuf;
+    VALUE lock;
+    seal_err_t err;
+
+    if (NIL_P(rcbuf)) {
+        src_op(rsrc, seal_detach_src_audio);
+    } else {
+        TypedData_Get_Struct(rcbuf, seal_cbuf_t, &cbuf_type, cbuf);
+        lock = lock_obj(rsrc);
+        err = seal_set_src_cbuf(DATA_PTR(rsrc), cbuf);
+        unlock_obj(lock);
+        check_seal_err(err);
+    }
+    rb_iv_set(rsrc, "@compressed_buffer", rcbuf);
+
+    return rcbuf;
+}
+
+/*
+ *  call-seq:
+ *      source.compressed_buffer ->    compressed_buffer
+ *
+ * Gets the compressed buffer of _source_. The default is nil.
+ */
+static
+VALUE
+get_src_cbuf(VALUE rsrc)
+{
+    return rb_iv_get(rsrc, "@compressed_buffer");
+}
+
 /*
  *  call-seq:
  *      source.stream   -> stream
@@ -762,9 +2334,15 @@ VALUE
 feed_efs(VALUE rsrc, VALUE rslot, VALUE rindex)
 {
     seal_src_t* src;
+    int index = NUM2INT(rindex);
+    VALUE lock;
+    seal_err_t err;
 
-    Data_Get_Struct(rsrc, seal_src_t, src);
-    check_seal_err(seal_feed_efs(src, DATA_PTR(rslot), NUM2INT(rindex)));
+    TypedData_Get_Struct(rsrc, seal_src_t, &src_type, src);
+    lock = lock_obj(rsrc);
+    err = seal_feed_efs(src, DATA_PTR(rslot), index);
+    unlock_obj(lock);
+    check_seal_err(err);
 
     return rsrc;
 }
@@ -784,7 +2362,7 @@ feed_efs(VALUE rsrc, VALUE rslot, VALUE rindex)
 static
 VALUE update_src(VALUE rsrc)
 {
-    return src_op(rsrc, seal_update_src);
+    return blocking_src_op(rsrc, seal_update_src);
 }
 
 /*
@@ -829,6 +2407,89 @@ set_src_vel(VALUE rsrc, VALUE value)
     return set_obj_3float(rsrc, value, seal_set_src_vel);
 }
 
+/*
+ * Collects the sources in the Array _rsrcs_ into a temporary string _rbuf_
+ * so that the GC reclaims it if we raise.
+ */
+static
+seal_src_t**
+get_srcs(VALUE rsrcs, VALUE* rbuf)
+{
+    long i, n = RARRAY_LEN(rsrcs);
+    seal_src_t** srcs;
+
+    *rbuf = rb_str_tmp_new(n * sizeof (seal_src_t*));
+    srcs = (seal_src_t**) RSTRING_PTR(*rbuf);
+    for (i = 0; i < n; ++i)
+        TypedData_Get_Struct(rb_ary_entry(rsrcs, i), seal_src_t, &src_type,
+                             srcs[i]);
+
+    return srcs;
+}
+
+/*
+ *  call-seq:
+ *      Seal::Source.update_transforms(sources, transforms) -> sources
+ *
+ * Sets the positions, and optionally the velocities, of many _sources_ at
+ * once. _transforms_ is a String of packed native floats, such as one made
+ * by <code>Array#pack('f*')</code>, that holds the x, y, z position of each
+ * source in order, optionally followed by the x, y, z velocity of each
+ * source in order. This is much faster than setting the position and
+ * velocity of each source in turn, and all the changes take effect at once.
+ */
+static
+VALUE
+update_src_transforms(VALUE rcls, VALUE rsrcs, VALUE rtransforms)
+{
+    long n, nfloats;
+    const float* pos;
+    seal_src_t** srcs;
+    VALUE rbuf;
+
+    rsrcs = rb_convert_type(rsrcs, T_ARRAY, "Array", "to_a");
+    StringValue(rtransforms);
+    n = RARRAY_LEN(rsrcs);
+    nfloats = RSTRING_LEN(rtransforms) / (long) sizeof (float);
+    if (RSTRING_LEN(rtransforms) % sizeof (float) != 0
+        || (nfloats != n * 3 && nfloats != n * 6))
+        rb_raise(rb_eArgError, "expected %ld or %ld packed floats for %ld "
+                 "sources", n * 3, n * 6, n);
+
+    srcs = get_srcs(rsrcs, &rbuf);
+    pos = (const float*) RSTRING_PTR(rtransforms);
+    check_seal_err(seal_set_src_transforms(srcs, n, pos,
+                                           nfloats == n * 6 ? pos + n * 3
+                                                            : 0));
+    RB_GC_GUARD(rbuf);
+
+    return rsrcs;
+}
+
+/*
+ *  call-seq:
+ *      Seal::Source.move_all(sources, dt) -> sources
+ *
+ * Moves all the _sources_, adding to the position of each source its
+ * velocity scaled by _dt_, usually the time elapsed since the last move.
+ * This is much faster than calling Seal::Source#move on each source, and all
+ * the changes take effect at once.
+ */
+static
+VALUE
+move_srcs(VALUE rcls, VALUE rsrcs, VALUE rdt)
+{
+    seal_src_t** srcs;
+    VALUE rbuf;
+
+    rsrcs = rb_convert_type(rsrcs, T_ARRAY, "Array", "to_a");
+    srcs = get_srcs(rsrcs, &rbuf);
+    check_seal_err(seal_move_srcs(srcs, RARRAY_LEN(rsrcs), NUM2DBL(rdt)));
+    RB_GC_GUARD(rbuf);
+
+    return rsrcs;
+}
+
 /*
  *  call-seq:
  *      source.velocity -> [flt, flt, flt]
@@ -855,48 +2516,145 @@ static
 VALUE
 set_src_pitch(VALUE rsrc, VALUE value)
 {
-    return set_obj_float(rsrc, value, seal_set_src_pitch);
+    return set_obj_float(rsrc, value, seal_set_src_pitch);
+}
+
+/*
+ *  call-seq:
+ *      source.pitch    -> flt
+ *
+ * Gets the pitch of _source_. The default is 1.0.
+ */
+static
+VALUE
+get_src_pitch(VALUE rsrc)
+{
+    return get_obj_float(rsrc, seal_get_src_pitch);
+}
+
+/*
+ *  call-seq:
+ *      source.gain = flt   -> [flt, flt, flt]
+ *
+ * Sets the scalar amplitude multiplier of _source_ in the interval
+ * [0.0, +inf.). 1.0 means that the sound is unattenuated; 0.5 means an
+ * attenuation of 6 dB; 0.0 means silence.
+ */
+static
+VALUE
+set_src_gain(VALUE rsrc, VALUE value)
+{
+    return set_obj_float(rsrc, value, seal_set_src_gain);
+}
+
+/*
+ *  call-seq:
+ *      source.gain -> flt
+ *
+ * Gets the gain of _source_. The default is 1.0.
+ */
+static
+VALUE
+get_src_gain(VALUE rsrc)
+{
+    return get_obj_float(rsrc, seal_get_src_gain);
+}
+
+/*
+ *  call-seq:
+ *      source.rolloff_factor = flt -> flt
+ *
+ * Sets the rolloff factor of _source_ in the interval [0.0, +inf.), which
+ * scales how fast its gain falls off with distance under Seal.distance_model.
+ * 0.0 disables distance attenuation for _source_.
+ */
+static
+VALUE
+set_src_rolloff_factor(VALUE rsrc, VALUE value)
+{
+    return set_obj_float(rsrc, value, seal_set_src_rolloff_factor);
+}
+
+/*
+ *  call-seq:
+ *      source.rolloff_factor   -> flt
+ *
+ * Gets the rolloff factor of _source_. The default is 1.0.
+ */
+static
+VALUE
+get_src_rolloff_factor(VALUE rsrc)
+{
+    return get_obj_float(rsrc, seal_get_src_rolloff_factor);
+}
+
+/*
+ *  call-seq:
+ *      source.reference_distance = flt -> flt
+ *
+ * Sets the reference distance of _source_ in the interval [0.0, +inf.), the
+ * distance at which its gain is not attenuated by distance.
+ */
+static
+VALUE
+set_src_ref_dist(VALUE rsrc, VALUE value)
+{
+    return set_obj_float(rsrc, value, seal_set_src_ref_dist);
+}
+
+/*
+ *  call-seq:
+ *      source.reference_distance   -> flt
+ *
+ * Gets the reference distance of _source_. The default is 1.0.
+ */
+static
+VALUE
+get_src_ref_dist(VALUE rsrc)
+{
+    return get_obj_float(rsrc, seal_get_src_ref_dist);
 }
 
 /*
  *  call-seq:
- *      source.pitch    -> flt
+ *      source.max_distance = flt   -> flt
  *
- * Gets the pitch of _source_. The default is 1.0.
+ * Sets the maximum distance of _source_ in the interval [0.0, +inf.), beyond
+ * which clamped distance models stop attenuating it. A Seal::Culler also
+ * culls _source_ beyond this distance.
  */
 static
 VALUE
-get_src_pitch(VALUE rsrc)
+set_src_max_dist(VALUE rsrc, VALUE value)
 {
-    return get_obj_float(rsrc, seal_get_src_pitch);
+    return set_obj_float(rsrc, value, seal_set_src_max_dist);
 }
 
 /*
  *  call-seq:
- *      source.gain = flt   -> [flt, flt, flt]
+ *      source.max_distance -> flt
  *
- * Sets the scalar amplitude multiplier of _source_ in the interval
- * [0.0, +inf.). 1.0 means that the sound is unattenuated; 0.5 means an
- * attenuation of 6 dB; 0.0 means silence.
+ * Gets the maximum distance of _source_. The default is the largest single
+ * precision float, which means no maximum distance.
  */
 static
 VALUE
-set_src_gain(VALUE rsrc, VALUE value)
+get_src_max_dist(VALUE rsrc)
 {
-    return set_obj_float(rsrc, value, seal_set_src_gain);
+    return get_obj_float(rsrc, seal_get_src_max_dist);
 }
 
 /*
  *  call-seq:
- *      source.gain -> flt
+ *      source.culled?  -> true or false
  *
- * Gets the gain of _source_. The default is 1.0.
+ * Determines whether _source_ is paused by the Seal::Culler it is in.
  */
 static
 VALUE
-get_src_gain(VALUE rsrc)
+is_src_culled(VALUE rsrc)
 {
-    return get_obj_float(rsrc, seal_get_src_gain);
+    return get_obj_char(rsrc, seal_is_src_culled);
 }
 
 /*
@@ -1058,8 +2816,12 @@ VALUE
 get_src_type(VALUE rsrc)
 {
     seal_src_type_t type;
+    VALUE lock = lock_obj(rsrc);
+    seal_err_t err;
 
-    check_seal_err(seal_get_src_type(DATA_PTR(rsrc), &type));
+    err = seal_get_src_type(DATA_PTR(rsrc), &type);
+    unlock_obj(lock);
+    check_seal_err(err);
     switch (type) {
     case SEAL_STATIC:
         return name2sym(STATIC_SYM);
@@ -1081,8 +2843,12 @@ VALUE
 get_src_state(VALUE rsrc)
 {
     seal_src_state_t state;
+    VALUE lock = lock_obj(rsrc);
+    seal_err_t err;
 
-    check_seal_err(seal_get_src_state(DATA_PTR(rsrc), &state));
+    err = seal_get_src_state(DATA_PTR(rsrc), &state);
+    unlock_obj(lock);
+    check_seal_err(err);
     switch (state) {
     case SEAL_PLAYING:
         return name2sym(PLAYING_SYM);
@@ -1095,6 +2861,109 @@ get_src_state(VALUE rsrc)
     }
 }
 
+/*
+ *  call-seq:
+ *      Seal::Culler.new(cell_size)    -> culler
+ *
+ * Initializes a new culler whose grid cells have the edge length
+ * _cell_size_, which works best around the typical maximum distance of the
+ * sources.
+ */
+static
+VALUE
+init_culler(VALUE rculler, VALUE rcell_size)
+{
+    check_seal_err(seal_init_culler(DATA_PTR(rculler), NUM2DBL(rcell_size)));
+
+    return rculler;
+}
+
+/*
+ *  call-seq:
+ *      culler.add(source)  -> culler
+ *
+ * Adds _source_ to _culler_. A source can be in at most one culler at a
+ * time.
+ */
+static
+VALUE
+add_culled_src(VALUE rculler, VALUE rsrc)
+{
+    seal_src_t* src;
+    VALUE lock;
+    seal_err_t err;
+
+    TypedData_Get_Struct(rsrc, seal_src_t, &src_type, src);
+    lock = lock_obj(rsrc);
+    err = seal_add_culled_src(DATA_PTR(rculler), src);
+    unlock_obj(lock);
+    check_seal_err(err);
+
+    return rculler;
+}
+
+/*
+ *  call-seq:
+ *      culler.remove(source)   -> culler
+ *
+ * Removes _source_ from _culler_. Does nothing if _source_ is not in
+ * _culler_. The source is left paused if it is culled at the time.
+ */
+static
+VALUE
+remove_culled_src(VALUE rculler, VALUE rsrc)
+{
+    seal_src_t* src;
+    VALUE lock;
+    seal_err_t err;
+
+    TypedData_Get_Struct(rsrc, seal_src_t, &src_type, src);
+    lock = lock_obj(rsrc);
+    err = seal_remove_culled_src(DATA_PTR(rculler), src);
+    unlock_obj(lock);
+    check_seal_err(err);
+
+    return rculler;
+}
+
+/*
+ *  call-seq:
+ *      culler.cull(dt) -> culler
+ *
+ * Runs a cull pass, usually once per frame, where _dt_ is the time in
+ * seconds elapsed since the last pass. Playing sources farther from the
+ * listener than their Source#max_distance are paused and culled sources
+ * back within it are resumed. Static sources resume where they would have
+ * been had they kept playing; streaming sources resume where they were
+ * paused. Playing, pausing, stopping or rewinding a culled source makes it
+ * no longer culled.
+ */
+static
+VALUE
+cull_srcs(VALUE rculler, VALUE rdt)
+{
+    check_seal_err(seal_cull_srcs(DATA_PTR(rculler), NUM2DBL(rdt)));
+
+    return rculler;
+}
+
+/*
+ *  call-seq:
+ *      culler.size -> fixnum
+ *
+ * Gets the number of sources in _culler_.
+ */
+static
+VALUE
+get_culler_size(VALUE rculler)
+{
+    size_t size;
+
+    check_seal_err(seal_get_culler_size(DATA_PTR(rculler), &size));
+
+    return SIZET2NUM(size);
+}
+
 /*
  *  call-seq:
  *      reverb.load(preset) -> reverb
@@ -1107,7 +2976,7 @@ load_rvb(VALUE rrvb, VALUE rpreset)
 {
     seal_rvb_t* rvb;
 
-    Data_Get_Struct(rrvb, seal_rvb_t, rvb);
+    TypedData_Get_Struct(rrvb, seal_rvb_t, &rvb_type, rvb);
     check_seal_err(seal_load_rvb(rvb, NUM2INT(rpreset)));
 
     return rrvb;
@@ -1692,6 +3561,262 @@ is_efs_auto(VALUE refs)
     return get_obj_char(refs, seal_is_efs_auto);
 }
 
+/*
+ *  call-seq:
+ *      Seal::ReverbZones.new(slot_count)  -> reverb_zones
+ *
+ * Initializes a new set of reverb zones with a pool of _slot_count_ effect
+ * slots, each loaded with a reverb of its own. The slots are muted until the
+ * listener gets in one of their zones.
+ *
+ * There is a limit on the number of allocated effect slots. This method raises
+ * an error if it is exceeding the limit.
+ */
+static
+VALUE
+init_zones(VALUE rzones, VALUE rnslots)
+{
+    check_seal_err(seal_init_zones(DATA_PTR(rzones), NUM2SIZET(rnslots)));
+
+    return rzones;
+}
+
+static
+float
+fetch_zone_float(VALUE rzone, const char* key, float default_val)
+{
+    VALUE rval = rb_hash_aref(rzone, name2sym(key));
+
+    return NIL_P(rval) ? default_val : NUM2DBL(rval);
+}
+
+static
+void
+extract_zone(VALUE rzone, seal_zone_t* zone)
+{
+    VALUE rslot;
+
+    rzone = rb_convert_type(rzone, T_HASH, "Hash", "to_hash");
+    extract_3float(rb_hash_fetch(rzone, name2sym("position")),
+                   zone->pos, zone->pos + 1, zone->pos + 2);
+    zone->radius = NUM2DBL(rb_hash_fetch(rzone, name2sym("radius")));
+    zone->fade = fetch_zone_float(rzone, "fade", 0);
+    rslot = rb_hash_aref(rzone, name2sym("slot"));
+    zone->slot = NIL_P(rslot) ? 0 : NUM2SIZET(rslot);
+    check_seal_err(seal_get_rvb_preset(
+        NUM2INT(rb_hash_fetch(rzone, name2sym("preset"))),
+        &zone->params
+    ));
+}
+
+/*
+ *  call-seq:
+ *      reverb_zones.zones = [zone, ...] -> [zone, ...]
+ *
+ * Replaces the zones of _reverb_zones_. Each zone is a hash with the
+ * following keys:
+ *
+ * [:position]  the center of the zone, as [x, y, z]
+ * [:radius]    the distance from the center within which the listener is
+ *              fully in the zone
+ * [:fade]      the distance beyond _radius_ over which the zone fades out;
+ *              defaults to 0
+ * [:slot]      the index of the effect slot the zone sets the reverb of;
+ *              defaults to 0
+ * [:preset]    the reverb preset of the zone, such as
+ *              <em>Reverb::Preset::STONEROOM</em>
+ *
+ * The effect slots change on the next ReverbZones#update.
+ */
+static
+VALUE
+set_zones(VALUE rzones, VALUE rzone_arr)
+{
+    seal_zone_t* zones;
+    long nzones, i;
+
+    rzone_arr = rb_convert_type(rzone_arr, T_ARRAY, "Array", "to_a");
+    nzones = RARRAY_LEN(rzone_arr);
+    zones = ALLOCA_N(seal_zone_t, nzones);
+    for (i = 0; i < nzones; ++i)
+        extract_zone(rb_ary_entry(rzone_arr, i), zones + i);
+    check_seal_err(seal_set_zones(DATA_PTR(rzones), zones, nzones));
+
+    return rzone_arr;
+}
+
+/*
+ *  call-seq:
+ *      reverb_zones.update    -> reverb_zones
+ *
+ * Updates the effect slots of _reverb_zones_ for the current listener
+ * position, usually once per frame. The reverb of each slot gets the
+ * parameters of its zones weighted by how much the listener is in each of
+ * them, and the slot gain becomes the sum of the weights up to 1.0, so a slot
+ * fades out as the listener leaves all its zones. Nothing is written for
+ * parameters that have not changed since the last update.
+ */
+static
+VALUE
+update_zones(VALUE rzones)
+{
+    check_seal_err(seal_update_zones(DATA_PTR(rzones)));
+
+    return rzones;
+}
+
+/*
+ *  call-seq:
+ *      reverb_zones.feed(source, slot, index) -> reverb_zones
+ *
+ * Feeds the effect slot of index _slot_ in _reverb_zones_ with the output of
+ * _source_, like Source#feed does with an EffectSlot. _index_ is the
+ * zero-based index for the effect on _source_.
+ */
+static
+VALUE
+feed_zones_efs(VALUE rzones, VALUE rsrc, VALUE rslot, VALUE rindex)
+{
+    seal_src_t* src;
+    seal_efs_t* slot;
+
+    TypedData_Get_Struct(rsrc, seal_src_t, &src_type, src);
+    slot = seal_get_zones_efs(DATA_PTR(rzones), NUM2SIZET(rslot));
+    if (slot == 0)
+        check_seal_err(SEAL_BAD_VAL);
+    check_seal_err(seal_feed_efs(src, slot, NUM2INT(rindex)));
+
+    return rzones;
+}
+
+/*
+ *  call-seq:
+ *      reverb_zones.size  -> fixnum
+ *
+ * Gets the number of zones in _reverb_zones_.
+ */
+static
+VALUE
+get_zones_size(VALUE rzones)
+{
+    size_t size;
+
+    check_seal_err(seal_get_zones_size(DATA_PTR(rzones), &size));
+
+    return SIZET2NUM(size);
+}
+
+/*
+ *  call-seq:
+ *      Seal::Writer.new(filename, frequency: f, channels: n)  -> writer
+ *      Seal::Writer.new(filename, frequency: f, channels: n, bit_depth: b)
+ *          -> writer
+ *
+ * Creates or truncates the WAVE file _filename_ and opens a writer on it.
+ * _bit_depth_ is 16 (the default) or 24 for integer samples, or 32 for
+ * float samples. The file is finished when the writer is closed or garbage
+ * collected.
+ */
+static
+VALUE
+init_writer(int argc, VALUE* argv, VALUE rwriter)
+{
+    VALUE filename;
+    VALUE options;
+    VALUE rbit_depth;
+    seal_raw_attr_t attr;
+
+    rb_scan_args(argc, argv, "1:", &filename, &options);
+    FilePathValue(filename);
+    if (NIL_P(options))
+        options = rb_hash_new();
+    attr.freq = NUM2INT(rb_hash_fetch(options, name2sym("frequency")));
+    attr.nchannels = NUM2INT(rb_hash_fetch(options, name2sym("channels")));
+    rbit_depth = rb_hash_aref(options, name2sym("bit_depth"));
+    attr.bit_depth = NIL_P(rbit_depth) ? 16 : NUM2INT(rbit_depth);
+    check_seal_err(seal_open_writer(DATA_PTR(rwriter), RSTRING_PTR(filename),
+                                    &attr));
+
+    return rwriter;
+}
+
+/*
+ *  call-seq:
+ *      writer.write(string)                -> writer
+ *      writer.write(string, bit_depth: b)  -> writer
+ *
+ * Writes the interleaved PCM data in _string_, such as returned by
+ * Seal.render or Stream#read, to _writer_, converting the samples to the bit
+ * depth of the file. _bit_depth_ is that of the data in _string_: 8 for
+ * unsigned samples, 16 for signed samples in native byte order, 24 for
+ * little-endian signed samples or 32 for float samples in native byte
+ * order; it defaults to the bit depth of the file. The data must have the
+ * channel count of _writer_.
+ */
+static
+VALUE
+write_writer(int argc, VALUE* argv, VALUE rwriter)
+{
+    VALUE rpcm;
+    VALUE options;
+    VALUE rbit_depth = Qnil;
+    seal_writer_t* writer = DATA_PTR(rwriter);
+    seal_raw_t raw;
+    nogvl_call_t call;
+
+    rb_scan_args(argc, argv, "1:", &rpcm, &options);
+    StringValue(rpcm);
+    if (!NIL_P(options))
+        rbit_depth = rb_hash_aref(options, name2sym("bit_depth"));
+    raw.attr = writer->attr;
+    if (!NIL_P(rbit_depth))
+        raw.attr.bit_depth = NUM2INT(rbit_depth);
+    raw.data = RSTRING_PTR(rpcm);
+    raw.size = RSTRING_LEN(rpcm);
+
+    call.obj = writer;
+    call.raw = &raw;
+    rb_str_locktmp(rpcm);
+    call_without_gvl(call_write_raw, &call);
+    rb_str_unlocktmp(rpcm);
+    check_seal_err(call.err);
+
+    return rwriter;
+}
+
+/*
+ *  call-seq:
+ *      writer.close    -> nil
+ *
+ * Writes what is left of the data written to _writer_, fills in the header
+ * and closes the file. Does nothing if _writer_ is already closed.
+ */
+static
+VALUE
+close_writer(VALUE rwriter)
+{
+    check_seal_err(op_without_gvl(DATA_PTR(rwriter), seal_close_writer));
+
+    return Qnil;
+}
+
+/*
+ *  call-seq:
+ *      writer.frame_count  -> fixnum
+ *
+ * Gets the number of frames written to _writer_, or 0 once closed.
+ */
+static
+VALUE
+get_writer_nframes(VALUE rwriter)
+{
+    size_t nframes;
+
+    check_seal_err(seal_get_writer_nframes(DATA_PTR(rwriter), &nframes));
+
+    return SIZET2NUM(nframes);
+}
+
 /*
  *  call-seq:
  *      Seal.listener  -> listener
@@ -1864,6 +3989,19 @@ get_listener_orien(VALUE rlistener)
     return rb_ary_new4(2, orien);
 }
 
+/*
+ * Marks the methods defined afterwards as callable from any Ractor if
+ * `safe' is true, or only from the main Ractor otherwise.
+ */
+static
+void
+set_ractor_safe(int safe)
+{
+#ifdef HAVE_RB_EXT_RACTOR_SAFE
+    rb_ext_ractor_safe(safe);
+#endif
+}
+
 static
 void
 singletonify(VALUE klass)
@@ -1894,12 +4032,47 @@ bind_core(void)
     mFormat = rb_define_module_under(mSeal, "Format");
 
     eSealError = rb_define_class_under(mSeal, "SealError", rb_eException);
+    /* Starting up and cleaning up are only allowed on the main Ractor. */
+    set_ractor_safe(0);
     rb_define_singleton_method(mSeal, "startup", startup, -1);
+    rb_define_singleton_method(mSeal, "startup_loopback", startup_loopback,
+                               -1);
+    rb_define_singleton_method(mSeal, "render", render, 1);
     rb_define_singleton_method(mSeal, "cleanup", cleanup, 0);
+    set_ractor_safe(1);
     rb_define_singleton_method(mSeal, "per_source_effect_limit",
                                per_source_effect_limit, 0);
+    rb_define_singleton_method(mSeal, "device_frequency", device_frequency, 0);
+    rb_define_singleton_method(mSeal, "resampling=", set_resampling, 1);
+    rb_define_singleton_method(mSeal, "resampling", is_resampling, 0);
+    rb_define_alias(rb_singleton_class(mSeal), "resampling?", "resampling");
+    rb_define_singleton_method(mSeal, "unchecked=", set_unchecked, 1);
+    rb_define_singleton_method(mSeal, "unchecked", is_unchecked, 0);
+    rb_define_alias(rb_singleton_class(mSeal), "unchecked?", "unchecked");
+    rb_define_singleton_method(mSeal, "check_deferred_errors",
+                               check_deferred_errs, 0);
+    rb_define_singleton_method(mSeal, "batch", batch, 0);
+    rb_define_singleton_method(mSeal, "distance_model=",
+                               set_distance_model, 1);
+    rb_define_singleton_method(mSeal, "distance_model",
+                               get_distance_model, 0);
+    rb_define_singleton_method(mSeal, "thread_local_context?",
+                               has_thread_local_context, 0);
+    rb_define_singleton_method(mSeal, "worker_count=", set_worker_count, 1);
+    rb_define_singleton_method(mSeal, "worker_count", get_worker_count, 0);
+    rb_define_singleton_method(mSeal, "worker_affinity=",
+                               set_worker_affinity, 1);
+    rb_define_singleton_method(mSeal, "worker_affinity",
+                               has_worker_affinity, 0);
+    rb_define_alias(rb_singleton_class(mSeal), "worker_affinity?",
+                    "worker_affinity");
+    rb_define_singleton_method(mSeal, "schedule_streaming",
+                               schedule_streaming, -1);
+    rb_define_singleton_method(mSeal, "streaming_schedule",
+                               get_streaming_schedule, 0);
     /* A string indicating the version of Seal. */
-    rb_define_const(mSeal, "VERSION", rb_str_new2(seal_get_version()));
+    rb_define_const(mSeal, "VERSION",
+                    rb_obj_freeze(rb_str_new2(seal_get_version())));
     /* WAVE format. */
     rb_define_const(mFormat, "WAV", name2sym(WAV_SYM));
     /* Ogg Vorbis format. */
@@ -1932,12 +4105,63 @@ bind_buf(void)
     rb_define_alloc_func(cBuffer, alloc_buf);
     rb_define_method(cBuffer, "initialize", init_buf, -1);
     rb_define_method(cBuffer, "load", load_buf, -1);
+    rb_define_singleton_method(cBuffer, "from_pcm", buf_from_pcm, -1);
     rb_define_method(cBuffer, "size", get_buf_size, 0);
     rb_define_method(cBuffer, "frequency", get_buf_freq, 0);
     rb_define_method(cBuffer, "bit_depth", get_buf_bps, 0);
     rb_define_method(cBuffer, "channel_count", get_buf_nchannels, 0);
 }
 
+/*
+ * Document-class:  Seal::CompressedBuffer
+ *
+ * Interfaces for manipulating compressed buffers. A compressed buffer keeps
+ * the encoded bytes of an audio file in memory and decodes them only when it
+ * is being played, which takes a lot less memory than a regular buffer at the
+ * cost of some CPU time during playback. A compressed buffer is played by
+ * assigning it to Source#compressed_buffer=, and any number of sources can
+ * play the same compressed buffer at the same time.
+ */
+static
+void
+bind_cbuf(void)
+{
+    VALUE cCompressedBuffer = rb_define_class_under(mSeal, "CompressedBuffer",
+                                                    rb_cObject);
+
+    rb_define_alloc_func(cCompressedBuffer, alloc_cbuf);
+    rb_define_method(cCompressedBuffer, "initialize", init_cbuf, -1);
+    rb_define_method(cCompressedBuffer, "load", load_cbuf, -1);
+    rb_define_method(cCompressedBuffer, "size", get_cbuf_size, 0);
+    rb_define_method(cCompressedBuffer, "frequency", get_cbuf_freq, 0);
+    rb_define_method(cCompressedBuffer, "bit_depth", get_cbuf_bps, 0);
+    rb_define_method(cCompressedBuffer, "channel_count",
+                     get_cbuf_nchannels, 0);
+}
+
+/*
+ * Document-class:  Seal::Manifest
+ *
+ * A cache of the results of Seal.probe that can be saved to disk, so that
+ * loaders can learn about thousands of audio files without opening them on
+ * every run. Entries are keyed by the path of the file as passed in, and are
+ * only used while the size and modification time of the file stay the same.
+ */
+static
+void
+bind_manifest(void)
+{
+    VALUE cManifest = rb_define_class_under(mSeal, "Manifest", rb_cObject);
+
+    rb_define_singleton_method(mSeal, "probe", probe, 1);
+    rb_define_alloc_func(cManifest, alloc_manifest);
+    rb_define_method(cManifest, "initialize", init_manifest, -1);
+    rb_define_method(cManifest, "load", load_manifest, 1);
+    rb_define_method(cManifest, "save", save_manifest, 1);
+    rb_define_method(cManifest, "probe", probe_cached, 1);
+    rb_define_method(cManifest, "size", get_manifest_size, 0);
+}
+
 /*
  * Document-class:  Seal::Stream
  *
@@ -1966,6 +4190,15 @@ bind_stream(void)
     rb_define_method(cStream, "frequency", get_stream_freq, 0);
     rb_define_method(cStream, "bit_depth", get_stream_bps, 0);
     rb_define_method(cStream, "channel_count", get_stream_nchannels, 0);
+    rb_define_singleton_method(cStream, "open_async", open_stream_async, -1);
+    rb_define_singleton_method(cStream, "fast_open=", set_fast_stream_open, 1);
+    rb_define_singleton_method(cStream, "fast_open", is_fast_stream_open, 0);
+    rb_define_alias(rb_singleton_class(cStream), "fast_open?", "fast_open");
+    rb_define_method(cStream, "opening?", is_stream_opening, 0);
+    rb_define_method(cStream, "wait", wait_stream, 0);
+    rb_define_method(cStream, "read_ahead=", set_stream_read_ahead, 1);
+    rb_define_method(cStream, "read_ahead", get_stream_read_ahead, 0);
+    rb_define_method(cStream, "read", read_stream, -1);
     rb_define_method(cStream, "rewind", rewind_stream, 0);
     rb_define_method(cStream, "close", close_stream, 0);
     rb_define_alias(rb_singleton_class(cStream), "open", "new");
@@ -2019,16 +4252,28 @@ bind_src(void)
     rb_define_method(cSource, "buffer", get_src_buf, 0);
     rb_define_method(cSource, "stream=", set_src_stream, 1);
     rb_define_method(cSource, "stream", get_src_stream, 0);
+    rb_define_method(cSource, "compressed_buffer=", set_src_cbuf, 1);
+    rb_define_method(cSource, "compressed_buffer", get_src_cbuf, 0);
     rb_define_method(cSource, "feed", feed_efs, 2);
     rb_define_method(cSource, "update", update_src, 0);
     rb_define_method(cSource, "position=", set_src_pos, 1);
     rb_define_method(cSource, "position", get_src_pos, 0);
     rb_define_method(cSource, "velocity=", set_src_vel, 1);
     rb_define_method(cSource, "velocity", get_src_vel, 0);
+    rb_define_singleton_method(cSource, "update_transforms",
+                               update_src_transforms, 2);
+    rb_define_singleton_method(cSource, "move_all", move_srcs, 2);
     rb_define_method(cSource, "pitch=", set_src_pitch, 1);
     rb_define_method(cSource, "pitch", get_src_pitch, 0);
     rb_define_method(cSource, "gain=", set_src_gain, 1);
     rb_define_method(cSource, "gain", get_src_gain, 0);
+    rb_define_method(cSource, "rolloff_factor=", set_src_rolloff_factor, 1);
+    rb_define_method(cSource, "rolloff_factor", get_src_rolloff_factor, 0);
+    rb_define_method(cSource, "reference_distance=", set_src_ref_dist, 1);
+    rb_define_method(cSource, "reference_distance", get_src_ref_dist, 0);
+    rb_define_method(cSource, "max_distance=", set_src_max_dist, 1);
+    rb_define_method(cSource, "max_distance", get_src_max_dist, 0);
+    rb_define_method(cSource, "culled?", is_src_culled, 0);
     rb_define_method(cSource, "auto=", set_src_auto, 1);
     rb_define_method(cSource, "auto", is_src_auto, 0);
     rb_define_alias(cSource, "auto?", "auto");
@@ -2062,6 +4307,29 @@ bind_src(void)
     rb_define_const(mType, "STREAMING", name2sym(STREAMING_SYM));
 }
 
+/*
+ * Document-class:  Seal::Culler
+ *
+ * A uniform grid over sources that, once per frame, pauses the playing
+ * sources beyond their Source#max_distance from the listener and resumes
+ * them when the listener comes back within range. Paused streaming sources
+ * stop being refilled, so sources out of range cost neither mixing nor
+ * decoding. Sources are removed from their culler when garbage collected.
+ */
+static
+void
+bind_culler(void)
+{
+    VALUE cCuller = rb_define_class_under(mSeal, "Culler", rb_cObject);
+
+    rb_define_alloc_func(cCuller, alloc_culler);
+    rb_define_method(cCuller, "initialize", init_culler, 1);
+    rb_define_method(cCuller, "add", add_culled_src, 1);
+    rb_define_method(cCuller, "remove", remove_culled_src, 1);
+    rb_define_method(cCuller, "cull", cull_srcs, 1);
+    rb_define_method(cCuller, "size", get_culler_size, 0);
+}
+
 /*
  * Document-class:  Seal::Reverb
  *
@@ -2366,6 +4634,102 @@ bind_efs(void)
     rb_define_alias(cEffectSlot, "auto?", "auto");
 }
 
+/*
+ * Document-class:  Seal::Context
+ *
+ * A context renders its own sources and listener on a device of its own,
+ * isolated from the other contexts. Seal.startup creates the context current
+ * for the process; more contexts can be opened and bound to single threads
+ * so that different threads drive different contexts in parallel, for
+ * example to render several independent sessions at once:
+ *
+ *   context = Seal::Context.new
+ *   Thread.new do
+ *     context.use do
+ *       source = Seal::Source.new
+ *       # ...
+ *     end
+ *   end
+ *
+ * Objects belong to the context current on the thread that creates them and
+ * must only be used there, except that buffers can be used by every context
+ * on the same device.
+ */
+static
+void
+bind_context(void)
+{
+    VALUE cContext = rb_define_class_under(mSeal, "Context", rb_cObject);
+
+    rb_define_alloc_func(cContext, alloc_context);
+    rb_define_method(cContext, "initialize", init_context, -1);
+    rb_define_method(cContext, "use", use_context, 0);
+    rb_define_singleton_method(cContext, "unbind", unbind_context, 0);
+}
+
+/*
+ * Document-class:  Seal::ReverbZones
+ *
+ * Reverb zones change the reverberation of a pool of effect slots as the
+ * listener moves between places. A zone is a sphere with the reverb preset
+ * of the place; the listener hears it fully inside and fading out over some
+ * distance beyond. Where zones overlap, their parameters are interpolated,
+ * so walking from one room into another changes the reverberation
+ * gradually instead of switching presets.
+ *
+ *   zones = Seal::ReverbZones.new(1)
+ *   zones.zones = [
+ *     { position: [0, 0, 0], radius: 10, fade: 5,
+ *       preset: Seal::Reverb::Preset::STONEROOM },
+ *     { position: [20, 0, 0], radius: 5, fade: 5,
+ *       preset: Seal::Reverb::Preset::HALLWAY }
+ *   ]
+ *   zones.feed(source, 0, 0)
+ *   zones.update # once per frame
+ */
+static
+void
+bind_zones(void)
+{
+    VALUE cReverbZones = rb_define_class_under(mSeal, "ReverbZones",
+                                               rb_cObject);
+
+    rb_define_alloc_func(cReverbZones, alloc_zones);
+    rb_define_method(cReverbZones, "initialize", init_zones, 1);
+    rb_define_method(cReverbZones, "zones=", set_zones, 1);
+    rb_define_method(cReverbZones, "update", update_zones, 0);
+    rb_define_method(cReverbZones, "feed", feed_zones_efs, 3);
+    rb_define_method(cReverbZones, "size", get_zones_size, 0);
+}
+
+/*
+ * Document-class:  Seal::Writer
+ *
+ * Writers write audio to WAVE files, for example to bounce a mix rendered
+ * offline or to dump decoded streams for analysis. Samples are converted
+ * to the bit depth of the file and buffered so that the file is written in
+ * big blocks.
+ *
+ *   Seal.startup_loopback(44100, 2, :float)
+ *   writer = Seal::Writer.new('mix.wav', frequency: 44100, channels: 2,
+ *                             bit_depth: 24)
+ *   # ...
+ *   writer.write(Seal.render(44100), bit_depth: 32)
+ *   writer.close
+ */
+static
+void
+bind_writer(void)
+{
+    VALUE cWriter = rb_define_class_under(mSeal, "Writer", rb_cObject);
+
+    rb_define_alloc_func(cWriter, alloc_writer);
+    rb_define_method(cWriter, "initialize", init_writer, -1);
+    rb_define_method(cWriter, "write", write_writer, -1);
+    rb_define_method(cWriter, "close", close_writer, 0);
+    rb_define_method(cWriter, "frame_count", get_writer_nframes, 0);
+}
+
 /*
  * Document-class:  Seal::Listener
  *
@@ -2382,10 +4746,10 @@ void
 bind_listener(void)
 {
     VALUE cListener = rb_define_class_under(mSeal, "Listener", rb_cObject);
-    VALUE listener = rb_data_object_alloc(cListener, 0, 0, 0);
+    VALUE listener = TypedData_Wrap_Struct(cListener, &listener_type, 0);
 
-    /* The singleton Listener instance. */
-    rb_define_const(mSeal, "LISTENER", listener);
+    /* The singleton Listener instance, which is shared by all Ractors. */
+    rb_define_const(mSeal, "LISTENER", rb_obj_freeze(listener));
     rb_define_singleton_method(mSeal, "listener", get_listener, 0);
     singletonify(cListener);
     rb_define_method(cListener, "move", move_listener, 0);
@@ -2408,11 +4772,18 @@ bind_listener(void)
 void
 Init_seal(void)
 {
+    set_ractor_safe(1);
     bind_core();
+    bind_context();
     bind_buf();
+    bind_cbuf();
+    bind_manifest();
     bind_stream();
     bind_src();
+    bind_culler();
     bind_rvb();
     bind_efs();
+    bind_zones();
+    bind_writer();
     bind_listener();
 }
@@ -0,0 +1,304 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <seal/raw.h>
+#include <seal/err.h>
+#include "adpcm.h"
+
+enum
+{
+    /* Sizes, in bytes, of the per-channel block headers. */
+    IMA_HEADER_SIZE   = 4,
+    MS_HEADER_SIZE    = 7,
+    /* IMA ADPCM data are interleaved in 4-byte words per channel. */
+    IMA_WORD_SIZE     = 4,
+    MIN_MS_DELTA      = 16
+};
+
+static const int16_t IMA_STEPS[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41,
+    45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190,
+    209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724,
+    796, 876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272,
+    2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132,
+    7845, 8630, 9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500,
+    20350, 22385, 24623, 27086, 29794, 32767
+};
+
+static const int8_t IMA_INDEX_ADJUSTMENTS[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+static const int16_t MS_ADAPTATIONS[16] = {
+    230, 230, 230, 230, 307, 409, 512, 614,
+    768, 614, 512, 409, 307, 230, 230, 230
+};
+
+static const int16_t MS_STD_COEFS[_SEAL_MAX_MSADPCM_NCOEFS][2] = {
+    { 256, 0 }, { 512, -256 }, { 0, 0 }, { 192, 64 },
+    { 240, 0 }, { 460, -208 }, { 392, -232 }
+};
+
+static
+int
+clamp16(int sample)
+{
+    if (sample > 32767)
+        return 32767;
+    if (sample < -32768)
+        return -32768;
+    return sample;
+}
+
+static
+int16_t
+read_int16le(const uint8_t* bytes)
+{
+    return (int16_t) (bytes[1] << 8 | bytes[0]);
+}
+
+/*
+ * Decodes one nibble of IMA ADPCM and advances the channel state.
+ */
+static
+int16_t
+decode_ima_nibble(int nibble, int* psample, int* pindex)
+{
+    int step = IMA_STEPS[*pindex];
+    int diff = step >> 3;
+
+    if (nibble & 4)
+        diff += step;
+    if (nibble & 2)
+        diff += step >> 1;
+    if (nibble & 1)
+        diff += step >> 2;
+    *psample = clamp16(nibble & 8 ? *psample - diff : *psample + diff);
+
+    *pindex += IMA_INDEX_ADJUSTMENTS[nibble];
+    if (*pindex < 0)
+        *pindex = 0;
+    else if (*pindex > 88)
+        *pindex = 88;
+
+    return *psample;
+}
+
+/*
+ * Decodes a (possibly partial) IMA ADPCM block and returns the number of
+ * frames decoded.
+ */
+static
+size_t
+decode_ima_block(int16_t* dst, const uint8_t* block, size_t size,
+                 int nchannels)
+{
+    int samples[2], indices[2];
+    size_t nframes, i;
+    int c, j;
+
+    nframes = _seal_get_adpcm_nframes(_SEAL_IMA_ADPCM, size, nchannels);
+    for (c = 0; c < nchannels; ++c) {
+        samples[c] = read_int16le(block);
+        indices[c] = block[2] > 88 ? 88 : block[2];
+        dst[c] = samples[c];
+        block += IMA_HEADER_SIZE;
+    }
+
+    /* Each channel takes a 4-byte word of 8 samples in turn. */
+    for (i = 1; i < nframes; i += 8) {
+        for (c = 0; c < nchannels; ++c) {
+            int16_t* out = dst + i * nchannels + c;
+
+            for (j = 0; j < IMA_WORD_SIZE; ++j) {
+                out[0] = decode_ima_nibble(block[j] & 0xf,
+                                           samples + c, indices + c);
+                out[nchannels] = decode_ima_nibble(block[j] >> 4,
+                                                   samples + c, indices + c);
+                out += nchannels << 1;
+            }
+            block += IMA_WORD_SIZE;
+        }
+    }
+
+    return nframes;
+}
+
+/*
+ * Decodes one nibble of Microsoft ADPCM and advances the channel state.
+ */
+static
+int16_t
+decode_ms_nibble(int nibble, const int16_t* coef, int* s1, int* s2,
+                 int* pdelta)
+{
+    int predictor = (*s1 * coef[0] + *s2 * coef[1]) >> 8;
+    int signed_nibble = nibble & 8 ? nibble - 16 : nibble;
+
+    predictor = clamp16(predictor + signed_nibble * *pdelta);
+    *s2 = *s1;
+    *s1 = predictor;
+    *pdelta = (MS_ADAPTATIONS[nibble] * *pdelta) >> 8;
+    if (*pdelta < MIN_MS_DELTA)
+        *pdelta = MIN_MS_DELTA;
+
+    return predictor;
+}
+
+/*
+ * Decodes a (possibly partial) Microsoft ADPCM block and returns the number
+ * of frames decoded.
+ */
+static
+size_t
+decode_ms_block(int16_t* dst, const uint8_t* block, size_t size,
+                const _seal_adpcm_t* adpcm, int nchannels)
+{
+    const int16_t* coefs[2];
+    int deltas[2], s1[2], s2[2];
+    size_t nframes, nsamples, i;
+    int c;
+
+    nframes = _seal_get_adpcm_nframes(_SEAL_MS_ADPCM, size, nchannels);
+    for (c = 0; c < nchannels; ++c) {
+        int coef_index = block[c];
+
+        if (coef_index >= adpcm->ncoefs)
+            coef_index = 0;
+        coefs[c] = adpcm->coefs[coef_index];
+        deltas[c] = read_int16le(block + nchannels + c * 2);
+        s1[c] = read_int16le(block + nchannels * 3 + c * 2);
+        s2[c] = read_int16le(block + nchannels * 5 + c * 2);
+        /* The older sample comes first. */
+        dst[c] = s2[c];
+        dst[nchannels + c] = s1[c];
+    }
+    block += MS_HEADER_SIZE * nchannels;
+
+    /* High nibble first; channels are interleaved nibble by nibble. */
+    nsamples = (nframes - 2) * nchannels;
+    dst += nchannels << 1;
+    for (i = 0; i < nsamples; ++i) {
+        int nibble = i & 1 ? block[i >> 1] & 0xf : block[i >> 1] >> 4;
+
+        c = i % nchannels;
+        dst[i] = decode_ms_nibble(nibble, coefs[c], s1 + c, s2 + c,
+                                  deltas + c);
+    }
+
+    return nframes;
+}
+
+void
+_seal_init_msadpcm_coefs(_seal_adpcm_t* adpcm)
+{
+    int i;
+
+    adpcm->ncoefs = _SEAL_MAX_MSADPCM_NCOEFS;
+    for (i = 0; i < _SEAL_MAX_MSADPCM_NCOEFS; ++i) {
+        adpcm->coefs[i][0] = MS_STD_COEFS[i][0];
+        adpcm->coefs[i][1] = MS_STD_COEFS[i][1];
+    }
+}
+
+int
+_seal_has_std_msadpcm_coefs(const _seal_adpcm_t* adpcm)
+{
+    int i;
+
+    if (adpcm->ncoefs != _SEAL_MAX_MSADPCM_NCOEFS)
+        return 0;
+    for (i = 0; i < _SEAL_MAX_MSADPCM_NCOEFS; ++i)
+        if (adpcm->coefs[i][0] != MS_STD_COEFS[i][0]
+            || adpcm->coefs[i][1] != MS_STD_COEFS[i][1])
+            return 0;
+
+    return 1;
+}
+
+size_t
+_seal_get_adpcm_nframes(_seal_adpcm_codec_t codec, size_t block_align,
+                        int nchannels)
+{
+    size_t header_size;
+
+    switch (codec) {
+    case _SEAL_IMA_ADPCM:
+        header_size = IMA_HEADER_SIZE * nchannels;
+        if (block_align < header_size)
+            return 0;
+        /* Only whole words of all channels can be decoded. */
+        block_align -= (block_align - header_size)
+                       % (IMA_WORD_SIZE * nchannels);
+        return (block_align - header_size) * 2 / nchannels + 1;
+    case _SEAL_MS_ADPCM:
+        header_size = MS_HEADER_SIZE * nchannels;
+        if (block_align < header_size)
+            return 0;
+        return (block_align - header_size) * 2 / nchannels + 2;
+    default:
+        return 0;
+    }
+}
+
+seal_err_t
+_seal_decode_adpcm_into(seal_raw_t* raw, const _seal_adpcm_t* adpcm,
+                        const void* data, size_t size)
+{
+    const uint8_t* block = data;
+    int nchannels = raw->attr.nchannels;
+    size_t nframes;
+    int16_t* dst;
+
+    if (nchannels < 1 || nchannels > 2)
+        return SEAL_BAD_WAV_NCHANNELS;
+    if (_seal_get_adpcm_nframes(adpcm->codec, adpcm->block_align,
+                                nchannels) == 0)
+        return SEAL_BAD_WAV_SUBTYPE;
+
+    dst = raw->data;
+    while (size > 0) {
+        size_t block_size = size < adpcm->block_align
+                            ? size : adpcm->block_align;
+
+        if (_seal_get_adpcm_nframes(adpcm->codec, block_size, nchannels) == 0)
+            break;
+        if (adpcm->codec == _SEAL_IMA_ADPCM)
+            nframes = decode_ima_block(dst, block, block_size, nchannels);
+        else
+            nframes = decode_ms_block(dst, block, block_size, adpcm,
+                                      nchannels);
+        dst += nframes * nchannels;
+        block += block_size;
+        size -= block_size;
+    }
+
+    raw->size = (char*) dst - (char*) raw->data;
+    raw->attr.bit_depth = 16;
+
+    return SEAL_OK;
+}
+
+seal_err_t
+_seal_decode_adpcm(seal_raw_t* raw, const _seal_adpcm_t* adpcm,
+                   const void* data, size_t size)
+{
+    int nchannels = raw->attr.nchannels;
+    size_t nblocks, nframes;
+    seal_err_t err;
+
+    if (nchannels < 1 || nchannels > 2)
+        return SEAL_BAD_WAV_NCHANNELS;
+    nframes = _seal_get_adpcm_nframes(adpcm->codec, adpcm->block_align,
+                                      nchannels);
+    if (nframes == 0)
+        return SEAL_BAD_WAV_SUBTYPE;
+
+    /* Leave room for a trailing partial block. */
+    nblocks = size / adpcm->block_align + 1;
+    err = seal_alloc_raw_data(raw, nblocks * nframes * sizeof (int16_t)
+                                   * nchannels);
+    if (err != SEAL_OK)
+        return err;
+
+    return _seal_decode_adpcm_into(raw, adpcm, data, size);
+}
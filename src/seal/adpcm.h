@@ -0,0 +1,93 @@
+/*
+ * Software decoders for the ADPCM codecs found in WAVE files, namely IMA
+ * ADPCM and Microsoft ADPCM. Both encode 4 bits per sample in fixed-size
+ * blocks that can be decoded independently of each other.
+ */
+
+#ifndef _SEAL_ADPCM_H_
+#define _SEAL_ADPCM_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <seal/raw.h>
+#include <seal/err.h>
+
+enum
+{
+    /* Maximum number of Microsoft ADPCM predictor coefficient pairs. */
+    _SEAL_MAX_MSADPCM_NCOEFS = 7
+};
+
+enum _seal_adpcm_codec_t
+{
+    _SEAL_NO_ADPCM,
+    _SEAL_IMA_ADPCM,
+    _SEAL_MS_ADPCM
+};
+
+typedef enum _seal_adpcm_codec_t _seal_adpcm_codec_t;
+typedef struct _seal_adpcm_t _seal_adpcm_t;
+
+struct _seal_adpcm_t
+{
+    _seal_adpcm_codec_t codec;
+    /* Size, in bytes, of a block of all channels. */
+    uint16_t            block_align;
+    /* Number of sample frames a full block decodes to. */
+    uint16_t            nframes_per_block;
+    /* Microsoft ADPCM predictor coefficient pairs. */
+    uint16_t            ncoefs;
+    int16_t             coefs[_SEAL_MAX_MSADPCM_NCOEFS][2];
+};
+
+/*
+ * Sets up the standard Microsoft ADPCM coefficient table.
+ *
+ * @param adpcm     the ADPCM parameters to set the coefficients of
+ */
+void _seal_init_msadpcm_coefs(_seal_adpcm_t*);
+
+/*
+ * @param adpcm     the ADPCM parameters
+ * @return          non-zero if `adpcm' uses the standard coefficient table
+ */
+int _seal_has_std_msadpcm_coefs(const _seal_adpcm_t*);
+
+/*
+ * Gets the number of sample frames a full block decodes to given its size.
+ *
+ * @param codec         the ADPCM codec
+ * @param block_align   the size, in bytes, of a block of all channels
+ * @param nchannels     the number of channels
+ * @return              the number of sample frames or 0 if `block_align' is
+ *                      too small to hold the block headers
+ */
+size_t _seal_get_adpcm_nframes(_seal_adpcm_codec_t, size_t /*block_align*/,
+                               int /*nchannels*/);
+
+/*
+ * Decodes ADPCM blocks to 16-bit PCM. A trailing partial block is decoded as
+ * far as it goes.
+ *
+ * @param raw       the receiver of the decoded PCM data; `raw->data' will be
+ *                  dynamically allocated so the caller is responsible for
+ *                  deallocating it; `raw->attr' should be set to the attribute
+ *                  of the encoded audio prior to this call and will be
+ *                  adjusted to that of the decoded PCM data
+ * @param adpcm     the ADPCM parameters
+ * @param data      the encoded blocks
+ * @param size      the size, in bytes, of the encoded blocks
+ */
+seal_err_t _seal_decode_adpcm(seal_raw_t*, const _seal_adpcm_t*,
+                              const void* /*data*/, size_t /*size*/);
+
+/*
+ * Same as `_seal_decode_adpcm' except that the PCM data are decoded to
+ * `raw->data' supplied by the caller, which must have room for as many whole
+ * blocks as `data' starts, including the trailing partial one. `raw->size'
+ * receives the size of the decoded data.
+ */
+seal_err_t _seal_decode_adpcm_into(seal_raw_t*, const _seal_adpcm_t*,
+                                   const void* /*data*/, size_t /*size*/);
+
+#endif /* _SEAL_ADPCM_H_ */
@@ -0,0 +1,233 @@
+#include <stdlib.h>
+#include <string.h>
+#include <al/al.h>
+#include <seal/core.h>
+#include <seal/err.h>
+#include "batch.h"
+#include "threading.h"
+
+typedef void setter3f_t(unsigned int, int, float, float, float);
+typedef void listener_setterf_t(int, float);
+typedef void listener_setter3f_t(int, float, float, float);
+typedef void listener_setterfv_t(int, const float*);
+
+typedef struct write_t write_t;
+
+struct write_t
+{
+    void*                   set;
+    unsigned int            id;
+    int                     key;
+    _seal_deferred_kind_t   kind;
+    float                   vals[6];
+};
+
+static const size_t INITIAL_NWRITES = 64;
+
+/*
+ * Each thread has a batch of its own so that threads driving different
+ * contexts do not share one.
+ */
+
+/* Number of nested open batches. */
+static _SEAL_THREAD_LOCAL int depth = 0;
+/* The first error of the writes made so far in the batch. */
+static _SEAL_THREAD_LOCAL seal_err_t batch_err = SEAL_OK;
+/* Writes in the order they are first recorded. */
+static _SEAL_THREAD_LOCAL write_t* writes = 0;
+static _SEAL_THREAD_LOCAL size_t nwrites = 0;
+static _SEAL_THREAD_LOCAL size_t capacity = 0;
+/*
+ * Open-addressing hash table of 1-based indices into `writes', twice as
+ * large as `capacity'; 0 marks an empty slot.
+ */
+static _SEAL_THREAD_LOCAL size_t* slots = 0;
+
+static
+size_t
+hash(void* set, unsigned int id, int key)
+{
+    return ((size_t) set >> 4) ^ (id * 2654435761u) ^ ((size_t) key * 40503);
+}
+
+static
+size_t
+count_vals(_seal_deferred_kind_t kind)
+{
+    switch (kind) {
+    case _SEAL_DEFERRED_3F:
+    case _SEAL_DEFERRED_LISTENER_3F:
+        return 3;
+    case _SEAL_DEFERRED_LISTENER_FV:
+        return 6;
+    default:
+        return 1;
+    }
+}
+
+static
+void
+make(const write_t* write)
+{
+    const float* vals = write->vals;
+
+    switch (write->kind) {
+    case _SEAL_DEFERRED_F:
+        ((_seal_openal_setterf*) write->set)(write->id, write->key, vals[0]);
+        break;
+    case _SEAL_DEFERRED_3F:
+        ((setter3f_t*) write->set)(write->id, write->key,
+                                   vals[0], vals[1], vals[2]);
+        break;
+    case _SEAL_DEFERRED_LISTENER_F:
+        ((listener_setterf_t*) write->set)(write->key, vals[0]);
+        break;
+    case _SEAL_DEFERRED_LISTENER_3F:
+        ((listener_setter3f_t*) write->set)(write->key,
+                                            vals[0], vals[1], vals[2]);
+        break;
+    case _SEAL_DEFERRED_LISTENER_FV:
+        ((listener_setterfv_t*) write->set)(write->key, vals);
+        break;
+    }
+}
+
+/* Doubles the capacity and rebuilds the hash table. */
+static
+int
+grow(void)
+{
+    size_t new_capacity = capacity == 0 ? INITIAL_NWRITES : capacity * 2;
+    size_t nslots = new_capacity * 2;
+    write_t* new_writes;
+    size_t* new_slots;
+    size_t i;
+
+    new_writes = realloc(writes, new_capacity * sizeof (write_t));
+    if (new_writes == 0)
+        return 0;
+    writes = new_writes;
+    new_slots = calloc(nslots, sizeof (size_t));
+    if (new_slots == 0)
+        return 0;
+    free(slots);
+    slots = new_slots;
+    capacity = new_capacity;
+
+    for (i = 0; i < nwrites; ++i) {
+        size_t slot = hash(writes[i].set, writes[i].id, writes[i].key);
+
+        while (slots[slot &= nslots - 1] != 0)
+            ++slot;
+        slots[slot] = i + 1;
+    }
+
+    return 1;
+}
+
+int
+_seal_is_batching(void)
+{
+    return depth > 0;
+}
+
+int
+_seal_defer_write(void* set, unsigned int id, int key,
+                  _seal_deferred_kind_t kind, const float* vals)
+{
+    size_t slot, nslots;
+    write_t* write;
+
+    if (depth == 0)
+        return 0;
+    if (nwrites == capacity && !grow()) {
+        /* Nothing recorded yet, so the write cannot be overwritten later. */
+        if (capacity == 0)
+            return 0;
+        /*
+         * Makes room by making the recorded writes, which also keeps an
+         * older value of the same key from being made after this one.
+         */
+        _seal_flush_batch();
+    }
+
+    nslots = capacity * 2;
+    for (slot = hash(set, id, key); ; ++slot) {
+        slot &= nslots - 1;
+        if (slots[slot] == 0) {
+            slots[slot] = ++nwrites;
+            write = writes + nwrites - 1;
+            write->set = set;
+            write->id = id;
+            write->key = key;
+            write->kind = kind;
+            break;
+        }
+        write = writes + slots[slot] - 1;
+        if (write->set == set && write->id == id && write->key == key)
+            break;
+    }
+    memcpy(write->vals, vals, count_vals(kind) * sizeof (float));
+
+    return 1;
+}
+
+void
+_seal_flush_batch(void)
+{
+    size_t i;
+    seal_err_t err;
+
+    if (nwrites == 0)
+        return;
+
+    for (i = 0; i < nwrites; ++i)
+        make(writes + i);
+    nwrites = 0;
+    memset(slots, 0, capacity * 2 * sizeof (size_t));
+
+    err = _seal_get_openal_prop_err();
+    if (batch_err == SEAL_OK)
+        batch_err = err;
+}
+
+void
+_seal_reset_batch(void)
+{
+    free(writes);
+    free(slots);
+    writes = 0;
+    slots = 0;
+    nwrites = capacity = 0;
+    depth = 0;
+    batch_err = SEAL_OK;
+}
+
+seal_err_t
+SEAL_API
+seal_begin_batch(void)
+{
+    if (depth++ == 0)
+        alDeferUpdatesSOFT();
+
+    return SEAL_OK;
+}
+
+seal_err_t
+SEAL_API
+seal_commit_batch(void)
+{
+    seal_err_t err;
+
+    if (depth == 0)
+        return SEAL_BAD_OP;
+    if (--depth > 0)
+        return SEAL_OK;
+
+    _seal_flush_batch();
+    alProcessUpdatesSOFT();
+    err = batch_err;
+    batch_err = SEAL_OK;
+
+    return err;
+}
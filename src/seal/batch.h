@@ -0,0 +1,54 @@
+/*
+ * Shadow state of property writes made between `seal_begin_batch' and
+ * `seal_commit_batch'. Writes to the same property of the same object are
+ * collapsed so that only the last one reaches OpenAL, on commit.
+ */
+
+#ifndef _SEAL_BATCH_H_
+#define _SEAL_BATCH_H_
+
+#include <seal/err.h>
+
+/* Signatures of the OpenAL setters whose calls can be deferred. */
+typedef enum
+{
+    _SEAL_DEFERRED_F,           /* alSourcef, alEffectf, ... */
+    _SEAL_DEFERRED_3F,          /* alSource3f */
+    _SEAL_DEFERRED_LISTENER_F,  /* alListenerf */
+    _SEAL_DEFERRED_LISTENER_3F, /* alListener3f */
+    _SEAL_DEFERRED_LISTENER_FV  /* alListenerfv with 6 floats */
+} _seal_deferred_kind_t;
+
+/*
+ * @return  1 if a batch is open or otherwise 0
+ */
+int _seal_is_batching(void);
+
+/*
+ * Records a property write in the open batch, replacing any earlier write to
+ * the same property of the same object.
+ *
+ * @param set   the OpenAL setter to call on commit
+ * @param id    the OpenAL object id; ignored by listener setters
+ * @param key   the property
+ * @param kind  the signature of `set'
+ * @param vals  the values to write; 1, 3 or 6 floats according to `kind'
+ * @return      1 if the write is deferred, or 0 if no batch is open or the
+ *              write cannot be recorded, in which case the caller should
+ *              make the write right away
+ */
+int _seal_defer_write(void* /*set*/, unsigned int /*id*/, int /*key*/,
+                      _seal_deferred_kind_t, const float* /*vals*/);
+
+/*
+ * Makes the writes recorded so far before OpenAL calls that may observe
+ * them, such as float getters, attaching effects to slots and deletions. The
+ * mixer still does not see them until the batch is committed. Errors are
+ * reported on commit. Does nothing if there is nothing recorded.
+ */
+void _seal_flush_batch(void);
+
+/* Discards the batch state of the calling thread; used on cleanup. */
+void _seal_reset_batch(void);
+
+#endif /* _SEAL_BATCH_H_ */
@@ -1,13 +1,158 @@
 #include <stdlib.h>
+#include <string.h>
 #include <al/al.h>
 #include <seal/buf.h>
 #include <seal/core.h>
 #include <seal/raw.h>
 #include <seal/fmt.h>
+#include <seal/io.h>
 #include <seal/err.h>
 #include "ov.h"
 #include "mpg.h"
 #include "wav.h"
+#include "adpcm.h"
+
+/* From `AL_EXT_IMA4', `AL_SOFT_MSADPCM' and `AL_SOFT_block_alignment'. */
+#ifndef AL_FORMAT_MONO_IMA4
+# define AL_FORMAT_MONO_IMA4                0x1300
+# define AL_FORMAT_STEREO_IMA4              0x1301
+#endif
+#ifndef AL_FORMAT_MONO_MSADPCM_SOFT
+# define AL_FORMAT_MONO_MSADPCM_SOFT        0x1302
+# define AL_FORMAT_STEREO_MSADPCM_SOFT      0x1303
+#endif
+#ifndef AL_UNPACK_BLOCK_ALIGNMENT_SOFT
+# define AL_UNPACK_BLOCK_ALIGNMENT_SOFT     0x200C
+#endif
+
+enum
+{
+    /* Block alignments, in sample frames, assumed without
+     * `AL_SOFT_block_alignment'. */
+    DEFAULT_IMA4_NFRAMES    = 65,
+    DEFAULT_MSADPCM_NFRAMES = 64
+};
+
+/*
+ * Gets the OpenAL buffer format that takes the ADPCM blocks as they are, or
+ * 0 if the OpenAL implementation cannot take them.
+ */
+static
+int
+get_adpcm_buf_fmt(_seal_adpcm_t* adpcm, seal_raw_t* raw)
+{
+    int default_nframes;
+    int mono = raw->attr.nchannels == 1;
+
+    /* Implementations only take whole blocks. */
+    if (raw->size % adpcm->block_align != 0)
+        return 0;
+    /* Needs to be decoded to be resampled. */
+    if (_seal_get_resampling_freq(&raw->attr) != 0)
+        return 0;
+
+    switch (adpcm->codec) {
+    case _SEAL_IMA_ADPCM:
+        if (!alIsExtensionPresent("AL_EXT_IMA4"))
+            return 0;
+        default_nframes = DEFAULT_IMA4_NFRAMES;
+        break;
+    case _SEAL_MS_ADPCM:
+        if (!alIsExtensionPresent("AL_SOFT_MSADPCM")
+            || !_seal_has_std_msadpcm_coefs(adpcm))
+            return 0;
+        default_nframes = DEFAULT_MSADPCM_NFRAMES;
+        break;
+    default:
+        return 0;
+    }
+    if (adpcm->nframes_per_block != default_nframes
+        && !alIsExtensionPresent("AL_SOFT_block_alignment"))
+        return 0;
+
+    if (adpcm->codec == _SEAL_IMA_ADPCM)
+        return mono ? AL_FORMAT_MONO_IMA4 : AL_FORMAT_STEREO_IMA4;
+    else
+        return mono ? AL_FORMAT_MONO_MSADPCM_SOFT
+                    : AL_FORMAT_STEREO_MSADPCM_SOFT;
+}
+
+/*
+ * Uploads ADPCM blocks directly if the OpenAL implementation supports them
+ * and decodes them in software otherwise. Stereo blocks are always decoded if
+ * they are to be downmixed.
+ */
+static
+seal_err_t
+adpcm2buf(seal_buf_t* buf, _seal_adpcm_t* adpcm, seal_raw_t* raw, int mono)
+{
+    seal_raw_t pcm;
+    int fmt = mono && raw->attr.nchannels == 2
+              ? 0 : get_adpcm_buf_fmt(adpcm, raw);
+    seal_err_t err;
+
+    if (fmt != 0) {
+        _seal_drain_openal_err();
+        alGetError();
+        alBufferi(buf->id, AL_UNPACK_BLOCK_ALIGNMENT_SOFT,
+                  adpcm->nframes_per_block);
+        /* Without `AL_SOFT_block_alignment' the default is already right. */
+        alGetError();
+        alBufferData(buf->id, fmt, raw->data, raw->size, raw->attr.freq);
+        err = _seal_get_openal_err();
+        /* Restore the default for PCM data loaded later on. */
+        alBufferi(buf->id, AL_UNPACK_BLOCK_ALIGNMENT_SOFT, 0);
+        alGetError();
+
+        return err;
+    }
+
+    pcm.attr = raw->attr;
+    err = _seal_decode_adpcm(&pcm, adpcm, raw->data, raw->size);
+    if (err != SEAL_OK)
+        return err;
+    if (!mono || (err = seal_downmix_raw(&pcm)) == SEAL_OK)
+        err = seal_raw2buf(buf, &pcm);
+    free(pcm.data);
+
+    return err;
+}
+
+static
+seal_err_t
+load2buf(seal_buf_t* buf, const char* filename, seal_fmt_t fmt, int mono)
+{
+    seal_raw_t raw;
+    _seal_adpcm_t adpcm;
+    seal_io_t io;
+    seal_err_t err;
+
+    if ((err = seal_ensure_fmt_known(filename, &fmt)) != SEAL_OK)
+        return err;
+
+    /* `raw.data' will be dynamically allocated by the callees. */
+    if (fmt == SEAL_WAV_FMT) {
+        if ((err = _seal_open_file_io(&io, filename)) != SEAL_OK)
+            return err;
+        /* Keep ADPCM encoded in case OpenAL can take it as it is. */
+        err = _seal_load_wav_encoded(&raw, &adpcm, &io);
+        if (err != SEAL_OK)
+            return err;
+        if (adpcm.codec != _SEAL_NO_ADPCM) {
+            err = adpcm2buf(buf, &adpcm, &raw, mono);
+            free(raw.data);
+            return err;
+        }
+    } else if ((err = seal_load(&raw, filename, fmt)) != SEAL_OK) {
+        return err;
+    }
+
+    if (!mono || (err = seal_downmix_raw(&raw)) == SEAL_OK)
+        err = seal_raw2buf(buf, &raw);
+    free(raw.data);
+
+    return err;
+}
 
 seal_err_t
 SEAL_API
@@ -27,29 +172,43 @@ seal_err_t
 SEAL_API
 seal_load2buf(seal_buf_t* buf, const char* filename, seal_fmt_t fmt)
 {
-    seal_raw_t raw;
-    seal_err_t err;
-
-    /* `raw.data' will be dynamically allocated by the callee. */
-    if ((err = seal_load(&raw, filename, fmt)) != SEAL_OK)
-        return err;
-
-    err = seal_raw2buf(buf, &raw);
-    free(raw.data);
+    return load2buf(buf, filename, fmt, 0);
+}
 
-    return err;
+seal_err_t
+SEAL_API
+seal_load_mono2buf(seal_buf_t* buf, const char* filename, seal_fmt_t fmt)
+{
+    return load2buf(buf, filename, fmt, 1);
 }
 
 seal_err_t
 SEAL_API
 seal_raw2buf(seal_buf_t* buf, seal_raw_t* raw)
 {
-    return _seal_raw2buf(buf->id, raw);
+    seal_raw_t resampled;
+    seal_err_t err;
+    int freq = _seal_get_resampling_freq(&raw->attr);
+
+    if (freq == 0)
+        return _seal_raw2buf(buf->id, raw);
+
+    /* Leave the caller's data alone. */
+    resampled.attr = raw->attr;
+    if ((err = seal_alloc_raw_data(&resampled, raw->size)) != SEAL_OK)
+        return err;
+    memcpy(resampled.data, raw->data, raw->size);
+    if ((err = seal_resample_raw(&resampled, freq)) == SEAL_OK)
+        err = _seal_raw2buf(buf->id, &resampled);
+    free(resampled.data);
+
+    return err;
 }
 
 seal_err_t
 _seal_raw2buf(unsigned int buf, seal_raw_t* raw)
 {
+    _seal_drain_openal_err();
     alBufferData(
         buf,
         _seal_get_buf_fmt(raw->attr.nchannels, raw->attr.bit_depth),
@@ -93,19 +252,38 @@ seal_err_t
 SEAL_API
 seal_load(seal_raw_t* raw, const char* filename, seal_fmt_t fmt)
 {
+    seal_io_t io;
     seal_err_t err;
 
     if ((err = seal_ensure_fmt_known(filename, &fmt)) != SEAL_OK)
         return err;
+    if ((err = _seal_open_file_io(&io, filename)) != SEAL_OK)
+        return err;
+
+    return seal_load_io(raw, &io, fmt);
+}
+
+seal_err_t
+SEAL_API
+seal_load_io(seal_raw_t* raw, seal_io_t* io, seal_fmt_t fmt)
+{
+    seal_err_t err;
+
+    if (fmt == SEAL_UNKNOWN_FMT
+        && (err = seal_recognize_io_fmt(io, &fmt)) != SEAL_OK) {
+        io->close(io->handle);
+        return err;
+    }
 
     switch (fmt) {
     case SEAL_WAV_FMT:
-        return _seal_load_wav(raw, filename);
+        return _seal_load_wav(raw, io);
     case SEAL_OV_FMT:
-        return _seal_load_ov(raw, filename);
+        return _seal_load_ov(raw, io);
     case SEAL_MPG_FMT:
-        return _seal_load_mpg(raw, filename);
+        return _seal_load_mpg(raw, io);
     default:
+        io->close(io->handle);
         return SEAL_BAD_AUDIO;
     }
 }
@@ -0,0 +1,176 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <seal/cbuf.h>
+#include <seal/stream.h>
+#include <seal/raw.h>
+#include <seal/fmt.h>
+#include <seal/err.h>
+#include <seal/io.h>
+
+/*
+ * Reads the whole content of a file to memory.
+ */
+static
+seal_err_t
+read_file(const char* filename, void** pdata, size_t* psize)
+{
+    seal_io_t io;
+    long size;
+    void* data;
+    seal_err_t err;
+
+    if ((err = _seal_open_file_io(&io, filename)) != SEAL_OK)
+        return err;
+
+    if (io.seek(io.handle, 0, SEEK_END) != 0
+        || (size = io.tell(io.handle)) <= 0
+        || io.seek(io.handle, 0, SEEK_SET) != 0) {
+        err = SEAL_BAD_AUDIO;
+        goto cleanup;
+    }
+
+    data = malloc(size);
+    if (data == 0) {
+        err = SEAL_CANNOT_ALLOC_MEM;
+        goto cleanup;
+    }
+    if (io.read(io.handle, data, size) != (size_t) size) {
+        free(data);
+        err = SEAL_CANNOT_OPEN_FILE;
+        goto cleanup;
+    }
+
+    *pdata = data;
+    *psize = size;
+
+cleanup:
+    io.close(io.handle);
+
+    return err;
+}
+
+/*
+ * Opens a stream on a block of encoded memory of the specified format.
+ */
+static
+seal_err_t
+open_mem_stream(seal_stream_t* stream, const void* data, size_t size,
+                seal_fmt_t fmt)
+{
+    seal_io_t io;
+    seal_err_t err;
+
+    if ((err = _seal_open_mem_io(&io, data, size)) != SEAL_OK)
+        return err;
+
+    return seal_open_stream_io(stream, &io, fmt);
+}
+
+seal_err_t
+SEAL_API
+seal_init_cbuf(seal_cbuf_t* cbuf)
+{
+    cbuf->data = 0;
+    cbuf->size = 0;
+    cbuf->fmt = SEAL_UNKNOWN_FMT;
+    cbuf->attr.freq = 0;
+    cbuf->attr.bit_depth = 16;
+    cbuf->attr.nchannels = 1;
+
+    return SEAL_OK;
+}
+
+seal_err_t
+SEAL_API
+seal_destroy_cbuf(seal_cbuf_t* cbuf)
+{
+    free(cbuf->data);
+
+    return seal_init_cbuf(cbuf);
+}
+
+seal_err_t
+SEAL_API
+seal_load2cbuf(seal_cbuf_t* cbuf, const char* filename, seal_fmt_t fmt)
+{
+    seal_stream_t stream;
+    seal_raw_attr_t attr;
+    void* data;
+    size_t size;
+    seal_err_t err;
+
+    if ((err = seal_ensure_fmt_known(filename, &fmt)) != SEAL_OK)
+        return err;
+    if (fmt != SEAL_OV_FMT && fmt != SEAL_MPG_FMT)
+        return SEAL_BAD_AUDIO;
+
+    if ((err = read_file(filename, &data, &size)) != SEAL_OK)
+        return err;
+
+    /* Make sure the content is decodable and retrieve its attributes. */
+    if ((err = open_mem_stream(&stream, data, size, fmt)) != SEAL_OK)
+        goto cleanup;
+    attr = stream.attr;
+    if ((err = seal_close_stream(&stream)) != SEAL_OK)
+        goto cleanup;
+
+    free(cbuf->data);
+    cbuf->data = data;
+    cbuf->size = size;
+    cbuf->fmt = fmt;
+    cbuf->attr = attr;
+
+    return SEAL_OK;
+
+cleanup:
+    free(data);
+
+    return err;
+}
+
+seal_err_t
+SEAL_API
+seal_open_cbuf_stream(seal_stream_t* stream, seal_cbuf_t* cbuf)
+{
+    if (cbuf->data == 0)
+        return SEAL_BAD_AUDIO;
+
+    return open_mem_stream(stream, cbuf->data, cbuf->size, cbuf->fmt);
+}
+
+seal_err_t
+SEAL_API
+seal_get_cbuf_size(seal_cbuf_t* cbuf, int* psize)
+{
+    *psize = cbuf->size;
+
+    return SEAL_OK;
+}
+
+seal_err_t
+SEAL_API
+seal_get_cbuf_freq(seal_cbuf_t* cbuf, int* pfreq)
+{
+    *pfreq = cbuf->attr.freq;
+
+    return SEAL_OK;
+}
+
+seal_err_t
+SEAL_API
+seal_get_cbuf_bps(seal_cbuf_t* cbuf, int* pbps)
+{
+    *pbps = cbuf->attr.bit_depth;
+
+    return SEAL_OK;
+}
+
+seal_err_t
+SEAL_API
+seal_get_cbuf_nchannels(seal_cbuf_t* cbuf, int* pnchannels)
+{
+    *pnchannels = cbuf->attr.nchannels;
+
+    return SEAL_OK;
+}
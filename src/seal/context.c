@@ -0,0 +1,344 @@
+#include <stddef.h>
+#include <string.h>
+#include <al/al.h>
+#include <al/alc.h>
+#include <al/efx.h>
+#include <seal/context.h>
+#include <seal/core.h>
+#include <seal/err.h>
+#include "threading.h"
+#include "batch.h"
+
+typedef ALCboolean ALC_APIENTRY set_thread_context_t(ALCcontext*);
+typedef ALCdevice* ALC_APIENTRY loopback_open_device_t(const ALCchar*);
+typedef ALCboolean ALC_APIENTRY is_render_format_supported_t(
+    ALCdevice*,
+    ALCsizei,
+    ALCenum,
+    ALCenum
+);
+typedef void ALC_APIENTRY render_samples_t(ALCdevice*, ALCvoid*, ALCsizei);
+
+/* `ALC_SOFT_loopback' enums, absent from the bundled headers. */
+enum
+{
+    ALC_UNSIGNED_BYTE_SOFT      = 0x1401,
+    ALC_SHORT_SOFT              = 0x1402,
+    ALC_FLOAT_SOFT              = 0x1406,
+    ALC_MONO_SOFT               = 0x1500,
+    ALC_STEREO_SOFT             = 0x1501,
+    ALC_QUAD_SOFT               = 0x1503,
+    ALC_5POINT1_SOFT            = 0x1504,
+    ALC_6POINT1_SOFT            = 0x1505,
+    ALC_7POINT1_SOFT            = 0x1506,
+    ALC_FORMAT_CHANNELS_SOFT    = 0x1990,
+    ALC_FORMAT_TYPE_SOFT        = 0x1991
+};
+
+/* Indexed by `seal_sample_type_t'. */
+static const ALCenum SAMPLE_TYPES[] = {
+    ALC_UNSIGNED_BYTE_SOFT,
+    ALC_SHORT_SOFT,
+    ALC_FLOAT_SOFT
+};
+static const size_t SAMPLE_SIZES[] = { 1, 2, 4 };
+#define NSAMPLE_TYPES (sizeof SAMPLE_TYPES / sizeof SAMPLE_TYPES[0])
+
+/* Indexed by the number of channels; 0 where there is no such layout. */
+static const ALCenum CHANNEL_LAYOUTS[] = {
+    0,
+    ALC_MONO_SOFT,
+    ALC_STEREO_SOFT,
+    0,
+    ALC_QUAD_SOFT,
+    0,
+    ALC_5POINT1_SOFT,
+    ALC_6POINT1_SOFT,
+    ALC_7POINT1_SOFT
+};
+#define NCHANNEL_LAYOUTS (sizeof CHANNEL_LAYOUTS / sizeof CHANNEL_LAYOUTS[0])
+
+static seal_context_t default_context = {
+    0, 0, -1, 0, 1, { 0, 0, 0 }, { 0, 0, 0 }
+};
+/* The context current for the process. */
+static seal_context_t* process_context = &default_context;
+/* The context bound to each thread, if any. */
+static _SEAL_THREAD_LOCAL seal_context_t* thread_context = 0;
+/* `alcSetThreadContext' or 0 if `ALC_EXT_thread_local_context' is absent. */
+static set_thread_context_t* set_thread_context = 0;
+/*
+ * `alcRenderSamplesSOFT' and the size of a sample frame if the default
+ * context is on a loopback device, or otherwise 0.
+ */
+static render_samples_t* render_samples = 0;
+static size_t loopback_frame_size = 0;
+
+static
+void
+reset(seal_context_t* context)
+{
+    context->device = 0;
+    context->context = 0;
+    context->per_src_effect_limit = -1;
+    context->device_freq = 0;
+    context->listener_gain = 1;
+    memset(context->listener_pos, 0, sizeof context->listener_pos);
+    memset(context->listener_vel, 0, sizeof context->listener_vel);
+}
+
+static
+void
+destroy(seal_context_t* context)
+{
+    alcDestroyContext(context->context);
+    alcCloseDevice(context->device);
+    reset(context);
+}
+
+/*
+ * Creates a context on a device that has just been opened, taking the device
+ * over: it is closed if anything fails.
+ */
+static
+seal_err_t
+create(seal_context_t* context, ALCdevice* device, const ALCint* attr)
+{
+    ALCcontext* alc_context;
+    seal_err_t err;
+
+    alcGetError(device);
+
+    /* Initialize context. */
+    alc_context = alcCreateContext(device, attr);
+    switch (alcGetError(device)) {
+    case ALC_INVALID_VALUE:
+        err = SEAL_CANNOT_CREATE_CONTEXT;
+        goto clean_device;
+    case ALC_INVALID_DEVICE:
+        err = SEAL_BAD_DEVICE;
+        goto clean_device;
+    }
+    if (alc_context == 0) {
+        err = SEAL_CANNOT_CREATE_CONTEXT;
+        goto clean_device;
+    }
+
+    context->device = device;
+    context->context = alc_context;
+    /* Effects are optional; see `_seal_init_efx'. */
+    if (alcIsExtensionPresent(device, ALC_EXT_EFX_NAME))
+        alcGetIntegerv(device, ALC_MAX_AUXILIARY_SENDS, 1,
+                       &context->per_src_effect_limit);
+    else
+        context->per_src_effect_limit = 0;
+    alcGetIntegerv(device, ALC_FREQUENCY, 1, &context->device_freq);
+
+    return SEAL_OK;
+
+clean_device:
+    alcCloseDevice(device);
+
+    return err;
+}
+
+/*
+ * Makes the default context current for the process and looks up the
+ * thread-local context extension on its device.
+ */
+static
+void
+use_default_context(void)
+{
+    alcMakeContextCurrent(default_context.context);
+    process_context = &default_context;
+
+    if (alcIsExtensionPresent(default_context.device,
+                              "ALC_EXT_thread_local_context")) {
+        set_thread_context = alcGetProcAddress(default_context.device,
+                                               "alcSetThreadContext");
+    }
+}
+
+seal_err_t
+SEAL_API
+seal_open_context(seal_context_t* context, const char* device_name)
+{
+    ALCdevice* device;
+    ALint attr[] = { ALC_MAX_AUXILIARY_SENDS, 4, 0, 0 };
+
+    reset(context);
+
+    /* Initialize device. */
+    device = alcOpenDevice(device_name);
+    if (device == 0)
+        return SEAL_CANNOT_OPEN_DEVICE;
+
+    return create(context, device, attr);
+}
+
+seal_err_t
+SEAL_API
+seal_close_context(seal_context_t* context)
+{
+    if (context->context == 0)
+        return SEAL_OK;
+    if (context == &default_context)
+        return SEAL_BAD_OP;
+
+    if (context == thread_context) {
+        set_thread_context(0);
+        thread_context = 0;
+    }
+    if (context == process_context) {
+        alcMakeContextCurrent(default_context.context);
+        process_context = &default_context;
+    }
+    destroy(context);
+
+    return SEAL_OK;
+}
+
+seal_err_t
+SEAL_API
+seal_use_context(seal_context_t* context)
+{
+    if (context != 0 && context->context == 0)
+        return SEAL_BAD_OBJ;
+    /* Threads are expected to unbind before exiting. */
+    if (context == 0 && !_seal_is_batching())
+        _seal_reset_batch();
+
+    if (set_thread_context != 0) {
+        if (!set_thread_context(context == 0 ? 0 : context->context))
+            return SEAL_BAD_OBJ;
+        thread_context = context;
+
+        return SEAL_OK;
+    }
+
+    /* Falls back to switching the context of the whole process. */
+    if (context == 0)
+        context = &default_context;
+    if (!alcMakeContextCurrent(context->context))
+        return SEAL_BAD_OBJ;
+    process_context = context;
+
+    return SEAL_OK;
+}
+
+seal_context_t*
+SEAL_API
+seal_get_context(void)
+{
+    return thread_context;
+}
+
+char
+SEAL_API
+seal_has_thread_local_context(void)
+{
+    return set_thread_context != 0;
+}
+
+seal_context_t*
+_seal_get_context(void)
+{
+    return thread_context != 0 ? thread_context : process_context;
+}
+
+seal_err_t
+_seal_open_default_context(const char* device_name)
+{
+    seal_err_t err;
+
+    if ((err = seal_open_context(&default_context, device_name)) != SEAL_OK)
+        return err;
+    use_default_context();
+
+    return SEAL_OK;
+}
+
+seal_err_t
+_seal_open_loopback_context(int freq, int nchannels, seal_sample_type_t type)
+{
+    loopback_open_device_t* open_device;
+    is_render_format_supported_t* is_format_supported;
+    render_samples_t* render;
+    ALCdevice* device;
+    ALCint attr[] = {
+        ALC_FORMAT_CHANNELS_SOFT, 0,
+        ALC_FORMAT_TYPE_SOFT, 0,
+        ALC_FREQUENCY, 0,
+        ALC_MAX_AUXILIARY_SENDS, 4,
+        0, 0
+    };
+    seal_err_t err;
+
+    if (freq <= 0 || nchannels <= 0 || (size_t) nchannels >= NCHANNEL_LAYOUTS
+        || CHANNEL_LAYOUTS[nchannels] == 0)
+        return SEAL_BAD_VAL;
+    if ((size_t) type >= NSAMPLE_TYPES)
+        return SEAL_BAD_ENUM;
+
+    reset(&default_context);
+    if (!alcIsExtensionPresent(0, "ALC_SOFT_loopback"))
+        return SEAL_NO_EXT_FUNC;
+    open_device = alcGetProcAddress(0, "alcLoopbackOpenDeviceSOFT");
+    is_format_supported = alcGetProcAddress(0,
+                                            "alcIsRenderFormatSupportedSOFT");
+    render = alcGetProcAddress(0, "alcRenderSamplesSOFT");
+    if (open_device == 0 || is_format_supported == 0 || render == 0)
+        return SEAL_NO_EXT_FUNC;
+
+    device = open_device(0);
+    if (device == 0)
+        return SEAL_CANNOT_OPEN_DEVICE;
+    if (!is_format_supported(device, freq, CHANNEL_LAYOUTS[nchannels],
+                             SAMPLE_TYPES[type])) {
+        alcCloseDevice(device);
+        return SEAL_BAD_VAL;
+    }
+    attr[1] = CHANNEL_LAYOUTS[nchannels];
+    attr[3] = SAMPLE_TYPES[type];
+    attr[5] = freq;
+    if ((err = create(&default_context, device, attr)) != SEAL_OK)
+        return err;
+    use_default_context();
+    render_samples = render;
+    loopback_frame_size = nchannels * SAMPLE_SIZES[type];
+
+    return SEAL_OK;
+}
+
+void
+_seal_close_default_context(void)
+{
+    if (thread_context != 0)
+        set_thread_context(0);
+    thread_context = 0;
+    alcMakeContextCurrent(0);
+    process_context = &default_context;
+    set_thread_context = 0;
+    render_samples = 0;
+    loopback_frame_size = 0;
+    destroy(&default_context);
+}
+
+char
+_seal_is_loopback(void)
+{
+    return render_samples != 0 && _seal_get_context() == &default_context;
+}
+
+size_t
+_seal_get_loopback_frame_size(void)
+{
+    return loopback_frame_size;
+}
+
+void
+_seal_render_loopback(void* dst, size_t nframes)
+{
+    render_samples(default_context.device, dst, (ALCsizei) nframes);
+}
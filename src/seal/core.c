@@ -3,11 +3,41 @@
 #include <al/al.h>
 #include <al/alc.h>
 #include <al/efx.h>
-#include <mpg123/mpg123.h>
 #include <seal/core.h>
 #include <seal/err.h>
+#include <seal/context.h>
+#include <seal/src.h>
+#include "batch.h"
+#include "threading.h"
+#include "mpg.h"
 
-static int per_src_effect_limit = -1;
+/*
+ * The number of frames rendered between two rounds of streaming updates, far
+ * less than what a chunk of a stream holds.
+ */
+#define RENDER_STEP 1024
+
+static char resampling = 0;
+/* See `seal_set_cancel_flag'. */
+static _SEAL_THREAD_LOCAL volatile char* cancel_flag = 0;
+/*
+ * 1 once the effect extension functions have been looked up, which happens
+ * the first time an effect or effect slot is initialized, and the outcome.
+ */
+static char efx_resolved = 0;
+static seal_err_t efx_err = SEAL_OK;
+
+/* OpenAL distance models indexed by `seal_distance_model_t'. */
+static const int DISTANCE_MODELS[] = {
+    AL_NONE,
+    AL_INVERSE_DISTANCE,
+    AL_INVERSE_DISTANCE_CLAMPED,
+    AL_LINEAR_DISTANCE,
+    AL_LINEAR_DISTANCE_CLAMPED,
+    AL_EXPONENT_DISTANCE,
+    AL_EXPONENT_DISTANCE_CLAMPED
+};
+#define NDISTANCE_MODELS (sizeof DISTANCE_MODELS / sizeof DISTANCE_MODELS[0])
 
 void _seal_nop() {}
 void* _seal_nop_func() { return 0; }
@@ -27,6 +57,23 @@ LPALAUXILIARYEFFECTSLOTF alAuxiliaryEffectSlotf = (void*) _seal_nop;
 LPALGETAUXILIARYEFFECTSLOTI alGetAuxiliaryEffectSloti = (void*) _seal_nop;
 LPALGETAUXILIARYEFFECTSLOTF alGetAuxiliaryEffectSlotf = (void*) _seal_nop;
 
+static
+void
+suspend_context(void)
+{
+    alcSuspendContext(alcGetCurrentContext());
+}
+
+static
+void
+process_context(void)
+{
+    alcProcessContext(alcGetCurrentContext());
+}
+
+void (*alDeferUpdatesSOFT)(void) = suspend_context;
+void (*alProcessUpdatesSOFT)(void) = process_context;
+
 const char*
 SEAL_API
 seal_get_version(void)
@@ -63,6 +110,27 @@ init_ext_proc(void)
         return SEAL_NO_EXT_FUNC;
 }
 
+/*
+ * Deferred updates are optional, so their absence does not fail startup;
+ * suspending the context is the fallback.
+ */
+static
+void
+init_deferred_updates(void)
+{
+    void* defer;
+    void* process;
+
+    if (!alIsExtensionPresent("AL_SOFT_deferred_updates"))
+        return;
+    defer = alGetProcAddress("alDeferUpdatesSOFT");
+    process = alGetProcAddress("alProcessUpdatesSOFT");
+    if (defer != 0 && process != 0) {
+        alDeferUpdatesSOFT = defer;
+        alProcessUpdatesSOFT = process;
+    }
+}
+
 static
 void
 reset_ext_proc(void)
@@ -84,92 +152,208 @@ reset_ext_proc(void)
 }
 
 /*
- * Initializes the specified device and creates a single context. SEAL
- * currently does not make use of multiple contexts.
+ * Only what every program needs is set up here; effects and libmpg123 are
+ * initialized on first use.
+ */
+static
+void
+init(void)
+{
+    init_deferred_updates();
+
+    /* Reset OpenAL's error state. */
+    alGetError();
+}
+
+/*
+ * Initializes the specified device and creates the context current for the
+ * process; see context.h for more contexts.
  */
 seal_err_t
 SEAL_API
 seal_startup(const char* device_name)
 {
-    ALCdevice* device;
-    ALCcontext* context;
     seal_err_t err;
-    ALint attr[] = { ALC_MAX_AUXILIARY_SENDS, 4, 0, 0 };
-
-    /* Initialize device. */
-    device = alcOpenDevice(device_name);
-    if (device == 0)
-        return SEAL_CANNOT_OPEN_DEVICE;
-    alcGetError(device);
-
-    /* Initialize extensions. */
-    if (!alcIsExtensionPresent(device, ALC_EXT_EFX_NAME)) {
-        err = SEAL_NO_EFX;
-        goto clean_device;
-    }
 
-    /* Initialize context. */
-    context = alcCreateContext(device, attr);
-    switch (alcGetError(device)) {
-    case ALC_INVALID_VALUE:
-        err = SEAL_CANNOT_CREATE_CONTEXT;
-        goto clean_device;
-    case ALC_INVALID_DEVICE:
-        err = SEAL_BAD_DEVICE;
-        goto clean_device;
-    }
-    alcMakeContextCurrent(context);
+    if ((err = _seal_open_default_context(device_name)) != SEAL_OK)
+        return err;
+    init();
 
-    err = init_ext_proc();
-    if (err != SEAL_OK)
-        goto clean_all;
+    return SEAL_OK;
+}
 
-    /* Initialize libmpg123 (thread-unsafe). */
-    if (mpg123_init() != MPG123_OK) {
-        err = SEAL_CANNOT_INIT_MPG;
-        goto clean_all;
+seal_err_t
+SEAL_API
+seal_startup_loopback(int freq, int nchannels, seal_sample_type_t type)
+{
+    seal_err_t err;
+
+    err = _seal_open_loopback_context(freq, nchannels, type);
+    if (err != SEAL_OK)
+        return err;
+    if ((err = _seal_init_rendered_srcs()) != SEAL_OK) {
+        _seal_close_default_context();
+        return err;
     }
+    init();
 
-    /* Reset OpenAL's error state. */
-    alGetError();
+    return SEAL_OK;
+}
 
-    alcGetIntegerv(device, ALC_MAX_AUXILIARY_SENDS, 1, &per_src_effect_limit);
+seal_err_t
+SEAL_API
+seal_render(void* dst, size_t nframes)
+{
+    size_t frame_size = _seal_get_loopback_frame_size();
+    seal_err_t err;
 
-    return SEAL_OK;
+    if (!_seal_is_loopback())
+        return SEAL_BAD_OP;
 
-clean_all:
-    alcMakeContextCurrent(0);
-    alcDestroyContext(context);
-clean_device:
-    alcCloseDevice(device);
+    while (nframes > 0) {
+        size_t n = nframes < RENDER_STEP ? nframes : RENDER_STEP;
 
-    return err;
+        /* Refill the queues before the mixer gets to the end of them. */
+        if ((err = _seal_update_rendered_srcs()) != SEAL_OK)
+            return err;
+        _seal_render_loopback(dst, n);
+        dst = (char*) dst + n * frame_size;
+        nframes -= n;
+    }
+
+    return SEAL_OK;
 }
 
-/* Finalizes the current device and context. */
+/* Finalizes the device and context created by `seal_startup'. */
 void
 SEAL_API
 seal_cleanup(void)
 {
-    ALCdevice* device;
-    ALCcontext* context;
-
-    mpg123_exit();
-
-    context = alcGetCurrentContext();
-    device = alcGetContextsDevice(context);
-    alcMakeContextCurrent(0);
-    alcDestroyContext(context);
-    alcCloseDevice(device);
-
+    /* Lets background work finish before its subsystems go away. */
+    _seal_stop_workers();
+    _seal_cleanup_mpg();
+    _seal_reset_batch();
+    _seal_forget_rendered_srcs();
+    _seal_close_default_context();
     reset_ext_proc();
+    efx_resolved = 0;
+    alDeferUpdatesSOFT = suspend_context;
+    alProcessUpdatesSOFT = process_context;
 }
 
 int
 SEAL_API
 seal_get_per_src_effect_limit(void)
 {
-    return per_src_effect_limit;
+    return _seal_get_context()->per_src_effect_limit;
+}
+
+int
+SEAL_API
+seal_get_device_freq(void)
+{
+    return _seal_get_context()->device_freq;
+}
+
+void
+SEAL_API
+seal_set_resampling(char value)
+{
+    resampling = value != 0;
+}
+
+char
+SEAL_API
+seal_is_resampling(void)
+{
+    return resampling;
+}
+
+seal_err_t
+SEAL_API
+seal_set_distance_model(seal_distance_model_t model)
+{
+    if ((size_t) model >= NDISTANCE_MODELS)
+        return SEAL_BAD_ENUM;
+    _seal_drain_openal_err();
+    alDistanceModel(DISTANCE_MODELS[model]);
+
+    return _seal_get_openal_err();
+}
+
+seal_err_t
+SEAL_API
+seal_get_distance_model(seal_distance_model_t* pmodel)
+{
+    int model;
+    size_t i;
+    seal_err_t err;
+
+    _seal_drain_openal_err();
+    model = alGetInteger(AL_DISTANCE_MODEL);
+    if ((err = _seal_get_openal_err()) != SEAL_OK)
+        return err;
+    for (i = 0; i < NDISTANCE_MODELS; ++i) {
+        if (DISTANCE_MODELS[i] == model) {
+            *pmodel = i;
+            return SEAL_OK;
+        }
+    }
+
+    return SEAL_BAD_ENUM;
+}
+
+void
+SEAL_API
+seal_set_cancel_flag(volatile char* flag)
+{
+    cancel_flag = flag;
+}
+
+int
+_seal_is_canceled(void)
+{
+    return cancel_flag != 0 && *cancel_flag;
+}
+
+int
+_seal_is_cancelable(void)
+{
+    return cancel_flag != 0;
+}
+
+seal_err_t
+_seal_init_efx(void)
+{
+    seal_err_t err;
+
+    _seal_lock_lazy_init();
+    if (!efx_resolved) {
+        if (!alcIsExtensionPresent(_seal_get_context()->device,
+                                   ALC_EXT_EFX_NAME))
+            efx_err = SEAL_NO_EFX;
+        else
+            efx_err = init_ext_proc();
+        /* Never leave some of the functions null. */
+        if (efx_err != SEAL_OK)
+            reset_ext_proc();
+        efx_resolved = 1;
+    }
+    err = efx_err;
+    _seal_unlock_lazy_init();
+
+    return err;
+}
+
+int
+_seal_get_resampling_freq(seal_raw_attr_t* attr)
+{
+    int device_freq = _seal_get_context()->device_freq;
+
+    if (resampling && device_freq > 0 && attr->freq != device_freq)
+        return device_freq;
+
+    return 0;
 }
 
 unsigned int
@@ -182,6 +366,7 @@ _seal_openal_id(void* obj)
 seal_err_t
 _seal_gen_objs(int n, unsigned int* objs, _seal_openal_initializer_t* generate)
 {
+    _seal_drain_openal_err();
     generate(n, objs);
 
     return _seal_get_openal_err();
@@ -194,6 +379,7 @@ _seal_delete_objs(
     _seal_openal_destroyer_t* destroy
 )
 {
+    _seal_drain_openal_err();
     destroy(n, objs);
 
     return _seal_get_openal_err();
@@ -212,8 +398,10 @@ _seal_destroy_obj(
     _seal_openal_validator_t* valid
 )
 {
-    if (valid(_seal_openal_id(obj)))
+    if (valid(_seal_openal_id(obj))) {
+        _seal_flush_batch();
         return _seal_delete_objs(1, obj, destroy);
+    }
 
     return SEAL_OK;
 }
@@ -221,22 +409,27 @@ _seal_destroy_obj(
 seal_err_t
 _seal_setf(void* obj, int key, float val, _seal_openal_setterf* set)
 {
+    if (_seal_defer_write(set, _seal_openal_id(obj), key, _SEAL_DEFERRED_F,
+                          &val))
+        return SEAL_OK;
     set(_seal_openal_id(obj), key, val);
 
-    return _seal_get_openal_err();
+    return _seal_get_openal_prop_err();
 }
 
 seal_err_t
 _seal_getf(void* obj, int key, float* pval, _seal_openal_getterf* get)
 {
+    _seal_flush_batch();
     get(_seal_openal_id(obj), key, pval);
 
-    return _seal_get_openal_err();
+    return _seal_get_openal_prop_err();
 }
 
 seal_err_t
 _seal_seti(void* obj, int key, int val, _seal_openal_setteri* set)
 {
+    _seal_drain_openal_err();
     set(_seal_openal_id(obj), key, val);
 
     return _seal_get_openal_err();
@@ -245,6 +438,7 @@ _seal_seti(void* obj, int key, int val, _seal_openal_setteri* set)
 seal_err_t
 _seal_geti(void* obj, int key, int* pval, _seal_openal_getteri* get)
 {
+    _seal_drain_openal_err();
     get(_seal_openal_id(obj), key, pval);
 
     return _seal_get_openal_err();
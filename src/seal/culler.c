@@ -0,0 +1,526 @@
+#include <stdlib.h>
+#include <math.h>
+#include <float.h>
+#include <al/al.h>
+#include <seal/culler.h>
+#include <seal/src.h>
+#include <seal/buf.h>
+#include <seal/listener.h>
+#include <seal/core.h>
+#include <seal/err.h>
+
+typedef struct entry_t entry_t;
+
+struct entry_t
+{
+    /* The source or 0 if the entry is free. */
+    seal_src_t* src;
+    long        cell[3];
+    /* One-based index of the next entry in the same bucket or free list. */
+    size_t      next;
+    /* One-based index in `active' or 0 if not checked on every pass. */
+    size_t      active;
+    /* The culler time when the source was culled. */
+    double      culled_at;
+    /* The playback offset, in seconds, of a static source when culled. */
+    float       offset;
+};
+
+static const size_t INITIAL_CAPACITY = 64;
+/* Keeps cell coordinates well within the range of `long'. */
+static const float MAX_CELL = 1e9f;
+
+static
+long
+to_cell(seal_culler_t* culler, float coord)
+{
+    float cell = (float) floor(coord / culler->cell_size);
+
+    /* Also catches NaN. */
+    if (!(cell > -MAX_CELL))
+        return (long) -MAX_CELL;
+    if (cell > MAX_CELL)
+        return (long) MAX_CELL;
+
+    return (long) cell;
+}
+
+static
+size_t
+hash(seal_culler_t* culler, const long* cell)
+{
+    unsigned long h = (unsigned long) cell[0] * 73856093ul
+                      ^ (unsigned long) cell[1] * 19349663ul
+                      ^ (unsigned long) cell[2] * 83492791ul;
+
+    return h & (culler->nbuckets - 1);
+}
+
+static
+void
+link_entry(seal_culler_t* culler, size_t i)
+{
+    entry_t* entry = (entry_t*) culler->entries + i;
+    size_t* bucket = culler->buckets + hash(culler, entry->cell);
+
+    entry->next = *bucket;
+    *bucket = i + 1;
+}
+
+static
+void
+unlink_entry(seal_culler_t* culler, size_t i)
+{
+    entry_t* entries = culler->entries;
+    size_t* p = culler->buckets + hash(culler, entries[i].cell);
+
+    while (*p != i + 1)
+        p = &entries[*p - 1].next;
+    *p = entries[i].next;
+}
+
+static
+void
+activate(seal_culler_t* culler, size_t i)
+{
+    entry_t* entry = (entry_t*) culler->entries + i;
+
+    if (entry->active == 0) {
+        culler->active[culler->nactive++] = i;
+        entry->active = culler->nactive;
+    }
+}
+
+static
+void
+deactivate(seal_culler_t* culler, size_t i)
+{
+    entry_t* entries = culler->entries;
+    size_t last;
+
+    if (entries[i].active == 0)
+        return;
+    last = culler->active[--culler->nactive];
+    culler->active[entries[i].active - 1] = last;
+    entries[last].active = entries[i].active;
+    entries[i].active = 0;
+}
+
+static
+void
+extend_reach(seal_culler_t* culler, float max_dist)
+{
+    if (max_dist < FLT_MAX && max_dist > culler->reach)
+        culler->reach = max_dist;
+}
+
+/* Doubles the capacity and rebuilds the hash table. */
+static
+seal_err_t
+grow(seal_culler_t* culler)
+{
+    size_t capacity = culler->capacity == 0 ? INITIAL_CAPACITY
+                                            : culler->capacity * 2;
+    entry_t* entries;
+    size_t* active;
+    size_t* buckets;
+    size_t i;
+
+    entries = realloc(culler->entries, capacity * sizeof (entry_t));
+    if (entries == 0)
+        return SEAL_CANNOT_ALLOC_MEM;
+    culler->entries = entries;
+    active = realloc(culler->active, capacity * sizeof (size_t));
+    if (active == 0)
+        return SEAL_CANNOT_ALLOC_MEM;
+    culler->active = active;
+    buckets = calloc(capacity, sizeof (size_t));
+    if (buckets == 0)
+        return SEAL_CANNOT_ALLOC_MEM;
+    free(culler->buckets);
+    culler->buckets = buckets;
+    culler->nbuckets = capacity;
+    culler->capacity = capacity;
+
+    for (i = 0; i < culler->nentries; ++i)
+        if (entries[i].src != 0)
+            link_entry(culler, i);
+
+    return SEAL_OK;
+}
+
+static
+int
+is_out_of_range(const seal_src_t* src, const float* listener_pos)
+{
+    float dx, dy, dz;
+
+    if (src->relative || src->max_dist >= FLT_MAX)
+        return 0;
+    dx = src->pos[0] - listener_pos[0];
+    dy = src->pos[1] - listener_pos[1];
+    dz = src->pos[2] - listener_pos[2];
+
+    return dx * dx + dy * dy + dz * dz > src->max_dist * src->max_dist;
+}
+
+static
+seal_err_t
+get_duration(seal_buf_t* buf, float* pduration)
+{
+    int size, freq, bps, nchannels;
+    seal_err_t err;
+
+    if ((err = seal_get_buf_size(buf, &size)) != SEAL_OK)
+        return err;
+    if ((err = seal_get_buf_freq(buf, &freq)) != SEAL_OK)
+        return err;
+    if ((err = seal_get_buf_bps(buf, &bps)) != SEAL_OK)
+        return err;
+    if ((err = seal_get_buf_nchannels(buf, &nchannels)) != SEAL_OK)
+        return err;
+    if (freq <= 0 || bps < 8 || nchannels <= 0)
+        *pduration = 0;
+    else
+        *pduration = (float) size / (nchannels * (bps / 8)) / freq;
+
+    return SEAL_OK;
+}
+
+/*
+ * Pauses the source of an entry if it is playing. Either way the entry is no
+ * longer checked on every pass; sources that are not playing are checked
+ * again once played.
+ */
+static
+seal_err_t
+cull(seal_culler_t* culler, size_t i)
+{
+    entry_t* entry = (entry_t*) culler->entries + i;
+    seal_src_t* src = entry->src;
+    seal_src_state_t state;
+    seal_err_t err;
+
+    if ((err = seal_get_src_state(src, &state)) != SEAL_OK)
+        return err;
+    if (state == SEAL_PLAYING) {
+        if (src->buf != 0) {
+            err = _seal_getf(src, AL_SEC_OFFSET, &entry->offset,
+                             alGetSourcef);
+            if (err != SEAL_OK)
+                return err;
+        }
+        if ((err = seal_pause_src(src)) != SEAL_OK)
+            return err;
+        src->culled = 1;
+        entry->culled_at = culler->time;
+    }
+    deactivate(culler, i);
+
+    return SEAL_OK;
+}
+
+/*
+ * Resumes a culled source. Static sources skip the audio they would have
+ * played while culled.
+ */
+static
+seal_err_t
+resume(seal_culler_t* culler, entry_t* entry)
+{
+    seal_src_t* src = entry->src;
+    seal_err_t err;
+
+    if (src->buf != 0) {
+        float duration, offset;
+
+        if ((err = get_duration(src->buf, &duration)) != SEAL_OK)
+            return err;
+        offset = entry->offset
+                 + (float) (culler->time - entry->culled_at) * src->pitch;
+        if (offset >= duration) {
+            if (!src->looping || duration <= 0)
+                return seal_stop_src(src);
+            offset = (float) fmod(offset, duration);
+        }
+        _seal_drain_openal_err();
+        alSourcef(src->id, AL_SEC_OFFSET, offset);
+        if ((err = _seal_get_openal_err()) != SEAL_OK)
+            return err;
+    }
+
+    return seal_play_src(src);
+}
+
+static
+int
+is_waiting(const entry_t* entry, const float* listener_pos)
+{
+    return entry->src != 0 && entry->active == 0 && entry->src->culled
+           && !is_out_of_range(entry->src, listener_pos);
+}
+
+static
+seal_err_t
+resume_in_cell(seal_culler_t* culler, const long* cell,
+               const float* listener_pos)
+{
+    entry_t* entries = culler->entries;
+    seal_err_t err = SEAL_OK, resume_err;
+    size_t i;
+
+    for (i = culler->buckets[hash(culler, cell)]; i != 0;
+         i = entries[i - 1].next) {
+        entry_t* entry = entries + i - 1;
+
+        /* Other cells may hash to the same bucket. */
+        if (entry->cell[0] != cell[0] || entry->cell[1] != cell[1]
+            || entry->cell[2] != cell[2] || !is_waiting(entry, listener_pos))
+            continue;
+        resume_err = resume(culler, entry);
+        if (err == SEAL_OK)
+            err = resume_err;
+    }
+
+    return err;
+}
+
+/* Resumes the culled sources back in range of the listener. */
+static
+seal_err_t
+resume_in_range(seal_culler_t* culler, const float* listener_pos)
+{
+    entry_t* entries = culler->entries;
+    long lo[3], hi[3], cell[3];
+    double ncells = 1;
+    seal_err_t err = SEAL_OK, resume_err;
+    size_t i;
+
+    for (i = 0; i < 3; ++i) {
+        lo[i] = to_cell(culler, listener_pos[i] - culler->reach);
+        hi[i] = to_cell(culler, listener_pos[i] + culler->reach);
+        ncells *= (double) hi[i] - lo[i] + 1;
+    }
+
+    /* Scanning every entry is cheaper than looking up that many cells. */
+    if (ncells >= culler->nbuckets) {
+        for (i = 0; i < culler->nentries; ++i) {
+            if (!is_waiting(entries + i, listener_pos))
+                continue;
+            resume_err = resume(culler, entries + i);
+            if (err == SEAL_OK)
+                err = resume_err;
+        }
+        return err;
+    }
+
+    for (cell[0] = lo[0]; cell[0] <= hi[0]; ++cell[0]) {
+        for (cell[1] = lo[1]; cell[1] <= hi[1]; ++cell[1]) {
+            for (cell[2] = lo[2]; cell[2] <= hi[2]; ++cell[2]) {
+                resume_err = resume_in_cell(culler, cell, listener_pos);
+                if (err == SEAL_OK)
+                    err = resume_err;
+            }
+        }
+    }
+
+    return err;
+}
+
+static
+void
+reset(seal_culler_t* culler)
+{
+    culler->reach = 0;
+    culler->time = 0;
+    culler->entries = 0;
+    culler->nentries = 0;
+    culler->capacity = 0;
+    culler->nsrcs = 0;
+    culler->free = 0;
+    culler->active = 0;
+    culler->nactive = 0;
+    culler->buckets = 0;
+    culler->nbuckets = 0;
+}
+
+seal_err_t
+SEAL_API
+seal_init_culler(seal_culler_t* culler, float cell_size)
+{
+    if (!(cell_size > 0))
+        return SEAL_BAD_VAL;
+
+    culler->cell_size = cell_size;
+    reset(culler);
+
+    return SEAL_OK;
+}
+
+seal_err_t
+SEAL_API
+seal_destroy_culler(seal_culler_t* culler)
+{
+    entry_t* entries = culler->entries;
+    size_t i;
+
+    for (i = 0; i < culler->nentries; ++i) {
+        if (entries[i].src != 0) {
+            entries[i].src->culler = 0;
+            entries[i].src->culled = 0;
+        }
+    }
+    free(culler->entries);
+    free(culler->active);
+    free(culler->buckets);
+    reset(culler);
+
+    return SEAL_OK;
+}
+
+seal_err_t
+SEAL_API
+seal_add_culled_src(seal_culler_t* culler, seal_src_t* src)
+{
+    entry_t* entry;
+    size_t i;
+    seal_err_t err;
+
+    if (src->culler == culler)
+        return SEAL_OK;
+    if (src->culler != 0)
+        return SEAL_BAD_OP;
+    if (culler->free == 0 && culler->nentries == culler->capacity
+        && (err = grow(culler)) != SEAL_OK)
+        return err;
+
+    if (culler->free != 0) {
+        i = culler->free - 1;
+        culler->free = ((entry_t*) culler->entries)[i].next;
+    } else {
+        i = culler->nentries++;
+    }
+    entry = (entry_t*) culler->entries + i;
+    entry->src = src;
+    entry->cell[0] = to_cell(culler, src->pos[0]);
+    entry->cell[1] = to_cell(culler, src->pos[1]);
+    entry->cell[2] = to_cell(culler, src->pos[2]);
+    entry->active = 0;
+    entry->culled_at = 0;
+    entry->offset = 0;
+    link_entry(culler, i);
+    activate(culler, i);
+    extend_reach(culler, src->max_dist);
+    ++culler->nsrcs;
+    src->culler = culler;
+    src->cull_slot = i;
+
+    return SEAL_OK;
+}
+
+seal_err_t
+SEAL_API
+seal_remove_culled_src(seal_culler_t* culler, seal_src_t* src)
+{
+    entry_t* entry;
+    size_t i = src->cull_slot;
+
+    if (src->culler != culler)
+        return SEAL_OK;
+
+    unlink_entry(culler, i);
+    deactivate(culler, i);
+    entry = (entry_t*) culler->entries + i;
+    entry->src = 0;
+    entry->next = culler->free;
+    culler->free = i + 1;
+    --culler->nsrcs;
+    src->culler = 0;
+    src->culled = 0;
+
+    return SEAL_OK;
+}
+
+seal_err_t
+SEAL_API
+seal_cull_srcs(seal_culler_t* culler, float dt)
+{
+    entry_t* entries = culler->entries;
+    float listener_pos[3];
+    seal_err_t err = SEAL_OK, cull_err;
+    size_t i;
+
+    culler->time += dt;
+    seal_get_listener_pos(listener_pos, listener_pos + 1, listener_pos + 2);
+
+    /* Culled sources leave `active' so `i' stays put. */
+    for (i = 0; i < culler->nactive;) {
+        size_t index = culler->active[i];
+
+        if (!is_out_of_range(entries[index].src, listener_pos)) {
+            ++i;
+            continue;
+        }
+        if ((cull_err = cull(culler, index)) != SEAL_OK) {
+            if (err == SEAL_OK)
+                err = cull_err;
+            ++i;
+        }
+    }
+
+    if (culler->nactive < culler->nsrcs && culler->reach > 0) {
+        cull_err = resume_in_range(culler, listener_pos);
+        if (err == SEAL_OK)
+            err = cull_err;
+    }
+
+    return err;
+}
+
+seal_err_t
+SEAL_API
+seal_get_culler_size(seal_culler_t* culler, size_t* psize)
+{
+    *psize = culler->nsrcs;
+
+    return SEAL_OK;
+}
+
+seal_err_t
+SEAL_API
+seal_is_src_culled(seal_src_t* src, char* pculled)
+{
+    *pculled = src->culled;
+
+    return SEAL_OK;
+}
+
+void
+_seal_update_culled_src(seal_src_t* src)
+{
+    seal_culler_t* culler = src->culler;
+    size_t i = src->cull_slot;
+    entry_t* entry = (entry_t*) culler->entries + i;
+    long cell[3];
+
+    extend_reach(culler, src->max_dist);
+    cell[0] = to_cell(culler, src->pos[0]);
+    cell[1] = to_cell(culler, src->pos[1]);
+    cell[2] = to_cell(culler, src->pos[2]);
+    if (cell[0] == entry->cell[0] && cell[1] == entry->cell[1]
+        && cell[2] == entry->cell[2])
+        return;
+
+    unlink_entry(culler, i);
+    entry->cell[0] = cell[0];
+    entry->cell[1] = cell[1];
+    entry->cell[2] = cell[2];
+    link_entry(culler, i);
+}
+
+void
+_seal_wake_culled_src(seal_src_t* src)
+{
+    src->culled = 0;
+    activate(src->culler, src->cull_slot);
+}
@@ -3,11 +3,17 @@
 #include <seal/efs.h>
 #include <seal/core.h>
 #include <seal/err.h>
+#include "batch.h"
 
 seal_err_t
 SEAL_API
 seal_init_efs(seal_efs_t* slot)
 {
+    seal_err_t err;
+
+    if ((err = _seal_init_efx()) != SEAL_OK)
+        return err;
+
     return _seal_init_obj(slot, alGenAuxiliaryEffectSlots);
 }
 
@@ -28,6 +34,8 @@ seal_set_efs_effect(seal_efs_t* slot, void* effect)
 {
     seal_err_t err;
 
+    /* The slot takes a copy of the parameters of the effect. */
+    _seal_flush_batch();
     err = _seal_seti(
         slot,
         AL_EFFECTSLOT_EFFECT,
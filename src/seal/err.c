@@ -1,5 +1,18 @@
 #include <al/al.h>
 #include <seal/err.h>
+#include "threading.h"
+
+#ifdef SEAL_UNCHECKED
+static char unchecked = 1;
+#else
+static char unchecked = 0;
+#endif
+
+/*
+ * The first error left by unchecked calls and found by checked ones, kept
+ * for `seal_get_deferred_err'. Shared by all threads and contexts.
+ */
+static volatile long deferred_err = SEAL_OK;
 
 const char*
 SEAL_API
@@ -88,11 +101,51 @@ seal_get_err_msg(seal_err_t err)
     case SEAL_CANNOT_CLOSE_MPG:
         return "Failed closing the specified MPEG file";
 
+    case SEAL_CANCELED:
+        return "The operation was canceled";
+
     default:
         return "Unkown error";
     }
 }
 
+void
+SEAL_API
+seal_set_unchecked(char value)
+{
+    /* Keeps what unchecked calls left from checked calls made afterwards. */
+    _seal_drain_openal_err();
+    unchecked = value != 0;
+}
+
+char
+SEAL_API
+seal_is_unchecked(void)
+{
+    return unchecked;
+}
+
+seal_err_t
+SEAL_API
+seal_get_deferred_err(void)
+{
+    seal_err_t pending = _seal_get_openal_err();
+    seal_err_t first = (seal_err_t) _seal_swap_long(&deferred_err, SEAL_OK);
+
+    return first != SEAL_OK ? first : pending;
+}
+
+void
+_seal_drain_openal_err(void)
+{
+    seal_err_t err;
+
+    if (!unchecked)
+        return;
+    if ((err = _seal_get_openal_err()) != SEAL_OK)
+        _seal_cas_long(&deferred_err, SEAL_OK, err);
+}
+
 seal_err_t
 _seal_get_openal_err(void)
 {
@@ -111,3 +164,12 @@ _seal_get_openal_err(void)
         return SEAL_OK;
     }
 }
+
+seal_err_t
+_seal_get_openal_prop_err(void)
+{
+    if (unchecked)
+        return SEAL_OK;
+
+    return _seal_get_openal_err();
+}
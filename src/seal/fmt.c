@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <seal/fmt.h>
+#include <seal/io.h>
 #include <seal/err.h>
 #include "reader.h"
 
@@ -26,17 +27,32 @@ static const unsigned int SYNC = 0xf0ff;
 seal_err_t
 seal_recognize_fmt(const char* filename, seal_fmt_t* pfmt)
 {
-    FILE* audio;
-    uint32_t magic_nums[SAMPLE_SIZE];
+    seal_io_t io;
+    seal_err_t err;
 
-    audio = _seal_fopen(filename);
-    if (audio == 0)
-        return SEAL_CANNOT_OPEN_FILE;
+    if ((err = _seal_open_file_io(&io, filename)) != SEAL_OK)
+        return err;
+    err = seal_recognize_io_fmt(&io, pfmt);
+    io.close(io.handle);
+
+    return err;
+}
+
+seal_err_t
+seal_recognize_io_fmt(seal_io_t* io, seal_fmt_t* pfmt)
+{
+    uint32_t magic_nums[SAMPLE_SIZE] = { 0 };
+    long pos;
+
+    *pfmt = SEAL_UNKNOWN_FMT;
+    if ((pos = io->tell(io->handle)) < 0)
+        return SEAL_BAD_AUDIO;
 
     /* Gets the magic numbers in little-endian. */
-    _seal_read_uint32le(magic_nums, SAMPLE_SIZE, audio);
+    _seal_read_uint32le(magic_nums, SAMPLE_SIZE, io);
 
-    _seal_fclose(audio);
+    if (io->seek(io->handle, pos, SEEK_SET) != 0)
+        return SEAL_BAD_AUDIO;
 
     switch (magic_nums[0]) {
     case RIFF:
@@ -65,8 +81,6 @@ seal_recognize_fmt(const char* filename, seal_fmt_t* pfmt)
         return SEAL_OK;
     }
 
-    *pfmt = SEAL_UNKNOWN_FMT;
-
     return SEAL_BAD_AUDIO;
 }
 
@@ -0,0 +1,169 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <seal/err.h>
+#include <seal/io.h>
+#include "reader.h"
+
+/* A file with an optional read-ahead window owned by a stream. */
+typedef struct file_t
+{
+    FILE*         file;
+    const size_t* readahead;
+} file_t;
+
+/* Read cursor over a block of memory. */
+typedef struct mem_t
+{
+    const unsigned char* data;
+    size_t               size;
+    size_t               pos;
+} mem_t;
+
+static
+size_t
+read_file(void* handle, void* dst, size_t nbytes)
+{
+    file_t* file = handle;
+
+    if (file->readahead != 0)
+        _seal_prefetch(file->file, nbytes + *file->readahead);
+
+    return fread(dst, 1, nbytes, file->file);
+}
+
+static
+int
+seek_file(void* handle, long offset, int whence)
+{
+    return fseek(((file_t*) handle)->file, offset, whence);
+}
+
+static
+long
+tell_file(void* handle)
+{
+    return ftell(((file_t*) handle)->file);
+}
+
+static
+int
+close_file(void* handle)
+{
+    _seal_fclose(((file_t*) handle)->file);
+    free(handle);
+
+    return 0;
+}
+
+static
+size_t
+read_mem(void* handle, void* dst, size_t nbytes)
+{
+    mem_t* mem = handle;
+    size_t nbytes_left = mem->size - mem->pos;
+
+    if (nbytes > nbytes_left)
+        nbytes = nbytes_left;
+    memcpy(dst, mem->data + mem->pos, nbytes);
+    mem->pos += nbytes;
+
+    return nbytes;
+}
+
+static
+int
+seek_mem(void* handle, long offset, int whence)
+{
+    mem_t* mem = handle;
+    long base;
+
+    switch (whence) {
+    case SEEK_SET:
+        base = 0;
+        break;
+    case SEEK_CUR:
+        base = mem->pos;
+        break;
+    case SEEK_END:
+        base = mem->size;
+        break;
+    default:
+        return -1;
+    }
+    /* Seeking past the end is clamped rather than padded. */
+    if (base + offset < 0)
+        return -1;
+    mem->pos = base + offset;
+    if (mem->pos > mem->size)
+        mem->pos = mem->size;
+
+    return 0;
+}
+
+static
+long
+tell_mem(void* handle)
+{
+    return ((mem_t*) handle)->pos;
+}
+
+static
+int
+close_mem(void* handle)
+{
+    free(handle);
+
+    return 0;
+}
+
+seal_err_t
+_seal_open_file_io(seal_io_t* io, const char* filename)
+{
+    return _seal_open_readahead_file_io(io, filename, 0);
+}
+
+seal_err_t
+_seal_open_readahead_file_io(seal_io_t* io, const char* filename,
+                             const size_t* readahead)
+{
+    file_t* file = malloc(sizeof (file_t));
+
+    if (file == 0)
+        return SEAL_CANNOT_ALLOC_MEM;
+    if ((file->file = _seal_fopen(filename)) == 0) {
+        free(file);
+        return SEAL_CANNOT_OPEN_FILE;
+    }
+    file->readahead = readahead;
+    if (readahead != 0)
+        _seal_advise_sequential(file->file);
+
+    io->handle = file;
+    io->read = read_file;
+    io->seek = seek_file;
+    io->tell = tell_file;
+    io->close = close_file;
+
+    return SEAL_OK;
+}
+
+seal_err_t
+_seal_open_mem_io(seal_io_t* io, const void* data, size_t size)
+{
+    mem_t* mem = malloc(sizeof (mem_t));
+
+    if (mem == 0)
+        return SEAL_CANNOT_ALLOC_MEM;
+    mem->data = data;
+    mem->size = size;
+    mem->pos = 0;
+
+    io->handle = mem;
+    io->read = read_mem;
+    io->seek = seek_mem;
+    io->tell = tell_mem;
+    io->close = close_mem;
+
+    return SEAL_OK;
+}
@@ -1,102 +1,139 @@
+#include <string.h>
 #include <al/al.h>
 #include <seal/listener.h>
+#include <seal/context.h>
 #include <seal/err.h>
+#include "batch.h"
+
+/*
+ * The listener of each context keeps copies of the properties last set, so
+ * that reading or integrating them never has to go through OpenAL.
+ */
 
 static
 seal_err_t
 setf(int key, float val)
 {
+    if (_seal_defer_write(alListenerf, 0, key, _SEAL_DEFERRED_LISTENER_F,
+                          &val))
+        return SEAL_OK;
     alListenerf(key, val);
 
-    return _seal_get_openal_err();
+    return _seal_get_openal_prop_err();
 }
 
 static
 seal_err_t
 set3f(int key, float x, float y, float z)
 {
+    float vals[3];
+
+    vals[0] = x;
+    vals[1] = y;
+    vals[2] = z;
+    if (_seal_defer_write(alListener3f, 0, key, _SEAL_DEFERRED_LISTENER_3F,
+                          vals))
+        return SEAL_OK;
     alListener3f(key, x, y, z);
 
-    return _seal_get_openal_err();
+    return _seal_get_openal_prop_err();
 }
 
 static
 seal_err_t
 setfv(int key, float* vector)
 {
+    if (_seal_defer_write(alListenerfv, 0, key, _SEAL_DEFERRED_LISTENER_FV,
+                          vector))
+        return SEAL_OK;
     alListenerfv(key, vector);
 
-    return _seal_get_openal_err();
+    return _seal_get_openal_prop_err();
 }
 
+/* Sets a shadowed vector property and updates the copy on success. */
 static
 seal_err_t
-getf(int key, float* pval)
+set_shadowed3f(int key, float* vals, float x, float y, float z)
 {
-    alGetListenerf(key, pval);
+    seal_err_t err = set3f(key, x, y, z);
+
+    if (err == SEAL_OK) {
+        vals[0] = x;
+        vals[1] = y;
+        vals[2] = z;
+    }
 
-    return _seal_get_openal_err();
+    return err;
 }
 
 static
-seal_err_t
-get3f(int key, float* px, float* py, float* pz)
+void
+get3f(const float* vals, float* px, float* py, float* pz)
 {
-    alGetListener3f(key, px, py, pz);
-
-    return _seal_get_openal_err();
+    *px = vals[0];
+    *py = vals[1];
+    *pz = vals[2];
 }
 
 static
 seal_err_t
 getfv(int key, float* vector)
 {
+    _seal_flush_batch();
     alGetListenerfv(key, vector);
 
-    return _seal_get_openal_err();
+    return _seal_get_openal_prop_err();
 }
 
 seal_err_t
 SEAL_API
 seal_move_listener(void)
 {
-    seal_err_t err;
-    float pos[3], vel[3];
+    const float* pos = _seal_get_context()->listener_pos;
+    const float* vel = _seal_get_context()->listener_vel;
 
-    if ((err = seal_get_listener_pos(pos, pos + 1, pos + 2)) != SEAL_OK)
-        return err;
-    if ((err = seal_get_listener_vel(vel, vel + 1, vel + 2)) != SEAL_OK)
-        return err;
-    err = seal_set_listener_pos(
+    return seal_set_listener_pos(
         pos[0] + vel[0],
         pos[1] + vel[1],
         pos[2] + vel[2]
     );
-    if (err != SEAL_OK)
-        return err;
-
-    return SEAL_OK;
 }
 
 seal_err_t
 SEAL_API
-seal_set_listener_gain(float gain)
+seal_set_listener_gain(float val)
 {
-    return setf(AL_GAIN, gain);
+    seal_err_t err;
+
+    if (!(val >= 0))
+        return SEAL_BAD_VAL;
+    if ((err = setf(AL_GAIN, val)) == SEAL_OK)
+        _seal_get_context()->listener_gain = val;
+
+    return err;
 }
 
 seal_err_t
 SEAL_API
 seal_set_listener_pos(float x, float y, float z)
 {
-    return set3f(AL_POSITION, x, y, z);
+    return set_shadowed3f(
+        AL_POSITION,
+        _seal_get_context()->listener_pos,
+        x, y, z
+    );
 }
 
 seal_err_t
 SEAL_API
 seal_set_listener_vel(float x, float y, float z)
 {
-    return set3f(AL_VELOCITY, x, y, z);
+    return set_shadowed3f(
+        AL_VELOCITY,
+        _seal_get_context()->listener_vel,
+        x, y, z
+    );
 }
 
 seal_err_t
@@ -110,21 +147,27 @@ seal_err_t
 SEAL_API
 seal_get_listener_gain(float* pgain)
 {
-    return getf(AL_GAIN, pgain);
+    *pgain = _seal_get_context()->listener_gain;
+
+    return SEAL_OK;
 }
 
 seal_err_t
 SEAL_API
 seal_get_listener_pos(float* px, float* py, float* pz)
 {
-    return get3f(AL_POSITION, px, py, pz);
+    get3f(_seal_get_context()->listener_pos, px, py, pz);
+
+    return SEAL_OK;
 }
 
 seal_err_t
 SEAL_API
 seal_get_listener_vel(float* px, float* py, float* pz)
 {
-    return get3f(AL_VELOCITY, px, py, pz);
+    get3f(_seal_get_context()->listener_vel, px, py, pz);
+
+    return SEAL_OK;
 }
 
 seal_err_t
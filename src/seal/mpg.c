@@ -1,29 +1,107 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <stddef.h>
 #include <mpg123/mpg123.h>
 #include <seal/raw.h>
 #include <seal/stream.h>
+#include <seal/io.h>
+#include <seal/core.h>
 #include <seal/err.h>
+#include "threading.h"
 #include "mpg.h"
 
 /* Initial buffer size for loading. */
 static const int INITIAL_BUF_SIZE = 32768;
 
+/* libmpg123 is only initialized once some MPEG audio is opened. */
+static char initialized = 0;
 
+/* Initializes libmpg123 (thread-unsafe itself) on first use. */
+static
+int
+init_lib(void)
+{
+    int err = MPG123_OK;
+
+    _seal_lock_lazy_init();
+    if (!initialized) {
+        err = mpg123_init();
+        initialized = err == MPG123_OK;
+    }
+    _seal_unlock_lazy_init();
+
+    return err;
+}
+
+static
+size_t
+read_io(void* handle, void* dst, size_t nbytes)
+{
+    seal_io_t* io = handle;
+
+    return io->read(io->handle, dst, nbytes);
+}
+
+static
+off_t
+seek_io(void* handle, off_t offset, int whence)
+{
+    seal_io_t* io = handle;
+
+    if (io->seek(io->handle, offset, whence) != 0)
+        return -1;
+
+    return io->tell(io->handle);
+}
+
+static
+void
+cleanup_io(void* handle)
+{
+    seal_io_t* io = handle;
+
+    io->close(io->handle);
+    free(io);
+}
+
+/*
+ * Takes the ownership of `io' whether or not it succeeds; `io' will be
+ * closed when the returned handle is deleted.
+ */
 static
 mpg123_handle*
-setup(seal_raw_attr_t* attr, const char* filename)
+setup(seal_raw_attr_t* attr, seal_io_t* io)
 {
     mpg123_handle* mh;
+    seal_io_t* mpg;
     long freq;
     int encoding;
 
+    if (init_lib() != MPG123_OK) {
+        io->close(io->handle);
+        return 0;
+    }
+    mpg = malloc(sizeof (seal_io_t));
+    if (mpg == 0) {
+        io->close(io->handle);
+        return 0;
+    }
+    *mpg = *io;
+
     /* Use the default decoder. */
     mh = mpg123_new(0, 0);
-    if (mh == 0)
+    if (mh == 0) {
+        cleanup_io(mpg);
         return 0;
+    }
 
-    if (mpg123_open(mh, filename) != MPG123_OK)
+    if (mpg123_replace_reader_handle(mh, read_io, seek_io, cleanup_io)
+        != MPG123_OK) {
+        cleanup_io(mpg);
+        goto cleanup;
+    }
+    /* From here on `mpg' is owned by `mh'. */
+    if (mpg123_open_handle(mh, mpg) != MPG123_OK)
         goto cleanup;
 
 #ifndef NDEBUG
@@ -39,7 +117,7 @@ setup(seal_raw_attr_t* attr, const char* filename)
     return mh;
 
 cleanup:
-    mpg123_close(mh);
+    mpg123_delete(mh);
 
     return 0;
 }
@@ -73,6 +151,10 @@ load(seal_raw_t* raw, mpg123_handle* mh)
         return err;
 
     do {
+        if (_seal_is_canceled()) {
+            err = SEAL_CANCELED;
+            goto cleanup;
+        }
         if ((err = seal_ensure_raw_data_size(raw, nbytes_loaded)) != SEAL_OK)
             goto cleanup;
     } while (read(raw, &nbytes_loaded, mh) == MPG123_OK);
@@ -93,31 +175,44 @@ cleanup:
 }
 
 seal_err_t
-_seal_load_mpg(seal_raw_t* raw, const char* filename)
+_seal_load_mpg(seal_raw_t* raw, seal_io_t* io)
 {
     mpg123_handle* mh;
     seal_raw_t tmp_raw;
     seal_err_t err;
 
-    mh = setup(&tmp_raw.attr, filename);
+    mh = setup(&tmp_raw.attr, io);
     if (mh == 0)
         return SEAL_CANNOT_INIT_MPG;
 
     if ((err = load(&tmp_raw, mh)) == SEAL_OK)
         *raw = tmp_raw;
 
-    mpg123_close(mh);
+    mpg123_delete(mh);
 
     return err;
 }
 
 seal_err_t
 _seal_init_mpg_stream(seal_stream_t* stream, const char* filename)
+{
+    seal_io_t io;
+    seal_err_t err;
+
+    err = _seal_open_readahead_file_io(&io, filename, &stream->readahead);
+    if (err != SEAL_OK)
+        return err;
+
+    return _seal_init_mpg_stream_io(stream, &io);
+}
+
+seal_err_t
+_seal_init_mpg_stream_io(seal_stream_t* stream, seal_io_t* io)
 {
     mpg123_handle* mh;
     seal_raw_attr_t tmp_attr;
 
-    mh = setup(&tmp_attr, filename);
+    mh = setup(&tmp_attr, io);
     if (mh == 0)
         return SEAL_CANNOT_INIT_MPG;
 
@@ -129,28 +224,42 @@ _seal_init_mpg_stream(seal_stream_t* stream, const char* filename)
 }
 
 seal_err_t
-_seal_stream_mpg(seal_stream_t* stream, seal_raw_t* raw, size_t* psize)
+_seal_stream_mpg_into(seal_stream_t* stream, seal_raw_t* raw, size_t* psize)
 {
-    seal_raw_t tmp_raw;
     int mpg123_err;
     size_t nbytes_streamed = 0;
+
+    do {
+        if (_seal_is_canceled())
+            return SEAL_CANCELED;
+        mpg123_err = read(raw, &nbytes_streamed, stream->id);
+    } while (mpg123_err == MPG123_OK && nbytes_streamed < raw->size);
+
+    if (nbytes_streamed == 0 && mpg123_err != MPG123_DONE)
+        return SEAL_CANNOT_READ_MPG;
+    *psize = nbytes_streamed;
+
+    return SEAL_OK;
+}
+
+seal_err_t
+_seal_stream_mpg(seal_stream_t* stream, seal_raw_t* raw, size_t* psize)
+{
+    seal_raw_t tmp_raw;
     seal_err_t err;
 
     if ((err = seal_alloc_raw_data(&tmp_raw, raw->size)) != SEAL_OK)
         return err;
 
-    do mpg123_err = read(&tmp_raw, &nbytes_streamed, stream->id);
-    while (mpg123_err == MPG123_OK && nbytes_streamed < tmp_raw.size);
-
-    if (nbytes_streamed == 0 && mpg123_err != MPG123_DONE) {
+    err = _seal_stream_mpg_into(stream, &tmp_raw, psize);
+    if (err != SEAL_OK || *psize == 0) {
         seal_free_raw_data(&tmp_raw);
-        return SEAL_CANNOT_READ_MPG;
+        return err;
     }
 
     raw->data = tmp_raw.data;
-    raw->size = nbytes_streamed;
+    raw->size = *psize;
     raw->attr = stream->attr;
-    *psize = nbytes_streamed;
 
     return SEAL_OK;
 }
@@ -168,5 +277,26 @@ _seal_close_mpg_stream(seal_stream_t* stream)
 {
     if (mpg123_close(stream->id) != MPG123_OK)
         return SEAL_CANNOT_CLOSE_MPG;
+    mpg123_delete(stream->id);
+
     return SEAL_OK;
 }
+
+size_t
+_seal_get_mpg_stream_nframes(seal_stream_t* stream)
+{
+    off_t nframes = mpg123_length(stream->id);
+
+    return nframes > 0 ? (size_t) nframes : 0;
+}
+
+void
+_seal_cleanup_mpg(void)
+{
+    _seal_lock_lazy_init();
+    if (initialized) {
+        mpg123_exit();
+        initialized = 0;
+    }
+    _seal_unlock_lazy_init();
+}
@@ -10,11 +10,33 @@
 #include <seal/raw.h>
 #include <seal/stream.h>
 #include <seal/err.h>
+#include <seal/io.h>
 
-seal_err_t _seal_load_mpg(seal_raw_t*, const char* /*filename*/);
+/*
+ * Takes the ownership of `io' whether or not it succeeds.
+ */
+seal_err_t _seal_load_mpg(seal_raw_t*, seal_io_t*);
 seal_err_t _seal_init_mpg_stream(seal_stream_t*, const char* /*filename*/);
+/*
+ * Takes the ownership of `io' whether or not it succeeds.
+ */
+seal_err_t _seal_init_mpg_stream_io(seal_stream_t*, seal_io_t*);
 seal_err_t _seal_stream_mpg(seal_stream_t*, seal_raw_t*, size_t* /*psize*/);
+seal_err_t _seal_stream_mpg_into(seal_stream_t*, seal_raw_t*,
+                                 size_t* /*psize*/);
 seal_err_t _seal_rewind_mpg_stream(seal_stream_t*);
 seal_err_t _seal_close_mpg_stream(seal_stream_t*);
+/*
+ * @return  the total number of sample frames of an opened stream, which is
+ *          estimated from the bitrate if the file has no Xing or LAME header,
+ *          or 0 if unknown
+ */
+size_t _seal_get_mpg_stream_nframes(seal_stream_t*);
+
+/*
+ * Finalizes libmpg123 if it was initialized, which happens the first time
+ * MPEG audio is opened.
+ */
+void _seal_cleanup_mpg(void);
 
 #endif /* _SEAL_MPG_H_ */
\ No newline at end of file
@@ -1,30 +1,103 @@
+#include <stdio.h>
 #include <stdlib.h>
 #include <vorbis/codec.h>
 #define OV_EXCLUDE_STATIC_CALLBACKS
 #include <vorbis/vorbisfile.h>
 #include <seal/raw.h>
 #include <seal/stream.h>
+#include <seal/io.h>
+#include <seal/core.h>
 #include <seal/err.h>
 #include "ov.h"
-#include "reader.h"
 
 /* Initial buffer size for loading. */
 static const int INITIAL_BUF_SIZE = 4096;
 
+static
+size_t
+read_io(void* dst, size_t size, size_t nmemb, void* datasource)
+{
+    seal_io_t* io = datasource;
+
+    if (size == 0)
+        return 0;
+    return io->read(io->handle, dst, size * nmemb) / size;
+}
+
+static
+int
+seek_io(void* datasource, ogg_int64_t offset, int whence)
+{
+    seal_io_t* io = datasource;
+
+    return io->seek(io->handle, offset, whence);
+}
+
+static
+int
+close_io(void* datasource)
+{
+    seal_io_t* io = datasource;
+    int ret = io->close(io->handle);
+
+    free(io);
+
+    return ret;
+}
+
+static
+long
+tell_io(void* datasource)
+{
+    seal_io_t* io = datasource;
+
+    return io->tell(io->handle);
+}
+
+/*
+ * Opens `ovf' on the heap-allocated `ov', closing `ov' on failure. Without a
+ * seek callback vorbisfile treats the input as unseekable and skips scanning
+ * the whole file for chained links, so decoding can start right away.
+ */
 static
 seal_err_t
-setup(seal_raw_attr_t* attr, OggVorbis_File* ovf, const char* filename)
+open_callbacks(OggVorbis_File* ovf, seal_io_t* ov, int fast)
+{
+    ov_callbacks callbacks;
+
+    callbacks.read_func = read_io;
+    callbacks.seek_func = fast ? 0 : seek_io;
+    callbacks.close_func = close_io;
+    callbacks.tell_func = tell_io;
+    if (ov_open_callbacks(ov, ovf, 0, 0, callbacks) < 0) {
+        close_io(ov);
+        return SEAL_CANNOT_OPEN_OV;
+    }
+
+    return SEAL_OK;
+}
+
+/*
+ * Takes the ownership of `io' whether or not it succeeds; `io' will be
+ * closed by `ov_clear' later on.
+ */
+static
+seal_err_t
+setup(seal_raw_attr_t* attr, OggVorbis_File* ovf, seal_io_t* io, int fast)
 {
     vorbis_info* vi;
-    FILE* ov;
+    seal_io_t* ov;
+    seal_err_t err;
 
-    ov = _seal_fopen(filename);
-    if (ov == 0)
-        return SEAL_CANNOT_OPEN_FILE;
-    if (ov_open(ov, ovf, 0, 0) < 0) {
-        _seal_fclose(ov);
-        return SEAL_CANNOT_OPEN_OV;
+    ov = malloc(sizeof (seal_io_t));
+    if (ov == 0) {
+        io->close(io->handle);
+        return SEAL_CANNOT_ALLOC_MEM;
     }
+    *ov = *io;
+
+    if ((err = open_callbacks(ovf, ov, fast)) != SEAL_OK)
+        return err;
     vi = ov_info(ovf, -1);
     attr->bit_depth = 16;
     attr->nchannels = vi->channels;
@@ -67,6 +140,10 @@ load(seal_raw_t* raw, OggVorbis_File* ovf)
         return err;
 
     do {
+        if (_seal_is_canceled()) {
+            err = SEAL_CANCELED;
+            goto cleanup;
+        }
         if ((err = seal_ensure_raw_data_size(raw, nbytes_loaded)) != SEAL_OK)
             goto cleanup;
         nbytes_read = read(raw, &nbytes_loaded, ovf);
@@ -89,36 +166,39 @@ cleanup:
 }
 
 seal_err_t
-_seal_load_ov(seal_raw_t* raw, const char* filename)
+_seal_load_ov(seal_raw_t* raw, seal_io_t* io)
 {
     seal_raw_t tmp_raw;
     OggVorbis_File ovf;
     seal_err_t err;
 
-    if ((err = setup(&tmp_raw.attr, &ovf, filename)) != SEAL_OK)
+    if ((err = setup(&tmp_raw.attr, &ovf, io, 0)) != SEAL_OK)
         return err;
 
     if ((err = load(&tmp_raw, &ovf)) == SEAL_OK)
         *raw = tmp_raw;
 
-    /* This closes the opened file handle too. */
+    /* This closes `io' too. */
     ov_clear(&ovf);
 
     return err;
 }
 
+static
 seal_err_t
-_seal_init_ov_stream(seal_stream_t* stream, const char* filename)
+init_stream(seal_stream_t* stream, seal_io_t* io, int fast)
 {
     seal_raw_attr_t attr;
     OggVorbis_File* povf;
     seal_err_t err;
 
     povf = malloc(sizeof (OggVorbis_File));
-    if (povf == 0)
+    if (povf == 0) {
+        io->close(io->handle);
         return SEAL_CANNOT_ALLOC_MEM;
+    }
 
-    if ((err = setup(&attr, povf, filename)) != SEAL_OK) {
+    if ((err = setup(&attr, povf, io, fast)) != SEAL_OK) {
         free(povf);
         return err;
     }
@@ -131,33 +211,84 @@ _seal_init_ov_stream(seal_stream_t* stream, const char* filename)
 }
 
 seal_err_t
-_seal_stream_ov(seal_stream_t* stream, seal_raw_t* raw, size_t* psize)
+_seal_init_ov_stream(seal_stream_t* stream, const char* filename)
+{
+    seal_io_t io;
+    seal_err_t err;
+
+    err = _seal_open_readahead_file_io(&io, filename, &stream->readahead);
+    if (err != SEAL_OK)
+        return err;
+
+    return init_stream(stream, &io, seal_is_fast_stream_open());
+}
+
+seal_err_t
+_seal_init_ov_stream_io(seal_stream_t* stream, seal_io_t* io)
+{
+    return init_stream(stream, io, 0);
+}
+
+seal_err_t
+_seal_stream_ov_into(seal_stream_t* stream, seal_raw_t* raw, size_t* psize)
 {
     long nbytes_read;
     unsigned long nbytes_streamed = 0;
+
+    do {
+        if (_seal_is_canceled())
+            return SEAL_CANCELED;
+        nbytes_read = read(raw, &nbytes_streamed, stream->id);
+    } while (nbytes_streamed < raw->size && nbytes_read > 0);
+
+    if (nbytes_read < 0)
+        return SEAL_CANNOT_READ_OV;
+    *psize = nbytes_streamed;
+
+    return SEAL_OK;
+}
+
+seal_err_t
+_seal_stream_ov(seal_stream_t* stream, seal_raw_t* raw, size_t* psize)
+{
     seal_raw_t tmp_raw;
     seal_err_t err;
 
     if ((err = seal_alloc_raw_data(&tmp_raw, raw->size)) != SEAL_OK)
         return err;
 
-    do nbytes_read = read(&tmp_raw, &nbytes_streamed, stream->id);
-    while (nbytes_streamed < tmp_raw.size && nbytes_read > 0);
-
-    if (nbytes_read < 0) {
-        err = SEAL_CANNOT_READ_OV;
+    err = _seal_stream_ov_into(stream, &tmp_raw, psize);
+    if (err != SEAL_OK || *psize == 0) {
         seal_free_raw_data(&tmp_raw);
         return err;
     }
 
-    if (nbytes_streamed != 0) {
-        raw->data = tmp_raw.data;
-        raw->size = nbytes_streamed;
-        raw->attr = stream->attr;
-    } else {
-        seal_free_raw_data(&tmp_raw);
+    raw->data = tmp_raw.data;
+    raw->size = *psize;
+    raw->attr = stream->attr;
+
+    return SEAL_OK;
+}
+
+/*
+ * Fast-opened streams cannot seek, so they are rewound by decoding the file
+ * from the first byte again, which never needs the link structure either.
+ */
+static
+seal_err_t
+reopen(OggVorbis_File* ovf)
+{
+    seal_io_t* ov = ovf->datasource;
+
+    /* Keep `ov' open across `ov_clear'. */
+    ovf->callbacks.close_func = 0;
+    ov_clear(ovf);
+    if (ov->seek(ov->handle, 0, SEEK_SET) != 0) {
+        close_io(ov);
+        return SEAL_CANNOT_REWIND_OV;
     }
-    *psize = nbytes_streamed;
+    if (open_callbacks(ovf, ov, 1) != SEAL_OK)
+        return SEAL_CANNOT_REWIND_OV;
 
     return SEAL_OK;
 }
@@ -165,7 +296,11 @@ _seal_stream_ov(seal_stream_t* stream, seal_raw_t* raw, size_t* psize)
 seal_err_t
 _seal_rewind_ov_stream(seal_stream_t* stream)
 {
-    if (ov_time_seek(stream->id, 0) != 0)
+    OggVorbis_File* ovf = stream->id;
+
+    if (!ov_seekable(ovf))
+        return reopen(ovf);
+    if (ov_time_seek(ovf, 0) != 0)
         return SEAL_CANNOT_REWIND_OV;
     return SEAL_OK;
 }
@@ -179,3 +314,21 @@ _seal_close_ov_stream(seal_stream_t* stream)
     free(stream->id);
     return SEAL_OK;
 }
+
+size_t
+_seal_get_ov_stream_nframes(seal_stream_t* stream)
+{
+    ogg_int64_t nframes;
+
+    if (!ov_seekable(stream->id))
+        return 0;
+    nframes = ov_pcm_total(stream->id, -1);
+
+    return nframes > 0 ? (size_t) nframes : 0;
+}
+
+int
+_seal_is_ov_stream_seekable(seal_stream_t* stream)
+{
+    return ov_seekable(stream->id);
+}
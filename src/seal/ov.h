@@ -8,11 +8,27 @@
 #include <stddef.h>
 #include <seal/raw.h>
 #include <seal/stream.h>
+#include <seal/io.h>
 
-seal_err_t _seal_load_ov(seal_raw_t*, const char* /*filename*/);
+/*
+ * Takes the ownership of `io' whether or not it succeeds.
+ */
+seal_err_t _seal_load_ov(seal_raw_t*, seal_io_t*);
 seal_err_t _seal_init_ov_stream(seal_stream_t*, const char* /*filename*/);
+/*
+ * Takes the ownership of `io' whether or not it succeeds.
+ */
+seal_err_t _seal_init_ov_stream_io(seal_stream_t*, seal_io_t*);
 seal_err_t _seal_stream_ov(seal_stream_t*, seal_raw_t*, size_t* /*psize*/);
+seal_err_t _seal_stream_ov_into(seal_stream_t*, seal_raw_t*,
+                                size_t* /*psize*/);
 seal_err_t _seal_rewind_ov_stream(seal_stream_t*);
 seal_err_t _seal_close_ov_stream(seal_stream_t*);
+/*
+ * @return  the total number of sample frames of an opened stream, or 0 if it
+ *          is not seekable (fast-opened) and thus unknown
+ */
+size_t _seal_get_ov_stream_nframes(seal_stream_t*);
+int _seal_is_ov_stream_seekable(seal_stream_t*);
 
 #endif /* _SEAL_OV_H_ */
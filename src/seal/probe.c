@@ -0,0 +1,329 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <seal/probe.h>
+#include <seal/stream.h>
+#include <seal/fmt.h>
+#include <seal/err.h>
+#include <seal/io.h>
+#include "ov.h"
+#include "mpg.h"
+#include "wav.h"
+#include "reader.h"
+
+/* The first line of manifest files. */
+static const char MANIFEST_MAGIC[] = "seal-manifest 1\n";
+
+enum
+{
+    INITIAL_CAPACITY = 64,
+    MAX_LINE_SIZE    = 4096
+};
+
+typedef struct entry_t
+{
+    char*             path;
+    unsigned long     size;
+    long              mtime;
+    seal_audio_info_t info;
+} entry_t;
+
+/* FNV-1a. */
+static
+size_t
+hash(const char* path)
+{
+    size_t h = 2166136261u;
+
+    while (*path != 0)
+        h = (h ^ (unsigned char) *path++) * 16777619u;
+
+    return h;
+}
+
+/*
+ * Returns the bucket that holds the entry for `path', or the empty bucket the
+ * entry would go to.
+ */
+static
+size_t*
+find_bucket(seal_manifest_t* manifest, const char* path)
+{
+    entry_t* entries = manifest->entries;
+    size_t mask = manifest->nbuckets - 1;
+    size_t i = hash(path) & mask;
+
+    while (manifest->buckets[i] != 0
+           && strcmp(entries[manifest->buckets[i] - 1].path, path) != 0)
+        i = (i + 1) & mask;
+
+    return manifest->buckets + i;
+}
+
+static
+entry_t*
+find_entry(seal_manifest_t* manifest, const char* path)
+{
+    size_t index;
+
+    if (manifest->nentries == 0)
+        return 0;
+    index = *find_bucket(manifest, path);
+
+    return index == 0 ? 0 : (entry_t*) manifest->entries + index - 1;
+}
+
+/* Keeps the hash table at most half full. */
+static
+seal_err_t
+ensure_capacity(seal_manifest_t* manifest)
+{
+    entry_t* entries;
+    size_t* buckets;
+    size_t capacity, i;
+
+    if (manifest->nentries < manifest->capacity)
+        return SEAL_OK;
+
+    capacity = manifest->capacity == 0 ? INITIAL_CAPACITY
+                                       : manifest->capacity * 2;
+    entries = realloc(manifest->entries, capacity * sizeof (entry_t));
+    if (entries == 0)
+        return SEAL_CANNOT_ALLOC_MEM;
+    manifest->entries = entries;
+    buckets = calloc(capacity * 2, sizeof (size_t));
+    if (buckets == 0)
+        return SEAL_CANNOT_ALLOC_MEM;
+
+    free(manifest->buckets);
+    manifest->buckets = buckets;
+    manifest->nbuckets = capacity * 2;
+    manifest->capacity = capacity;
+    for (i = 0; i < manifest->nentries; ++i)
+        *find_bucket(manifest, entries[i].path) = i + 1;
+
+    return SEAL_OK;
+}
+
+static
+seal_err_t
+put_entry(seal_manifest_t* manifest, const char* path, unsigned long size,
+          long mtime, seal_audio_info_t* info)
+{
+    entry_t* entry = find_entry(manifest, path);
+    seal_err_t err;
+
+    if (entry == 0) {
+        char* copy = malloc(strlen(path) + 1);
+
+        if (copy == 0)
+            return SEAL_CANNOT_ALLOC_MEM;
+        if ((err = ensure_capacity(manifest)) != SEAL_OK) {
+            free(copy);
+            return err;
+        }
+        strcpy(copy, path);
+        entry = (entry_t*) manifest->entries + manifest->nentries++;
+        entry->path = copy;
+        *find_bucket(manifest, path) = manifest->nentries;
+    }
+    entry->size = size;
+    entry->mtime = mtime;
+    entry->info = *info;
+
+    return SEAL_OK;
+}
+
+/*
+ * Opens a stream seekable so that the length is known, which fast-opened Ogg
+ * Vorbis streams are not.
+ */
+static
+seal_err_t
+probe_stream(seal_stream_t* stream, const char* filename, seal_fmt_t fmt)
+{
+    seal_io_t io;
+    seal_err_t err;
+
+    if ((err = _seal_open_file_io(&io, filename)) != SEAL_OK)
+        return err;
+
+    return seal_open_stream_io(stream, &io, fmt);
+}
+
+seal_err_t
+SEAL_API
+seal_probe(const char* filename, seal_audio_info_t* info)
+{
+    seal_stream_t stream;
+    seal_fmt_t fmt = SEAL_UNKNOWN_FMT;
+    seal_err_t err;
+
+    if ((err = seal_ensure_fmt_known(filename, &fmt)) != SEAL_OK)
+        return err;
+    if ((err = probe_stream(&stream, filename, fmt)) != SEAL_OK)
+        return err;
+
+    info->fmt = fmt;
+    info->attr = stream.attr;
+    switch (fmt) {
+    case SEAL_WAV_FMT:
+        info->nframes = _seal_get_wav_stream_nframes(&stream);
+        info->seekable = 1;
+        break;
+    case SEAL_OV_FMT:
+        info->nframes = _seal_get_ov_stream_nframes(&stream);
+        info->seekable = _seal_is_ov_stream_seekable(&stream) != 0;
+        break;
+    default:
+        info->nframes = _seal_get_mpg_stream_nframes(&stream);
+        info->seekable = 1;
+    }
+
+    return seal_close_stream(&stream);
+}
+
+seal_err_t
+SEAL_API
+seal_init_manifest(seal_manifest_t* manifest)
+{
+    manifest->entries = 0;
+    manifest->nentries = 0;
+    manifest->capacity = 0;
+    manifest->buckets = 0;
+    manifest->nbuckets = 0;
+
+    return SEAL_OK;
+}
+
+seal_err_t
+SEAL_API
+seal_destroy_manifest(seal_manifest_t* manifest)
+{
+    entry_t* entries = manifest->entries;
+    size_t i;
+
+    for (i = 0; i < manifest->nentries; ++i)
+        free(entries[i].path);
+    free(manifest->entries);
+    free(manifest->buckets);
+
+    return seal_init_manifest(manifest);
+}
+
+seal_err_t
+SEAL_API
+seal_load_manifest(seal_manifest_t* manifest, const char* filename)
+{
+    FILE* file;
+    char* line;
+    seal_err_t err = SEAL_OK;
+
+    if ((file = _seal_fopen(filename)) == 0)
+        return SEAL_OK;
+    line = malloc(MAX_LINE_SIZE);
+    if (line == 0) {
+        err = SEAL_CANNOT_ALLOC_MEM;
+        goto cleanup;
+    }
+    if (fgets(line, MAX_LINE_SIZE, file) == 0
+        || strcmp(line, MANIFEST_MAGIC) != 0)
+        goto cleanup;
+
+    while (fgets(line, MAX_LINE_SIZE, file) != 0) {
+        seal_audio_info_t info;
+        unsigned long size, nframes;
+        long mtime;
+        int fmt, seekable, path_start = 0;
+        size_t len;
+
+        if (sscanf(line, "%d %d %d %d %lu %d %lu %ld %n", &fmt,
+                   &info.attr.bit_depth, &info.attr.nchannels,
+                   &info.attr.freq, &nframes, &seekable, &size, &mtime,
+                   &path_start) < 8 || path_start == 0)
+            continue;
+        len = strlen(line);
+        /* Skip lines cut off by the buffer. */
+        if (len == 0 || line[len - 1] != '\n')
+            continue;
+        line[len - 1] = 0;
+        if (line[path_start] == 0)
+            continue;
+
+        info.fmt = (seal_fmt_t) fmt;
+        info.nframes = nframes;
+        info.seekable = seekable != 0;
+        err = put_entry(manifest, line + path_start, size, mtime, &info);
+        if (err != SEAL_OK)
+            break;
+    }
+
+cleanup:
+    free(line);
+    _seal_fclose(file);
+
+    return err;
+}
+
+seal_err_t
+SEAL_API
+seal_save_manifest(seal_manifest_t* manifest, const char* filename)
+{
+    entry_t* entries = manifest->entries;
+    FILE* file;
+    size_t i;
+    int failed;
+
+    if ((file = _seal_fcreate(filename)) == 0)
+        return SEAL_CANNOT_OPEN_FILE;
+
+    failed = fputs(MANIFEST_MAGIC, file) < 0;
+    for (i = 0; i < manifest->nentries && !failed; ++i) {
+        seal_audio_info_t* info = &entries[i].info;
+
+        failed = fprintf(file, "%d %d %d %d %lu %d %lu %ld %s\n",
+                         (int) info->fmt, info->attr.bit_depth,
+                         info->attr.nchannels, info->attr.freq,
+                         (unsigned long) info->nframes, info->seekable,
+                         entries[i].size, entries[i].mtime,
+                         entries[i].path) < 0;
+    }
+    if (fclose(file) != 0)
+        failed = 1;
+
+    return failed ? SEAL_CANNOT_OPEN_FILE : SEAL_OK;
+}
+
+seal_err_t
+SEAL_API
+seal_probe_cached(seal_manifest_t* manifest, const char* filename,
+                  seal_audio_info_t* info)
+{
+    entry_t* entry;
+    unsigned long size;
+    long mtime;
+    seal_err_t err;
+
+    if (_seal_stat(filename, &size, &mtime) != 0)
+        return SEAL_CANNOT_OPEN_FILE;
+
+    entry = find_entry(manifest, filename);
+    if (entry != 0 && entry->size == size && entry->mtime == mtime) {
+        *info = entry->info;
+        return SEAL_OK;
+    }
+
+    if ((err = seal_probe(filename, info)) != SEAL_OK)
+        return err;
+
+    return put_entry(manifest, filename, size, mtime, info);
+}
+
+seal_err_t
+SEAL_API
+seal_get_manifest_size(seal_manifest_t* manifest, size_t* psize)
+{
+    *psize = manifest->nentries;
+
+    return SEAL_OK;
+}
@@ -1,7 +1,15 @@
 #include <stdlib.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <seal/raw.h>
 #include <seal/err.h>
+#include "resample.h"
+
+#if defined(__SSE2__) || defined(_M_X64) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# include <emmintrin.h>
+# define USE_SSE2
+#endif
 
 /* Reallocates `raw->data' to size `size'. */
 static
@@ -51,3 +59,115 @@ seal_ensure_raw_data_size(seal_raw_t* raw, size_t size)
 
     return SEAL_OK;
 }
+
+seal_err_t
+seal_resample_raw(seal_raw_t* raw, int freq)
+{
+    _seal_resampler_t* resampler;
+    seal_raw_t resampled;
+    seal_err_t err;
+
+    if (raw->attr.freq == freq)
+        return SEAL_OK;
+
+    err = _seal_create_resampler(&resampler, raw->attr.nchannels,
+                                 raw->attr.freq, freq);
+    if (err != SEAL_OK)
+        return err;
+
+    resampled = *raw;
+    err = _seal_resample(resampler, &resampled, 1);
+    _seal_destroy_resampler(resampler);
+    if (err != SEAL_OK)
+        return err;
+
+    free(raw->data);
+    *raw = resampled;
+
+    return SEAL_OK;
+}
+
+/*
+ * Averages each interleaved stereo frame of `src' into `dst', which may alias
+ * `src'. The results are floored so the vector and scalar paths agree.
+ */
+static
+void
+downmix16(int16_t* dst, const int16_t* src, size_t nframes)
+{
+    size_t i = 0;
+
+#ifdef USE_SSE2
+    for (; i + 8 <= nframes; i += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i*) (src + i * 2));
+        __m128i b = _mm_loadu_si128((const __m128i*) (src + i * 2 + 8));
+        /* Sign-extend left samples (low halves) and right samples. */
+        __m128i la = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+        __m128i lb = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+        __m128i ra = _mm_srai_epi32(a, 16);
+        __m128i rb = _mm_srai_epi32(b, 16);
+        __m128i ma = _mm_srai_epi32(_mm_add_epi32(la, ra), 1);
+        __m128i mb = _mm_srai_epi32(_mm_add_epi32(lb, rb), 1);
+
+        _mm_storeu_si128((__m128i*) (dst + i), _mm_packs_epi32(ma, mb));
+    }
+#endif
+    for (; i < nframes; ++i) {
+        long sum = (long) src[i * 2] + src[i * 2 + 1] + 65536;
+        dst[i] = (int16_t) ((sum >> 1) - 32768);
+    }
+}
+
+static
+void
+downmix8(uint8_t* dst, const uint8_t* src, size_t nframes)
+{
+    size_t i = 0;
+
+#ifdef USE_SSE2
+    __m128i mask = _mm_set1_epi16(0xff);
+
+    for (; i + 16 <= nframes; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i*) (src + i * 2));
+        __m128i b = _mm_loadu_si128((const __m128i*) (src + i * 2 + 16));
+        __m128i ma = _mm_srli_epi16(_mm_add_epi16(_mm_and_si128(a, mask),
+                                                  _mm_srli_epi16(a, 8)), 1);
+        __m128i mb = _mm_srli_epi16(_mm_add_epi16(_mm_and_si128(b, mask),
+                                                  _mm_srli_epi16(b, 8)), 1);
+
+        _mm_storeu_si128((__m128i*) (dst + i), _mm_packus_epi16(ma, mb));
+    }
+#endif
+    for (; i < nframes; ++i)
+        dst[i] = (uint8_t) ((src[i * 2] + src[i * 2 + 1]) >> 1);
+}
+
+seal_err_t
+seal_downmix_raw(seal_raw_t* raw)
+{
+    size_t nframes;
+
+    if (raw->attr.nchannels != 2)
+        return SEAL_OK;
+
+    switch (raw->attr.bit_depth) {
+    case 8:
+        nframes = raw->size / 2;
+        downmix8(raw->data, raw->data, nframes);
+        break;
+    case 16:
+        nframes = raw->size / 4;
+        downmix16(raw->data, raw->data, nframes);
+        break;
+    default:
+        return SEAL_BAD_AUDIO;
+    }
+
+    raw->attr.nchannels = 1;
+    raw->size = nframes * (raw->attr.bit_depth / 8);
+    /* A failed shrink leaves the larger block in place, which is harmless. */
+    if (raw->size > 0)
+        realloc_raw_data(raw, raw->size);
+
+    return SEAL_OK;
+}
@@ -1,9 +1,13 @@
 #ifdef _WIN32
 # include <Windows.h>
+#elif defined (__unix__) || defined (__APPLE_CC__)
+# include <fcntl.h>
 #endif
 #include <stdio.h>
 #include <stdint.h>
 #include <stddef.h>
+#include <sys/types.h>
+#include <sys/stat.h>
 #include <seal/err.h>
 #include "reader.h"
 
@@ -49,47 +53,132 @@ _seal_fclose(FILE* file)
     fclose(file);
 }
 
+FILE*
+_seal_fcreate(const char* filename)
+{
+    FILE* file;
+
+#ifdef _WIN32
+    wchar_t wfilename[260];
+    MultiByteToWideChar(CP_UTF8, 0, filename, -1, wfilename, 260);
+    file = _wfopen(wfilename, L"wb");
+#else
+    file = fopen(filename, "wb");
+#endif
+
+    return file;
+}
+
+int
+_seal_stat(const char* filename, unsigned long* psize, long* pmtime)
+{
+#ifdef _WIN32
+    wchar_t wfilename[260];
+    struct _stat st;
+
+    MultiByteToWideChar(CP_UTF8, 0, filename, -1, wfilename, 260);
+    if (_wstat(wfilename, &st) != 0)
+        return -1;
+#else
+    struct stat st;
+
+    if (stat(filename, &st) != 0)
+        return -1;
+#endif
+    *psize = (unsigned long) st.st_size;
+    *pmtime = (long) st.st_mtime;
+
+    return 0;
+}
+
+void
+_seal_advise_sequential(FILE* file)
+{
+#if defined (POSIX_FADV_SEQUENTIAL)
+    posix_fadvise(fileno(file), 0, 0, POSIX_FADV_SEQUENTIAL);
+#else
+    (void) file;
+#endif
+}
+
+void
+_seal_prefetch(FILE* file, size_t nbytes)
+{
+#if defined (POSIX_FADV_WILLNEED) || defined (F_RDADVISE)
+    long pos;
+
+    if (nbytes == 0 || (pos = ftell(file)) < 0)
+        return;
+# if defined (POSIX_FADV_WILLNEED)
+    posix_fadvise(fileno(file), pos, nbytes, POSIX_FADV_WILLNEED);
+# else
+    {
+        struct radvisory advisory;
+
+        advisory.ra_offset = pos;
+        advisory.ra_count = nbytes > INT32_MAX ? INT32_MAX : (int) nbytes;
+        fcntl(fileno(file), F_RDADVISE, &advisory);
+    }
+# endif
+#else
+    /* Windows reads ahead on its own for sequentially read handles. */
+    (void) file;
+    (void) nbytes;
+#endif
+}
+
 /*
- * A template for the following two functions. All arguments except `FILE'
- * will have multiple evaluations in one call.
+ * A template for the following two functions. All arguments except `io' will
+ * have multiple evaluations in one call.
  */
-#define READ_UINT_LE(nbits, buf, size, file) do                             \
+#define READ_UINT_LE(nbits, buf, size, io) do                               \
 {                                                                           \
     size_t _i_;                                                             \
                                                                             \
-    fread((buf), sizeof (uint##nbits##_t), (size), (file));                 \
+    nread = (io)->read((io)->handle, (buf),                                 \
+                       sizeof (uint##nbits##_t) * (size))                   \
+            / sizeof (uint##nbits##_t);                                     \
     for (_i_ = 0; _i_ < (size); ++_i_) {                                    \
         *(buf) = raw2le##nbits((uint8_t*) (buf));                           \
         ++(buf);                                                            \
     }                                                                       \
 } while (0)
 
-void
-_seal_read_uint16le(uint16_t* buf, size_t size, void* file)
+size_t
+_seal_read_uint16le(uint16_t* buf, size_t size, seal_io_t* io)
 {
-    READ_UINT_LE(16, buf, size, file);
+    size_t nread;
+
+    READ_UINT_LE(16, buf, size, io);
+
+    return nread;
 }
 
-void
-_seal_read_uint32le(uint32_t* buf, size_t size, void* file)
+size_t
+_seal_read_uint32le(uint32_t* buf, size_t size, seal_io_t* io)
 {
-    READ_UINT_LE(32, buf, size, file);
+    size_t nread;
+
+    READ_UINT_LE(32, buf, size, io);
+
+    return nread;
 }
 
 /*
  * Use of static variable avoids the overhead brought by dynamic memory
- * allocations and deallocations. Microsoft's implementation of fseek flushes
- * the buffer, which is evil and why fread is used here.
+ * allocations and deallocations. Not every I/O object can seek, and
+ * Microsoft's implementation of fseek flushes the buffer, which is evil and
+ * why reading is used here.
  */
 void
-_seal_skip(uint32_t nbytes, void* file)
+_seal_skip(uint32_t nbytes, seal_io_t* io)
 {
     uint32_t i;
     static uint8_t junk[JUNK_BUF_SIZE];
 
     for (i = JUNK_BUF_SIZE; i <= nbytes; i += JUNK_BUF_SIZE)
-        fread(junk, 1, JUNK_BUF_SIZE, file);
+        io->read(io->handle, junk, JUNK_BUF_SIZE);
     nbytes %= JUNK_BUF_SIZE;
     if (nbytes > 0)
-        fread(junk, 1, nbytes, file);
+        io->read(io->handle, junk, nbytes);
 }
@@ -8,6 +8,7 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <stdio.h>
+#include <seal/io.h>
 
 /* Makes a 32-bit tag in little-endian. No multiple evaluations. */
 #define SEAL_MKTAG(a, b, c, d) ((a) | (b) << 8 | (c) << 16 | (d) << 24)
@@ -21,35 +22,77 @@
  */
 FILE* _seal_fopen(const char* /*filename*/);
 
+/*
+ * Same as `_seal_fopen' except that the file is created or truncated for
+ * writing.
+ *
+ * @param filename  the filename to open
+ * @return          the opened file pointer
+ */
+FILE* _seal_fcreate(const char* /*filename*/);
+
 /*
  * @param file      the file pointer to close
  */
 void _seal_fclose(FILE*);
 
+/*
+ * Gets the size and last modification time of a file without opening it.
+ * Processes filename encoding the same way as `_seal_fopen'.
+ *
+ * @param filename  the filename of the file
+ * @param psize     the receiver of the size, in bytes
+ * @param pmtime    the receiver of the modification time, in seconds since
+ *                  the epoch
+ * @return          0 if successful or otherwise -1
+ */
+int _seal_stat(const char* /*filename*/, unsigned long* /*psize*/,
+               long* /*pmtime*/);
+
+/*
+ * Hints the OS that a file will be read sequentially so that it reads ahead
+ * more aggressively. Does nothing where no such hint exists.
+ *
+ * @param file      the file pointer to hint about
+ */
+void _seal_advise_sequential(FILE*);
+
+/*
+ * Asks the OS to start reading the next `nbytes' bytes of a file into the
+ * page cache in the background, so that the reads that follow do not block
+ * on the disk. Does nothing where no such hint exists.
+ *
+ * @param file      the file pointer to prefetch from
+ * @param nbytes    the number of bytes from the current position to prefetch
+ */
+void _seal_prefetch(FILE*, size_t /*nbytes*/);
+
 /*
  * Reads unsigned 16-bit integers in little-endian.
  *
  * @param buf       the array of integers to receive the data
  * @param size      the size of the array
- * @param file      the file input stream
+ * @param io        the I/O object to read from
+ * @return          the number of integers read
  */
-void _seal_read_uint16le(uint16_t* /*buf*/, size_t, void* /*file*/);
+size_t _seal_read_uint16le(uint16_t* /*buf*/, size_t, seal_io_t*);
 
 /*
  * Reads unsigned 32-bit integers in little-endian.
  *
  * @param buf       the array of integers to receive the data
  * @param size      the size of the array
- * @param file      the file input stream
+ * @param io        the I/O object to read from
+ * @return          the number of integers read
  */
-void _seal_read_uint32le(uint32_t* /*buf*/, size_t, void* /*file*/);
+size_t _seal_read_uint32le(uint32_t* /*buf*/, size_t, seal_io_t*);
 
 /*
  * Skips `nbytes' bytes (seek forward).
  *
  * @param nbytes    the number of bytes to skip
- * @param file      the file input stream
+ * @param io        the I/O object to read from
  */
-void _seal_skip(uint32_t /*nbytes*/, void* /*file*/);
+void _seal_skip(uint32_t /*nbytes*/, seal_io_t*);
 
 #endif /* _SEAL_READER_H_ */
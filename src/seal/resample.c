@@ -0,0 +1,361 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <seal/raw.h>
+#include <seal/err.h>
+#include "resample.h"
+
+#if defined(__SSE__) || defined(_M_X64) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+# include <xmmintrin.h>
+# define USE_SSE
+#endif
+
+enum
+{
+    /* Zero crossings of the sinc on each side when not downsampling. */
+    NZERO_CROSSINGS = 16,
+    /* Beyond this many phases, adjacent phases are interpolated instead. */
+    MAX_NPHASES     = 1024,
+    MAX_NCHANNELS   = 2
+};
+
+static const double PI = 3.14159265358979323846;
+/* Fraction of the Nyquist frequency kept by the low-pass filter. */
+static const double PASSBAND = 0.94;
+/* Kaiser window shape; about 80dB of stopband attenuation. */
+static const double KAISER_BETA = 8.0;
+
+struct _seal_resampler_t
+{
+    int    nchannels;
+    int    in_freq;
+    int    out_freq;
+    /* Reduced ratio; output frames advance the input by `step'/`nphases'. */
+    size_t interp;
+    size_t step;
+    /* Filter length and table of `nphases' + 1 filters. */
+    int    ntaps;
+    size_t nphases;
+    float* filters;
+    /* Planar input frames, the first `ntaps' / 2 - 1 of them being history. */
+    float* frames[MAX_NCHANNELS];
+    size_t nframes;
+    size_t capacity;
+    /* Position of the next output: input frame index plus a fraction in
+     * units of 1 / `interp'. */
+    size_t base;
+    size_t acc;
+};
+
+static
+size_t
+gcd(size_t a, size_t b)
+{
+    while (b != 0) {
+        size_t t = a % b;
+        a = b;
+        b = t;
+    }
+
+    return a;
+}
+
+/* Zeroth-order modified Bessel function of the first kind. */
+static
+double
+bessel_i0(double x)
+{
+    double sum = 1, term = 1;
+    int k;
+
+    for (k = 1; k < 32; ++k) {
+        term *= (x / (2 * k)) * (x / (2 * k));
+        sum += term;
+    }
+
+    return sum;
+}
+
+static
+void
+build_filters(_seal_resampler_t* resampler, double cutoff)
+{
+    int half = resampler->ntaps / 2;
+    double i0_beta = bessel_i0(KAISER_BETA);
+    size_t p;
+    int k;
+
+    for (p = 0; p <= resampler->nphases; ++p) {
+        float* filter = resampler->filters + p * resampler->ntaps;
+        double frac = (double) p / resampler->nphases;
+        double sum = 0;
+
+        for (k = 0; k < resampler->ntaps; ++k) {
+            double t = k - (half - 1) - frac;
+            double w = t / half;
+            double h = cutoff;
+
+            if (t != 0)
+                h = sin(PI * cutoff * t) / (PI * t);
+            h *= w * w < 1 ? bessel_i0(KAISER_BETA * sqrt(1 - w * w))
+                             / i0_beta : 0;
+            filter[k] = h;
+            sum += h;
+        }
+        /* Unity gain at DC for every phase. */
+        for (k = 0; k < resampler->ntaps; ++k)
+            filter[k] /= sum;
+    }
+}
+
+static
+float
+dot(const float* x, const float* h, int n)
+{
+#ifdef USE_SSE
+    __m128 acc = _mm_setzero_ps();
+    float lanes[4];
+    int i;
+
+    /* `n' is always a multiple of 4. */
+    for (i = 0; i < n; i += 4)
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(x + i),
+                                         _mm_loadu_ps(h + i)));
+    _mm_storeu_ps(lanes, acc);
+
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#else
+    float acc = 0;
+    int i;
+
+    for (i = 0; i < n; ++i)
+        acc += x[i] * h[i];
+
+    return acc;
+#endif
+}
+
+static
+seal_err_t
+reserve(_seal_resampler_t* resampler, size_t nframes)
+{
+    int c;
+
+    if (nframes <= resampler->capacity)
+        return SEAL_OK;
+
+    for (c = 0; c < resampler->nchannels; ++c) {
+        float* frames = realloc(resampler->frames[c],
+                                nframes * sizeof (float));
+        if (frames == 0)
+            return SEAL_CANNOT_ALLOC_MEM;
+        resampler->frames[c] = frames;
+    }
+    resampler->capacity = nframes;
+
+    return SEAL_OK;
+}
+
+/* Appends interleaved PCM samples (or silence if `data' is 0). */
+static
+seal_err_t
+append(_seal_resampler_t* resampler, const void* data, size_t nframes,
+       int bit_depth)
+{
+    int nchannels = resampler->nchannels;
+    size_t i;
+    int c;
+    seal_err_t err;
+
+    if ((err = reserve(resampler, resampler->nframes + nframes)) != SEAL_OK)
+        return err;
+
+    for (c = 0; c < nchannels; ++c) {
+        float* dst = resampler->frames[c] + resampler->nframes;
+
+        if (data == 0)
+            memset(dst, 0, nframes * sizeof (float));
+        else if (bit_depth == 8)
+            for (i = 0; i < nframes; ++i)
+                dst[i] = (((const uint8_t*) data)[i * nchannels + c] - 128)
+                         * 256.0f;
+        else
+            for (i = 0; i < nframes; ++i)
+                dst[i] = ((const int16_t*) data)[i * nchannels + c];
+    }
+    resampler->nframes += nframes;
+
+    return SEAL_OK;
+}
+
+static
+void
+store(void* data, size_t i, float sample, int bit_depth)
+{
+    long quantized;
+
+    sample = sample < 0 ? sample - 0.5f : sample + 0.5f;
+    if (sample > 32767)
+        sample = 32767;
+    else if (sample < -32768)
+        sample = -32768;
+    quantized = (long) sample;
+
+    if (bit_depth == 8)
+        ((uint8_t*) data)[i] = (uint8_t) ((quantized >> 8) + 128);
+    else
+        ((int16_t*) data)[i] = (int16_t) quantized;
+}
+
+seal_err_t
+_seal_create_resampler(_seal_resampler_t** presampler, int nchannels,
+                       int in_freq, int out_freq)
+{
+    _seal_resampler_t* resampler;
+    double ratio;
+    size_t divisor;
+    int half;
+
+    if (nchannels < 1 || nchannels > MAX_NCHANNELS
+        || in_freq <= 0 || out_freq <= 0)
+        return SEAL_BAD_VAL;
+
+    resampler = calloc(1, sizeof (_seal_resampler_t));
+    if (resampler == 0)
+        return SEAL_CANNOT_ALLOC_MEM;
+
+    divisor = gcd(in_freq, out_freq);
+    resampler->nchannels = nchannels;
+    resampler->in_freq = in_freq;
+    resampler->out_freq = out_freq;
+    resampler->interp = out_freq / divisor;
+    resampler->step = in_freq / divisor;
+    resampler->nphases = resampler->interp < MAX_NPHASES
+                         ? resampler->interp : MAX_NPHASES;
+
+    /* Widen the filter when downsampling to lower the cutoff. */
+    ratio = (double) out_freq / in_freq;
+    if (ratio > 1)
+        ratio = 1;
+    half = (int) ceil(NZERO_CROSSINGS / ratio);
+    resampler->ntaps = (half + 1) / 2 * 4;
+
+    resampler->filters = malloc(sizeof (float) * resampler->ntaps
+                                * (resampler->nphases + 1));
+    if (resampler->filters == 0) {
+        free(resampler);
+        return SEAL_CANNOT_ALLOC_MEM;
+    }
+    build_filters(resampler, ratio * PASSBAND);
+    _seal_reset_resampler(resampler);
+    *presampler = resampler;
+
+    return SEAL_OK;
+}
+
+void
+_seal_destroy_resampler(_seal_resampler_t* resampler)
+{
+    int c;
+
+    for (c = 0; c < resampler->nchannels; ++c)
+        free(resampler->frames[c]);
+    free(resampler->filters);
+    free(resampler);
+}
+
+void
+_seal_reset_resampler(_seal_resampler_t* resampler)
+{
+    resampler->nframes = 0;
+    resampler->acc = 0;
+    /* Pretend there was silence before the signal. */
+    resampler->base = resampler->ntaps / 2 - 1;
+    append(resampler, 0, resampler->base, 16);
+}
+
+int
+_seal_resampler_fits(_seal_resampler_t* resampler, seal_raw_attr_t* attr,
+                     int out_freq)
+{
+    return resampler->nchannels == attr->nchannels
+           && resampler->in_freq == attr->freq
+           && resampler->out_freq == out_freq;
+}
+
+seal_err_t
+_seal_resample(_seal_resampler_t* resampler, seal_raw_t* raw, int flush)
+{
+    int nchannels = resampler->nchannels;
+    int bit_depth = raw->attr.bit_depth == 8 ? 8 : 16;
+    int half = resampler->ntaps / 2;
+    size_t frame_size = nchannels * (bit_depth / 8);
+    size_t nframes_in = raw->size / frame_size;
+    size_t nframes_out, max_nframes_out, end, history;
+    void* data;
+    seal_err_t err;
+
+    err = append(resampler, raw->data, nframes_in, bit_depth);
+    if (err != SEAL_OK)
+        return err;
+    if (flush && (err = append(resampler, 0, half, bit_depth)) != SEAL_OK)
+        return err;
+
+    /* The last output needs input frames up to `base' + `half'. */
+    end = resampler->nframes > (size_t) half
+          ? resampler->nframes - half : 0;
+    max_nframes_out = end > resampler->base
+                      ? (size_t) ((uint64_t) (end - resampler->base)
+                                  * resampler->interp / resampler->step + 1)
+                      : 0;
+    data = malloc(max_nframes_out * frame_size + 1);
+    if (data == 0)
+        return SEAL_CANNOT_ALLOC_MEM;
+
+    for (nframes_out = 0; resampler->base < end; ++nframes_out) {
+        size_t scaled = resampler->acc * resampler->nphases;
+        size_t phase = scaled / resampler->interp;
+        float t = (float) (scaled % resampler->interp) / resampler->interp;
+        const float* filter = resampler->filters + phase * resampler->ntaps;
+        size_t first = resampler->base - (half - 1);
+        int c;
+
+        for (c = 0; c < nchannels; ++c) {
+            const float* x = resampler->frames[c] + first;
+            float y = dot(x, filter, resampler->ntaps);
+
+            /* Only when there are fewer phases than the ratio needs. */
+            if (t != 0)
+                y += (dot(x, filter + resampler->ntaps, resampler->ntaps) - y)
+                     * t;
+            store(data, nframes_out * nchannels + c, y, bit_depth);
+        }
+
+        resampler->acc += resampler->step;
+        resampler->base += resampler->acc / resampler->interp;
+        resampler->acc %= resampler->interp;
+    }
+
+    /* Keep the history needed by the next output. */
+    history = resampler->base - (half - 1);
+    if (history > resampler->nframes)
+        history = resampler->nframes;
+    if (history > 0) {
+        int c;
+
+        for (c = 0; c < nchannels; ++c)
+            memmove(resampler->frames[c], resampler->frames[c] + history,
+                    (resampler->nframes - history) * sizeof (float));
+        resampler->nframes -= history;
+        resampler->base -= history;
+    }
+
+    raw->data = data;
+    raw->size = nframes_out * frame_size;
+    raw->attr.freq = resampler->out_freq;
+    raw->attr.bit_depth = bit_depth;
+
+    return SEAL_OK;
+}
@@ -0,0 +1,55 @@
+/*
+ * A polyphase windowed-sinc resampler used to convert audio to the mixing
+ * frequency of the device once, instead of having OpenAL resample every
+ * voice on every mix.
+ */
+
+#ifndef _SEAL_RESAMPLE_H_
+#define _SEAL_RESAMPLE_H_
+
+#include <seal/raw.h>
+#include <seal/err.h>
+
+typedef struct _seal_resampler_t _seal_resampler_t;
+
+/*
+ * Creates a resampler. Call `_seal_destroy_resampler' to free it.
+ *
+ * @param presampler    the receiver of the created resampler
+ * @param nchannels     the number of channels of the audio
+ * @param in_freq       the frequency of the input audio
+ * @param out_freq      the frequency of the output audio
+ */
+seal_err_t _seal_create_resampler(_seal_resampler_t** /*presampler*/,
+                                  int /*nchannels*/, int /*in_freq*/,
+                                  int /*out_freq*/);
+
+void _seal_destroy_resampler(_seal_resampler_t*);
+
+/*
+ * Forgets any buffered input so that the next chunk is treated as the start
+ * of a new signal.
+ */
+void _seal_reset_resampler(_seal_resampler_t*);
+
+/*
+ * @return  non-zero if `resampler' converts audio of the specified attribute
+ *          to the specified frequency
+ */
+int _seal_resampler_fits(_seal_resampler_t*, seal_raw_attr_t*,
+                         int /*out_freq*/);
+
+/*
+ * Resamples a chunk of PCM data which continues the chunks previously passed
+ * to the same resampler. The last few frames of each chunk are held back
+ * until the next chunk arrives unless `flush' is non-zero.
+ *
+ * @param resampler the resampler
+ * @param raw       the PCM data to resample; `raw->data' will be replaced by
+ *                  dynamically allocated data (the old data is not freed) and
+ *                  `raw->size' and `raw->attr.freq' will be adjusted
+ * @param flush     non-zero to also output the held-back frames
+ */
+seal_err_t _seal_resample(_seal_resampler_t*, seal_raw_t*, int /*flush*/);
+
+#endif /* _SEAL_RESAMPLE_H_ */
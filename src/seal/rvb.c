@@ -5,24 +5,153 @@
 #include <seal/core.h>
 #include <seal/err.h>
 
-static
-void
-load_properties(seal_rvb_t* rvb, EFXEAXREVERBPROPERTIES properties)
-{
-    seal_set_rvb_density(rvb, properties.flDensity);
-    seal_set_rvb_diffusion(rvb, properties.flDiffusion);
-    seal_set_rvb_gain(rvb, properties.flGain);
-    seal_set_rvb_hfgain(rvb, properties.flGainHF);
-    seal_set_rvb_decay_time(rvb, properties.flDecayTime);
-    seal_set_rvb_hfdecay_ratio(rvb, properties.flDecayHFRatio);
-    seal_set_rvb_reflections_gain(rvb, properties.flReflectionsGain);
-    seal_set_rvb_reflections_delay(rvb, properties.flReflectionsDelay);
-    seal_set_rvb_late_gain(rvb, properties.flLateReverbGain);
-    seal_set_rvb_late_delay(rvb, properties.flLateReverbDelay);
-    seal_set_rvb_air_absorbtion_hfgain(rvb, properties.flAirAbsorptionGainHF);
-    seal_set_rvb_room_rolloff_factor(rvb, properties.flRoomRolloffFactor);
-    seal_set_rvb_hfdecay_limited(rvb, properties.iDecayHFLimit);
-}
+/* Presets in the order of `seal_rvb_preset_t'. */
+#define PRESET(preset) EFX_REVERB_PRESET_##preset
+static const EFXEAXREVERBPROPERTIES PRESETS[] = {
+    /* Default presets */
+    PRESET(GENERIC),
+    PRESET(PADDEDCELL),
+    PRESET(ROOM),
+    PRESET(BATHROOM),
+    PRESET(LIVINGROOM),
+    PRESET(STONEROOM),
+    PRESET(AUDITORIUM),
+    PRESET(CONCERTHALL),
+    PRESET(CAVE),
+    PRESET(ARENA),
+    PRESET(HANGAR),
+    PRESET(CARPETEDHALLWAY),
+    PRESET(HALLWAY),
+    PRESET(STONECORRIDOR),
+    PRESET(ALLEY),
+    PRESET(FOREST),
+    PRESET(CITY),
+    PRESET(MOUNTAINS),
+    PRESET(QUARRY),
+    PRESET(PLAIN),
+    PRESET(PARKINGLOT),
+    PRESET(SEWERPIPE),
+    PRESET(UNDERWATER),
+    PRESET(DRUGGED),
+    PRESET(DIZZY),
+    PRESET(PSYCHOTIC),
+
+    /* Castle presets */
+    PRESET(CASTLE_SMALLROOM),
+    PRESET(CASTLE_SHORTPASSAGE),
+    PRESET(CASTLE_MEDIUMROOM),
+    PRESET(CASTLE_LARGEROOM),
+    PRESET(CASTLE_LONGPASSAGE),
+    PRESET(CASTLE_HALL),
+    PRESET(CASTLE_CUPBOARD),
+    PRESET(CASTLE_COURTYARD),
+    PRESET(CASTLE_ALCOVE),
+
+    /* Factory presets */
+    PRESET(FACTORY_SMALLROOM),
+    PRESET(FACTORY_SHORTPASSAGE),
+    PRESET(FACTORY_MEDIUMROOM),
+    PRESET(FACTORY_LARGEROOM),
+    PRESET(FACTORY_LONGPASSAGE),
+    PRESET(FACTORY_HALL),
+    PRESET(FACTORY_CUPBOARD),
+    PRESET(FACTORY_COURTYARD),
+    PRESET(FACTORY_ALCOVE),
+
+    /* Ice palace presets */
+    PRESET(ICEPALACE_SMALLROOM),
+    PRESET(ICEPALACE_SHORTPASSAGE),
+    PRESET(ICEPALACE_MEDIUMROOM),
+    PRESET(ICEPALACE_LARGEROOM),
+    PRESET(ICEPALACE_LONGPASSAGE),
+    PRESET(ICEPALACE_HALL),
+    PRESET(ICEPALACE_CUPBOARD),
+    PRESET(ICEPALACE_COURTYARD),
+    PRESET(ICEPALACE_ALCOVE),
+
+    /* Space station presets */
+    PRESET(SPACESTATION_SMALLROOM),
+    PRESET(SPACESTATION_SHORTPASSAGE),
+    PRESET(SPACESTATION_MEDIUMROOM),
+    PRESET(SPACESTATION_LARGEROOM),
+    PRESET(SPACESTATION_LONGPASSAGE),
+    PRESET(SPACESTATION_HALL),
+    PRESET(SPACESTATION_CUPBOARD),
+    PRESET(SPACESTATION_ALCOVE),
+
+    /* Wooden Galleon presets */
+    PRESET(WOODEN_SMALLROOM),
+    PRESET(WOODEN_SHORTPASSAGE),
+    PRESET(WOODEN_MEDIUMROOM),
+    PRESET(WOODEN_LARGEROOM),
+    PRESET(WOODEN_LONGPASSAGE),
+    PRESET(WOODEN_HALL),
+    PRESET(WOODEN_CUPBOARD),
+    PRESET(WOODEN_COURTYARD),
+    PRESET(WOODEN_ALCOVE),
+
+    /* Sports presets */
+    PRESET(SPORT_EMPTYSTADIUM),
+    PRESET(SPORT_SQUASHCOURT),
+    PRESET(SPORT_SMALLSWIMMINGPOOL),
+    PRESET(SPORT_LARGESWIMMINGPOOL),
+    PRESET(SPORT_GYMNASIUM),
+    PRESET(SPORT_FULLSTADIUM),
+    PRESET(SPORT_STADIUMTANNOY),
+
+    /* Prefab presets */
+    PRESET(PREFAB_WORKSHOP),
+    PRESET(PREFAB_SCHOOLROOM),
+    PRESET(PREFAB_PRACTISEROOM),
+    PRESET(PREFAB_OUTHOUSE),
+    PRESET(PREFAB_CARAVAN),
+
+    /* Dome presets */
+    PRESET(DOME_TOMB),
+    PRESET(DOME_SAINTPAULS),
+    PRESET(PIPE_SMALL),
+    PRESET(PIPE_LONGTHIN),
+    PRESET(PIPE_LARGE),
+    PRESET(PIPE_RESONANT),
+
+    /* Outdoors presets */
+    PRESET(OUTDOORS_BACKYARD),
+    PRESET(OUTDOORS_ROLLINGPLAINS),
+    PRESET(OUTDOORS_DEEPCANYON),
+    PRESET(OUTDOORS_CREEK),
+    PRESET(OUTDOORS_VALLEY),
+
+    /* Mood presets */
+    PRESET(MOOD_HEAVEN),
+    PRESET(MOOD_HELL),
+    PRESET(MOOD_MEMORY),
+
+    /* Driving presets */
+    PRESET(DRIVING_COMMENTATOR),
+    PRESET(DRIVING_PITGARAGE),
+    PRESET(DRIVING_INCAR_RACER),
+    PRESET(DRIVING_INCAR_SPORTS),
+    PRESET(DRIVING_INCAR_LUXURY),
+    PRESET(DRIVING_FULLGRANDSTAND),
+    PRESET(DRIVING_EMPTYGRANDSTAND),
+    PRESET(DRIVING_TUNNEL),
+
+    /* City presets */
+    PRESET(CITY_STREETS),
+    PRESET(CITY_SUBWAY),
+    PRESET(CITY_MUSEUM),
+    PRESET(CITY_LIBRARY),
+    PRESET(CITY_UNDERPASS),
+    PRESET(CITY_ABANDONED),
+
+    /* Misc. presets */
+    PRESET(DUSTYROOM),
+    PRESET(CHAPEL),
+    PRESET(SMALLWATERROOM)
+};
+#undef PRESET
+
+#define NPRESETS (sizeof PRESETS / sizeof PRESETS[0])
 
 seal_err_t
 SEAL_API
@@ -30,8 +159,11 @@ seal_init_rvb(seal_rvb_t* rvb)
 {
     seal_err_t err;
 
+    if ((err = _seal_init_efx()) != SEAL_OK)
+        return err;
     if ((err = _seal_init_obj(rvb, alGenEffects)) != SEAL_OK)
         return err;
+    _seal_drain_openal_err();
     alEffecti(rvb->id, AL_EFFECT_TYPE, AL_EFFECT_REVERB);
 
     return _seal_get_openal_err();
@@ -44,168 +176,75 @@ seal_destroy_rvb(seal_rvb_t* rvb)
     return _seal_destroy_obj(rvb, alDeleteEffects, alIsEffect);
 }
 
-/* A macro tied very closely to `seal_load_rvb'. */
-#define CASE_LOAD(rvb, preset)                                              \
-    case SEAL_##preset##_REVERB:                                            \
-    {                                                                       \
-        EFXEAXREVERBPROPERTIES __properties__ = EFX_REVERB_PRESET_##preset; \
-        load_properties(rvb, __properties__);                               \
-        break;                                                              \
-    }
-
 seal_err_t
 SEAL_API
 seal_load_rvb(seal_rvb_t* rvb, seal_rvb_preset_t preset)
 {
-    switch (preset) {
-        /* Default presets */
-        CASE_LOAD(rvb, GENERIC)
-        CASE_LOAD(rvb, PADDEDCELL)
-        CASE_LOAD(rvb, ROOM)
-        CASE_LOAD(rvb, BATHROOM)
-        CASE_LOAD(rvb, LIVINGROOM)
-        CASE_LOAD(rvb, STONEROOM)
-        CASE_LOAD(rvb, AUDITORIUM)
-        CASE_LOAD(rvb, CONCERTHALL)
-        CASE_LOAD(rvb, CAVE)
-        CASE_LOAD(rvb, ARENA)
-        CASE_LOAD(rvb, HANGAR)
-        CASE_LOAD(rvb, CARPETEDHALLWAY)
-        CASE_LOAD(rvb, HALLWAY)
-        CASE_LOAD(rvb, STONECORRIDOR)
-        CASE_LOAD(rvb, ALLEY)
-        CASE_LOAD(rvb, FOREST)
-        CASE_LOAD(rvb, CITY)
-        CASE_LOAD(rvb, MOUNTAINS)
-        CASE_LOAD(rvb, QUARRY)
-        CASE_LOAD(rvb, PLAIN)
-        CASE_LOAD(rvb, PARKINGLOT)
-        CASE_LOAD(rvb, SEWERPIPE)
-        CASE_LOAD(rvb, UNDERWATER)
-        CASE_LOAD(rvb, DRUGGED)
-        CASE_LOAD(rvb, DIZZY)
-        CASE_LOAD(rvb, PSYCHOTIC)
-
-        /* Castle presets */
-        CASE_LOAD(rvb, CASTLE_SMALLROOM)
-        CASE_LOAD(rvb, CASTLE_SHORTPASSAGE)
-        CASE_LOAD(rvb, CASTLE_MEDIUMROOM)
-        CASE_LOAD(rvb, CASTLE_LARGEROOM)
-        CASE_LOAD(rvb, CASTLE_LONGPASSAGE)
-        CASE_LOAD(rvb, CASTLE_HALL)
-        CASE_LOAD(rvb, CASTLE_CUPBOARD)
-        CASE_LOAD(rvb, CASTLE_COURTYARD)
-        CASE_LOAD(rvb, CASTLE_ALCOVE)
-
-        /* Factory presets */
-        CASE_LOAD(rvb, FACTORY_SMALLROOM)
-        CASE_LOAD(rvb, FACTORY_SHORTPASSAGE)
-        CASE_LOAD(rvb, FACTORY_MEDIUMROOM)
-        CASE_LOAD(rvb, FACTORY_LARGEROOM)
-        CASE_LOAD(rvb, FACTORY_LONGPASSAGE)
-        CASE_LOAD(rvb, FACTORY_HALL)
-        CASE_LOAD(rvb, FACTORY_CUPBOARD)
-        CASE_LOAD(rvb, FACTORY_COURTYARD)
-        CASE_LOAD(rvb, FACTORY_ALCOVE)
-
-        /* Ice palace presets */
-        CASE_LOAD(rvb, ICEPALACE_SMALLROOM)
-        CASE_LOAD(rvb, ICEPALACE_SHORTPASSAGE)
-        CASE_LOAD(rvb, ICEPALACE_MEDIUMROOM)
-        CASE_LOAD(rvb, ICEPALACE_LARGEROOM)
-        CASE_LOAD(rvb, ICEPALACE_LONGPASSAGE)
-        CASE_LOAD(rvb, ICEPALACE_HALL)
-        CASE_LOAD(rvb, ICEPALACE_CUPBOARD)
-        CASE_LOAD(rvb, ICEPALACE_COURTYARD)
-        CASE_LOAD(rvb, ICEPALACE_ALCOVE)
-
-        /* Space station presets */
-        CASE_LOAD(rvb, SPACESTATION_SMALLROOM)
-        CASE_LOAD(rvb, SPACESTATION_SHORTPASSAGE)
-        CASE_LOAD(rvb, SPACESTATION_MEDIUMROOM)
-        CASE_LOAD(rvb, SPACESTATION_LARGEROOM)
-        CASE_LOAD(rvb, SPACESTATION_LONGPASSAGE)
-        CASE_LOAD(rvb, SPACESTATION_HALL)
-        CASE_LOAD(rvb, SPACESTATION_CUPBOARD)
-        CASE_LOAD(rvb, SPACESTATION_ALCOVE)
-
-        /* Wooden Galleon presets */
-        CASE_LOAD(rvb, WOODEN_SMALLROOM)
-        CASE_LOAD(rvb, WOODEN_SHORTPASSAGE)
-        CASE_LOAD(rvb, WOODEN_MEDIUMROOM)
-        CASE_LOAD(rvb, WOODEN_LARGEROOM)
-        CASE_LOAD(rvb, WOODEN_LONGPASSAGE)
-        CASE_LOAD(rvb, WOODEN_HALL)
-        CASE_LOAD(rvb, WOODEN_CUPBOARD)
-        CASE_LOAD(rvb, WOODEN_COURTYARD)
-        CASE_LOAD(rvb, WOODEN_ALCOVE)
-
-        /* Sports presets */
-        CASE_LOAD(rvb, SPORT_EMPTYSTADIUM)
-        CASE_LOAD(rvb, SPORT_SQUASHCOURT)
-        CASE_LOAD(rvb, SPORT_SMALLSWIMMINGPOOL)
-        CASE_LOAD(rvb, SPORT_LARGESWIMMINGPOOL)
-        CASE_LOAD(rvb, SPORT_GYMNASIUM)
-        CASE_LOAD(rvb, SPORT_FULLSTADIUM)
-        CASE_LOAD(rvb, SPORT_STADIUMTANNOY)
-
-        /* Prefab presets */
-        CASE_LOAD(rvb, PREFAB_WORKSHOP)
-        CASE_LOAD(rvb, PREFAB_SCHOOLROOM)
-        CASE_LOAD(rvb, PREFAB_PRACTISEROOM)
-        CASE_LOAD(rvb, PREFAB_OUTHOUSE)
-        CASE_LOAD(rvb, PREFAB_CARAVAN)
-
-        /* Dome presets */
-        CASE_LOAD(rvb, DOME_TOMB)
-        CASE_LOAD(rvb, DOME_SAINTPAULS)
-
-        /* Pipe presets. */
-        CASE_LOAD(rvb, PIPE_SMALL)
-        CASE_LOAD(rvb, PIPE_LONGTHIN)
-        CASE_LOAD(rvb, PIPE_LARGE)
-        CASE_LOAD(rvb, PIPE_RESONANT)
-
-        /* Outdoors presets */
-        CASE_LOAD(rvb, OUTDOORS_BACKYARD)
-        CASE_LOAD(rvb, OUTDOORS_ROLLINGPLAINS)
-        CASE_LOAD(rvb, OUTDOORS_DEEPCANYON)
-        CASE_LOAD(rvb, OUTDOORS_CREEK)
-        CASE_LOAD(rvb, OUTDOORS_VALLEY)
-
-        /* Mood presets */
-        CASE_LOAD(rvb, MOOD_HEAVEN)
-        CASE_LOAD(rvb, MOOD_HELL)
-        CASE_LOAD(rvb, MOOD_MEMORY)
-
-        /* Driving presets */
-        CASE_LOAD(rvb, DRIVING_COMMENTATOR)
-        CASE_LOAD(rvb, DRIVING_PITGARAGE)
-        CASE_LOAD(rvb, DRIVING_INCAR_RACER)
-        CASE_LOAD(rvb, DRIVING_INCAR_SPORTS)
-        CASE_LOAD(rvb, DRIVING_INCAR_LUXURY)
-        CASE_LOAD(rvb, DRIVING_FULLGRANDSTAND)
-        CASE_LOAD(rvb, DRIVING_EMPTYGRANDSTAND)
-        CASE_LOAD(rvb, DRIVING_TUNNEL)
-
-        /* City presets */
-        CASE_LOAD(rvb, CITY_STREETS)
-        CASE_LOAD(rvb, CITY_SUBWAY)
-        CASE_LOAD(rvb, CITY_MUSEUM)
-        CASE_LOAD(rvb, CITY_LIBRARY)
-        CASE_LOAD(rvb, CITY_UNDERPASS)
-        CASE_LOAD(rvb, CITY_ABANDONED)
-
-        /* Misc. presets */
-        CASE_LOAD(rvb, DUSTYROOM)
-        CASE_LOAD(rvb, CHAPEL)
-        CASE_LOAD(rvb, SMALLWATERROOM)
-        default:
-            return SEAL_BAD_PRESET;
-    }
+    seal_rvb_params_t params;
+    seal_err_t err;
+
+    if ((err = seal_get_rvb_preset(preset, &params)) != SEAL_OK)
+        return err;
+
+    return seal_set_rvb_params(rvb, &params);
+}
+
+seal_err_t
+SEAL_API
+seal_get_rvb_preset(seal_rvb_preset_t preset, seal_rvb_params_t* params)
+{
+    const EFXEAXREVERBPROPERTIES* properties;
+
+    if ((size_t) preset >= NPRESETS)
+        return SEAL_BAD_PRESET;
+
+    properties = PRESETS + preset;
+    params->density = properties->flDensity;
+    params->diffusion = properties->flDiffusion;
+    params->gain = properties->flGain;
+    params->hfgain = properties->flGainHF;
+    params->decay_time = properties->flDecayTime;
+    params->hfdecay_ratio = properties->flDecayHFRatio;
+    params->reflections_gain = properties->flReflectionsGain;
+    params->reflections_delay = properties->flReflectionsDelay;
+    params->late_gain = properties->flLateReverbGain;
+    params->late_delay = properties->flLateReverbDelay;
+    params->air_absorbtion_hfgain = properties->flAirAbsorptionGainHF;
+    params->room_rolloff_factor = properties->flRoomRolloffFactor;
+    params->hfdecay_limited = properties->iDecayHFLimit != 0;
+
     return SEAL_OK;
 }
 
+seal_err_t
+SEAL_API
+seal_set_rvb_params(seal_rvb_t* rvb, const seal_rvb_params_t* params)
+{
+    seal_err_t err;
+
+    /* Checks the float writes for errors once rather than one by one. */
+    seal_begin_batch();
+    seal_set_rvb_density(rvb, params->density);
+    seal_set_rvb_diffusion(rvb, params->diffusion);
+    seal_set_rvb_gain(rvb, params->gain);
+    seal_set_rvb_hfgain(rvb, params->hfgain);
+    seal_set_rvb_decay_time(rvb, params->decay_time);
+    seal_set_rvb_hfdecay_ratio(rvb, params->hfdecay_ratio);
+    seal_set_rvb_reflections_gain(rvb, params->reflections_gain);
+    seal_set_rvb_reflections_delay(rvb, params->reflections_delay);
+    seal_set_rvb_late_gain(rvb, params->late_gain);
+    seal_set_rvb_late_delay(rvb, params->late_delay);
+    seal_set_rvb_air_absorbtion_hfgain(rvb, params->air_absorbtion_hfgain);
+    seal_set_rvb_room_rolloff_factor(rvb, params->room_rolloff_factor);
+    if ((err = seal_commit_batch()) != SEAL_OK)
+        return err;
+    /* Writes that could not be deferred were made right away. */
+    if ((err = _seal_get_openal_prop_err()) != SEAL_OK)
+        return err;
+
+    return seal_set_rvb_hfdecay_limited(rvb, params->hfdecay_limited);
+}
+
 seal_err_t
 SEAL_API
 seal_set_rvb_density(seal_rvb_t* rvb, float density)
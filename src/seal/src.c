@@ -1,14 +1,20 @@
 #include <string.h>
 #include <stdlib.h>
+#include <float.h>
 #include <al/al.h>
 #include <al/efx.h>
 #include <seal/src.h>
 #include <seal/core.h>
 #include <seal/buf.h>
 #include <seal/stream.h>
+#include <seal/cbuf.h>
 #include <seal/efs.h>
+#include <seal/culler.h>
+#include <seal/context.h>
 #include <seal/err.h>
 #include "threading.h"
+#include "resample.h"
+#include "batch.h"
 
 typedef void queue_op_t(unsigned int, int, unsigned int*);
 
@@ -27,6 +33,20 @@ static const size_t DEFAULT_CHUNK_SIZE = MIN_CHUNK_SIZE << 2;
 static const size_t MAX_CHUNK_SIZE     = CHUNK_STORAGE_CAP -
                                          CHUNK_STORAGE_CAP % MIN_CHUNK_SIZE;
 
+/*
+ * The sources updated by `seal_render' in place of updater threads when on a
+ * loopback device.
+ */
+static seal_src_t** rendered_srcs = 0;
+static size_t nrendered_srcs = 0;
+static size_t rendered_srcs_cap = 0;
+/*
+ * Guards the sources above against `seal_render' and source functions
+ * called from other threads. Only exists on loopback devices, as the list
+ * stays empty otherwise.
+ */
+static void* rendered_srcs_mutex = 0;
+
 /*
  * Checks if `val` is in the closed interval [`lower_bound`, `upper_bound`].
  */
@@ -73,6 +93,7 @@ change_state(seal_src_t* src, void (*op)(unsigned int))
 {
     seal_err_t err;
 
+    _seal_drain_openal_err();
     op(src->id);
     if ((err = _seal_get_openal_err()) != SEAL_OK)
         return err;
@@ -84,18 +105,75 @@ static
 seal_err_t
 set3f(seal_src_t* src, int key, float x, float y, float z)
 {
+    float vals[3];
+
+    vals[0] = x;
+    vals[1] = y;
+    vals[2] = z;
+    if (_seal_defer_write(alSource3f, src->id, key, _SEAL_DEFERRED_3F, vals))
+        return SEAL_OK;
     alSource3f(src->id, key, x, y, z);
 
-    return _seal_get_openal_err();
+    return _seal_get_openal_prop_err();
 }
 
+/* Same as `set3f' except that errors are left for the caller to check. */
+static
+void
+set3fv(seal_src_t* src, int key, const float* vals)
+{
+    if (!_seal_defer_write(alSource3f, src->id, key, _SEAL_DEFERRED_3F, vals))
+        alSourcefv(src->id, key, vals);
+}
+
+static
+void
+get3f(const float* vals, float* px, float* py, float* pz)
+{
+    *px = vals[0];
+    *py = vals[1];
+    *pz = vals[2];
+}
+
+/* Lets the culler indexing a source know that the source has moved. */
+static
+void
+update_culler(seal_src_t* src)
+{
+    if (src->culler != 0)
+        _seal_update_culled_src(src);
+}
+
+/* Sets a shadowed vector property and updates the copy on success. */
 static
 seal_err_t
-get3f(seal_src_t* src, int key, float* px, float* py, float* pz)
+set_shadowed3f(seal_src_t* src, int key, float* vals, float x, float y,
+               float z)
 {
-    alGetSource3f(src->id, key, px, py, pz);
+    seal_err_t err = set3f(src, key, x, y, z);
 
-    return _seal_get_openal_err();
+    if (err == SEAL_OK) {
+        vals[0] = x;
+        vals[1] = y;
+        vals[2] = z;
+    }
+
+    return err;
+}
+
+/* Sets a shadowed non-negative float property. */
+static
+seal_err_t
+set_shadowedf(seal_src_t* src, int key, float* pval, float val)
+{
+    seal_err_t err;
+
+    if (!(val >= 0))
+        return SEAL_BAD_VAL;
+    if ((err = _seal_setf(src, key, val, alSourcef)) == SEAL_OK)
+        *pval = val;
+
+    return err;
 }
 
 static
@@ -106,6 +184,54 @@ wait4updater(seal_src_t* src)
         _seal_join_thread(src->updater);
         src->updater = 0;
     }
+    src->priming = 0;
+}
+
+/*
+ * Does one round of the work of an updater, short of waiting for the next.
+ *
+ * @param src   the source to update
+ * @param perr  the receiver of the error encountered, if any
+ * @return      1 if the source needs more rounds or otherwise 0
+ */
+static
+char
+update_once(seal_src_t* src, seal_err_t* perr)
+{
+    seal_src_state_t state;
+
+    *perr = SEAL_OK;
+    /* The stream was still being opened when playback was requested. */
+    if (_seal_is_stream_opening(src->stream)) {
+        if ((*perr = seal_wait_stream(src->stream)) != SEAL_OK) {
+            src->early_stop = 0;
+            return 0;
+        }
+        if ((*perr = seal_update_src(src)) != SEAL_OK)
+            return 0;
+        /* Manual sources are only primed. */
+        if (!src->automatic) {
+            if (src->early_stop)
+                *perr = change_state(src, alSourcePlay);
+            return 0;
+        }
+    }
+
+    if (!alIsSource(src->id))
+        return 0;
+    /* Check source state before checking if interrupted by caller. */
+    if ((*perr = seal_get_src_state(src, &state)) != SEAL_OK)
+        return 0;
+    if (state != SEAL_PLAYING) {
+        /* Early stopping, most likely due to I/O load. Restart playing. */
+        if (!src->early_stop)
+            return 0;
+        if ((*perr = change_state(src, alSourcePlay)) != SEAL_OK)
+            return 0;
+    }
+    *perr = seal_update_src(src);
+
+    return *perr == SEAL_OK;
 }
 
 /*
@@ -116,36 +242,95 @@ void*
 update(void* args)
 {
     seal_src_t* src = args;
-    seal_err_t err = SEAL_OK;
+    seal_err_t err;
 
-    while (alIsSource(src->id)) {
-        seal_src_state_t state;
+    _seal_sched_streaming_thread();
+    /* Sources live in the context of the thread that created them. */
+    if (src->context != 0)
+        seal_use_context(src->context);
 
-        /* Check source state before checking if interrupted by caller. */
-        if ((err = seal_get_src_state(src, &state)) != SEAL_OK)
-           break;
-        if (state != SEAL_PLAYING) {
-            /* Early stopping, most likely due to I/O load. Restart playing. */
-            if (src->early_stop) {
-                if ((err = change_state(src, alSourcePlay)) != SEAL_OK)
-                    break;
-            } else {
-                break;
-            }
-        }
-        if ((err = seal_update_src(src)) != SEAL_OK)
+    while (update_once(src, &err))
+        _seal_sleep(50);
+
+    return (void*) err;
+}
+
+static
+void
+lock_rendered_srcs(void)
+{
+    if (rendered_srcs_mutex != 0)
+        _seal_lock_mutex(rendered_srcs_mutex);
+}
+
+static
+void
+unlock_rendered_srcs(void)
+{
+    if (rendered_srcs_mutex != 0)
+        _seal_unlock_mutex(rendered_srcs_mutex);
+}
+
+static
+void
+forget_rendered_src(seal_src_t* src)
+{
+    size_t i;
+
+    lock_rendered_srcs();
+    for (i = 0; i < nrendered_srcs; ++i) {
+        if (rendered_srcs[i] == src) {
+            rendered_srcs[i] = rendered_srcs[--nrendered_srcs];
             break;
+        }
+    }
+    unlock_rendered_srcs();
+}
 
-        _seal_sleep(50);
+/*
+ * Gets a source updated in the background, or by `seal_render' when on a
+ * loopback device so that streaming keeps in step with the rendering.
+ */
+static
+seal_err_t
+start_updater(seal_src_t* src)
+{
+    size_t i;
+    seal_err_t err = SEAL_OK;
+
+    if (!_seal_is_loopback()) {
+        src->updater = _seal_create_thread(update, src);
+        return src->updater != 0 ? SEAL_OK : SEAL_CANNOT_ALLOC_MEM;
     }
 
-    return (void*) err;
+    lock_rendered_srcs();
+    for (i = 0; i < nrendered_srcs; ++i)
+        if (rendered_srcs[i] == src)
+            goto cleanup;
+    if (nrendered_srcs == rendered_srcs_cap) {
+        size_t cap = rendered_srcs_cap == 0 ? 8 : rendered_srcs_cap * 2;
+        seal_src_t** srcs = realloc(rendered_srcs, cap * sizeof *srcs);
+
+        if (srcs == 0) {
+            err = SEAL_CANNOT_ALLOC_MEM;
+            goto cleanup;
+        }
+        rendered_srcs = srcs;
+        rendered_srcs_cap = cap;
+    }
+    rendered_srcs[nrendered_srcs++] = src;
+
+cleanup:
+    unlock_rendered_srcs();
+
+    return err;
 }
 
 static
 seal_err_t
 queue_op(seal_src_t* src, int nbufs, unsigned int* bufs, queue_op_t* op)
 {
+    _seal_drain_openal_err();
     op(src->id, nbufs, bufs);
 
     return _seal_get_openal_err();
@@ -217,6 +402,71 @@ stop_then_clean_queue(seal_src_t* src)
     return clean_queue(src);
 }
 
+/*
+ * Makes the next streamed chunk start a new signal for the resampler.
+ */
+static
+void
+reset_resampler(seal_src_t* src)
+{
+    if (src->resampler != 0)
+        _seal_reset_resampler(src->resampler);
+}
+
+static
+void
+destroy_resampler(seal_src_t* src)
+{
+    if (src->resampler != 0) {
+        _seal_destroy_resampler(src->resampler);
+        src->resampler = 0;
+    }
+}
+
+/*
+ * Resamples a streamed chunk to the mixing frequency of the device if
+ * resampling is enabled. `raw->data' is replaced on success. Flushing drains
+ * the frames held back by the resampler and destroys it.
+ */
+static
+seal_err_t
+resample_chunk(seal_src_t* src, seal_raw_t* raw, int flush)
+{
+    int freq;
+    void* data = raw->data;
+    seal_err_t err;
+
+    if (flush) {
+        raw->data = 0;
+        raw->size = 0;
+        if (src->resampler == 0)
+            return SEAL_OK;
+        raw->attr = src->stream->attr;
+        err = _seal_resample(src->resampler, raw, 1);
+        destroy_resampler(src);
+
+        return err;
+    }
+
+    if ((freq = _seal_get_resampling_freq(&raw->attr)) == 0) {
+        destroy_resampler(src);
+        return SEAL_OK;
+    }
+    if (src->resampler == 0
+        || !_seal_resampler_fits(src->resampler, &raw->attr, freq)) {
+        destroy_resampler(src);
+        err = _seal_create_resampler((_seal_resampler_t**) &src->resampler,
+                                     raw->attr.nchannels, raw->attr.freq,
+                                     freq);
+        if (err != SEAL_OK)
+            return err;
+    }
+    if ((err = _seal_resample(src->resampler, raw, 0)) == SEAL_OK)
+        free(data);
+
+    return err;
+}
+
 static
 seal_err_t
 restart_queuing(seal_src_t* src)
@@ -225,6 +475,7 @@ restart_queuing(seal_src_t* src)
 
     if ((err = stop_then_clean_queue(src)) != SEAL_OK)
         return err;
+    reset_resampler(src);
 
     return seal_rewind_stream(src->stream);
 }
@@ -256,6 +507,70 @@ ensure_queue_empty(seal_src_t* src)
     return SEAL_OK;
 }
 
+/*
+ * Closes the stream privately opened on the attached compressed buffer, if
+ * any. This function assumes the queue is empty at the time of calling.
+ */
+static
+seal_err_t
+release_cbuf(seal_src_t* src)
+{
+    seal_err_t err;
+
+    if (src->cbuf == 0)
+        return SEAL_OK;
+
+    if ((err = seal_close_stream(src->stream)) != SEAL_OK)
+        return err;
+    free(src->stream);
+    src->stream = 0;
+    src->cbuf = 0;
+
+    return SEAL_OK;
+}
+
+static
+seal_err_t
+attach_stream(seal_src_t* src, seal_stream_t* stream)
+{
+    seal_err_t err;
+
+    if (stream == src->stream)
+        return SEAL_OK;
+    /* Make sure `src' is not currently a static source. */
+    if (src->buf != 0)
+        return SEAL_MIXING_SRC_TYPE;
+    if (_seal_is_stream_opening(stream)) {
+        /* The format is unknown yet so start over with an empty queue. */
+        if ((err = ensure_queue_empty(src)) != SEAL_OK)
+            return err;
+        if ((err = _seal_seti(src, AL_LOOPING, 0, alSourcei)) != SEAL_OK)
+            return err;
+        src->stream = stream;
+        reset_resampler(src);
+
+        /* The queue will be filled once the stream is opened. */
+        return SEAL_OK;
+    }
+    /* Cannot associate an unopened stream. */
+    if (stream->id == 0)
+        return SEAL_STREAM_UNOPENED;
+    /* Cannot associate a stream with a different audio format. */
+    if (src->stream != 0 && memcmp(&stream->attr, &src->stream->attr,
+                                   sizeof (seal_raw_attr_t)) != 0)
+        return SEAL_MIXING_STREAM_FMT;
+
+    /* Never use AL_LOOPING for streaming sources. */
+    if ((err = _seal_seti(src, AL_LOOPING, 0, alSourcei)) != SEAL_OK)
+        return err;
+
+    src->stream = stream;
+    reset_resampler(src);
+
+    /* Immediately update the queue to become `AL_STREAMING'. */
+    return seal_update_src(src);
+}
+
 seal_err_t
 SEAL_API
 seal_init_src(seal_src_t* src)
@@ -265,6 +580,8 @@ seal_init_src(seal_src_t* src)
     if (err == SEAL_OK) {
         src->buf = 0;
         src->stream = 0;
+        src->cbuf = 0;
+        src->resampler = 0;
         /* The id of the thread that is updating the source. */
         src->updater = 0;
         src->chunk_size = DEFAULT_CHUNK_SIZE;
@@ -272,6 +589,17 @@ seal_init_src(seal_src_t* src)
         src->looping = 0;
         src->automatic = 1;
         src->early_stop = 0;
+        src->priming = 0;
+        src->relative = 0;
+        src->culled = 0;
+        memset(src->pos, 0, sizeof src->pos);
+        memset(src->vel, 0, sizeof src->vel);
+        src->gain = 1;
+        src->pitch = 1;
+        src->max_dist = FLT_MAX;
+        src->culler = 0;
+        src->cull_slot = 0;
+        src->context = seal_get_context();
     }
 
     return err;
@@ -283,9 +611,16 @@ seal_destroy_src(seal_src_t* src)
 {
     seal_err_t err;
 
+    if (src->culler != 0)
+        seal_remove_culled_src(src->culler, src);
+    forget_rendered_src(src);
     if (alIsSource(src->id)) {
         if ((err = ensure_queue_empty(src)) != SEAL_OK)
             return err;
+        if ((err = release_cbuf(src)) != SEAL_OK)
+            return err;
+        destroy_resampler(src);
+        _seal_flush_batch();
         err = _seal_delete_objs(1, &src->id, alDeleteSources);
         if (err != SEAL_OK)
             return err;
@@ -298,6 +633,8 @@ seal_err_t
 SEAL_API
 seal_play_src(seal_src_t* src)
 {
+    if (src->culler != 0)
+        _seal_wake_culled_src(src);
     if (src->stream != 0) {
         seal_src_state_t state;
         seal_err_t err = seal_get_src_state(src, &state);
@@ -311,6 +648,13 @@ seal_play_src(seal_src_t* src)
             /* In case the old updater is not done. */
             wait4updater(src);
         }
+        /* Let the updater fill the queue and start playing once the stream
+         * is opened. */
+        if (_seal_is_stream_opening(src->stream)) {
+            src->early_stop = 1;
+            src->priming = !src->automatic;
+            return start_updater(src);
+        }
         /* Stream some data so plackback can start immediately. */
         if ((err = seal_update_src(src)) != SEAL_OK)
             return err;
@@ -319,7 +663,7 @@ seal_play_src(seal_src_t* src)
             return err;
         /* Create background updater for automatic sources. */
         if (src->automatic)
-            src->updater = _seal_create_thread(update, src);
+            return start_updater(src);
         return SEAL_OK;
     } else {
         return change_state(src, alSourcePlay);
@@ -330,6 +674,8 @@ seal_err_t
 SEAL_API
 seal_pause_src(seal_src_t* src)
 {
+    src->culled = 0;
+
     return change_state(src, alSourcePause);
 }
 
@@ -339,13 +685,16 @@ seal_stop_src(seal_src_t* src)
 {
     seal_err_t err;
 
+    src->culled = 0;
     if ((err = change_state(src, alSourceStop)) != SEAL_OK)
        return err;
 
     if (src->stream != 0)
         /* Already stopped so all buffers are proccessed. */
-        if ((err = clean_queue(src)) == SEAL_OK)
+        if ((err = clean_queue(src)) == SEAL_OK) {
+            reset_resampler(src);
             err = seal_rewind_stream(src->stream);
+        }
 
     return err;
 }
@@ -354,6 +703,7 @@ seal_err_t
 SEAL_API
 seal_rewind_src(seal_src_t* src)
 {
+    src->culled = 0;
     if (src->stream != 0) {
         seal_src_state_t state;
         seal_err_t err = seal_get_src_state(src, &state);
@@ -386,6 +736,10 @@ seal_detach_src_audio(seal_src_t* src)
     if ((err = on_preemptive_state_change(src)) != SEAL_OK)
         return err;
 
+    if ((err = release_cbuf(src)) != SEAL_OK)
+        return err;
+    destroy_resampler(src);
+
     src->buf = 0;
     src->stream = 0;
 
@@ -396,23 +750,39 @@ seal_err_t
 SEAL_API
 seal_move_src(seal_src_t* src)
 {
-    seal_err_t err;
-    float pos[3], vel[3];
-
-    if ((err = seal_get_src_pos(src, pos, pos + 1, pos + 2)) != SEAL_OK)
-        return err;
-    if ((err = seal_get_src_vel(src, vel, vel + 1, vel + 2)) != SEAL_OK)
-        return err;
-    err = seal_set_src_pos(
+    return seal_set_src_pos(
         src,
-        pos[0] + vel[0],
-        pos[1] + vel[1],
-        pos[2] + vel[2]
+        src->pos[0] + src->vel[0],
+        src->pos[1] + src->vel[1],
+        src->pos[2] + src->vel[2]
     );
-    if (err != SEAL_OK)
+}
+
+seal_err_t
+SEAL_API
+seal_move_srcs(seal_src_t** srcs, size_t n, float dt)
+{
+    size_t i;
+    seal_err_t err;
+
+    seal_begin_batch();
+    for (i = 0; i < n; ++i) {
+        float* pos = srcs[i]->pos;
+        const float* vel = srcs[i]->vel;
+
+        if (vel[0] == 0 && vel[1] == 0 && vel[2] == 0)
+            continue;
+        pos[0] += vel[0] * dt;
+        pos[1] += vel[1] * dt;
+        pos[2] += vel[2] * dt;
+        set3fv(srcs[i], AL_POSITION, pos);
+        update_culler(srcs[i]);
+    }
+    if ((err = seal_commit_batch()) != SEAL_OK)
         return err;
 
-    return SEAL_OK;
+    /* Writes that could not be deferred were made right away. */
+    return _seal_get_openal_prop_err();
 }
 
 seal_err_t
@@ -440,35 +810,59 @@ seal_err_t
 SEAL_API
 seal_set_src_stream(seal_src_t* src, seal_stream_t* stream)
 {
+    /* Make sure `src' is not currently playing a compressed buffer. */
+    if (src->cbuf != 0)
+        return SEAL_MIXING_SRC_TYPE;
+
+    return attach_stream(src, stream);
+}
+
+seal_err_t
+SEAL_API
+seal_set_src_cbuf(seal_src_t* src, seal_cbuf_t* cbuf)
+{
+    seal_stream_t* stream;
     seal_err_t err;
 
-    if (stream == src->stream)
+    if (cbuf == src->cbuf)
         return SEAL_OK;
-    /* Make sure `src' is not currently a static source. */
-    if (src->buf != 0)
+    if (cbuf == 0)
+        return seal_detach_src_audio(src);
+    /* Make sure `src' is not currently a static or plain streaming source. */
+    if (src->buf != 0 || (src->stream != 0 && src->cbuf == 0))
         return SEAL_MIXING_SRC_TYPE;
-    /* Cannot associate an unopened stream. */
-    if (stream->id == 0)
-        return SEAL_STREAM_UNOPENED;
-    /* Cannot associate a stream with a different audio format. */
-    if (src->stream != 0 && memcmp(&stream->attr, &src->stream->attr,
-                                   sizeof (seal_raw_attr_t)) != 0)
-        return SEAL_MIXING_STREAM_FMT;
 
-    /* Never use AL_LOOPING for streaming sources. */
-    if ((err = _seal_seti(src, AL_LOOPING, 0, alSourcei)) != SEAL_OK)
+    stream = malloc(sizeof (seal_stream_t));
+    if (stream == 0)
+        return SEAL_CANNOT_ALLOC_MEM;
+    if ((err = seal_open_cbuf_stream(stream, cbuf)) != SEAL_OK)
+        goto cleanup;
+
+    /* The old private stream cannot be closed while still queued. */
+    if (src->cbuf != 0)
+        if ((err = seal_detach_src_audio(src)) != SEAL_OK)
+            goto close_stream;
+
+    err = attach_stream(src, stream);
+    /* Even if updating failed, the stream is attached and owned by `src'. */
+    if (src->stream == stream) {
+        src->cbuf = cbuf;
         return err;
+    }
 
-    src->stream = stream;
+close_stream:
+    seal_close_stream(stream);
+cleanup:
+    free(stream);
 
-    /* Immediately update the queue to become `AL_STREAMING'. */
-    return seal_update_src(src);
+    return err;
 }
 
 seal_err_t
 SEAL_API
 seal_feed_efs(seal_src_t* src, seal_efs_t* slot, int index)
 {
+    _seal_drain_openal_err();
     alSource3i(
         src->id,
         AL_AUXILIARY_SEND_FILTER,
@@ -494,9 +888,16 @@ seal_update_src(seal_src_t* src)
 
     if (src->stream == 0)
         return SEAL_OK;
+    /* Takes a manual source back once its queue is primed. */
+    if (src->priming && !_seal_calling_thread_is(src->updater)
+        && !_seal_is_stream_opening(src->stream))
+        wait4updater(src);
     /* If another updater is running. */
     if (src->updater != 0 && !_seal_calling_thread_is(src->updater))
         return SEAL_OK;
+    /* Nothing to stream yet. */
+    if (_seal_is_stream_opening(src->stream))
+        return SEAL_OK;
 
     /* Set the desired size of each chunk. */
     raw.size = src->chunk_size;
@@ -541,9 +942,20 @@ start_streaming:
         if (err != SEAL_OK)
             break;
         if (nbytes_streamed > 0) {
+            if ((err = resample_chunk(src, &raw, 0)) != SEAL_OK) {
+                free(raw.data);
+                break;
+            }
+            /* All held back by the resampler. */
+            if (raw.size == 0) {
+                free(raw.data);
+                raw.size = src->chunk_size;
+                goto start_streaming;
+            }
             /* Fill or refill the current buffer. */
             err = _seal_raw2buf(buf, &raw);
             free(raw.data);
+            raw.size = src->chunk_size;
             if (err != SEAL_OK)
                 break;
             if ((err = queue_bufs(src, 1, &buf)) != SEAL_OK)
@@ -555,6 +967,20 @@ start_streaming:
             goto start_streaming;
         /* End of stream reached. */
         } else {
+            /* Queue the frames still held back by the resampler, if any. */
+            if ((err = resample_chunk(src, &raw, 1)) != SEAL_OK)
+                break;
+            if (raw.size > 0) {
+                err = _seal_raw2buf(buf, &raw);
+                free(raw.data);
+                raw.size = src->chunk_size;
+                if (err != SEAL_OK)
+                    break;
+                if ((err = queue_bufs(src, 1, &buf)) != SEAL_OK)
+                    break;
+                continue;
+            }
+            free(raw.data);
             src->early_stop = 0;
             break;
         }
@@ -598,28 +1024,89 @@ seal_err_t
 SEAL_API
 seal_set_src_pos(seal_src_t* src, float x, float y, float z)
 {
-    return set3f(src, AL_POSITION, x, y, z);
+    seal_err_t err = set_shadowed3f(src, AL_POSITION, src->pos, x, y, z);
+
+    if (err == SEAL_OK)
+        update_culler(src);
+
+    return err;
 }
 
 seal_err_t
 SEAL_API
 seal_set_src_vel(seal_src_t* src, float x, float y, float z)
 {
-    return set3f(src, AL_VELOCITY, x, y, z);
+    return set_shadowed3f(src, AL_VELOCITY, src->vel, x, y, z);
+}
+
+seal_err_t
+SEAL_API
+seal_set_src_transforms(seal_src_t** srcs, size_t n, const float* pos,
+                        const float* vel)
+{
+    size_t i;
+    /* Within an open batch the writes join it and are checked on commit. */
+    int batching = _seal_is_batching();
+
+    if (!batching)
+        alDeferUpdatesSOFT();
+    for (i = 0; i < n; ++i) {
+        if (pos != 0) {
+            memcpy(srcs[i]->pos, pos + i * 3, sizeof srcs[i]->pos);
+            set3fv(srcs[i], AL_POSITION, pos + i * 3);
+            update_culler(srcs[i]);
+        }
+        if (vel != 0) {
+            memcpy(srcs[i]->vel, vel + i * 3, sizeof srcs[i]->vel);
+            set3fv(srcs[i], AL_VELOCITY, vel + i * 3);
+        }
+    }
+    if (batching)
+        return SEAL_OK;
+    alProcessUpdatesSOFT();
+
+    return _seal_get_openal_prop_err();
 }
 
 seal_err_t
 SEAL_API
 seal_set_src_pitch(seal_src_t* src, float pitch)
 {
-    return _seal_setf(src, AL_PITCH, pitch, alSourcef);
+    return set_shadowedf(src, AL_PITCH, &src->pitch, pitch);
 }
 
 seal_err_t
 SEAL_API
 seal_set_src_gain(seal_src_t* src, float gain)
 {
-    return _seal_setf(src, AL_GAIN, gain, alSourcef);
+    return set_shadowedf(src, AL_GAIN, &src->gain, gain);
+}
+
+seal_err_t
+SEAL_API
+seal_set_src_rolloff_factor(seal_src_t* src, float factor)
+{
+    return _seal_setf(src, AL_ROLLOFF_FACTOR, factor, alSourcef);
+}
+
+seal_err_t
+SEAL_API
+seal_set_src_ref_dist(seal_src_t* src, float dist)
+{
+    return _seal_setf(src, AL_REFERENCE_DISTANCE, dist, alSourcef);
+}
+
+seal_err_t
+SEAL_API
+seal_set_src_max_dist(seal_src_t* src, float dist)
+{
+    seal_err_t err = set_shadowedf(src, AL_MAX_DISTANCE, &src->max_dist,
+                                   dist);
+
+    if (err == SEAL_OK)
+        update_culler(src);
+
+    return err;
 }
 
 seal_err_t
@@ -635,7 +1122,14 @@ seal_err_t
 SEAL_API
 seal_set_src_relative(seal_src_t* src, char relative)
 {
-    return _seal_seti(src, AL_SOURCE_RELATIVE, relative != 0, alSourcei);
+    seal_err_t err;
+
+    relative = relative != 0;
+    err = _seal_seti(src, AL_SOURCE_RELATIVE, relative, alSourcei);
+    if (err == SEAL_OK)
+        src->relative = relative;
+
+    return err;
 }
 
 seal_err_t
@@ -673,6 +1167,13 @@ seal_get_src_stream(seal_src_t* src)
     return src->stream;
 }
 
+seal_cbuf_t*
+SEAL_API
+seal_get_src_cbuf(seal_src_t* src)
+{
+    return src->cbuf;
+}
+
 seal_err_t
 SEAL_API
 seal_get_src_queue_size(seal_src_t* src, size_t* psize)
@@ -695,28 +1196,59 @@ seal_err_t
 SEAL_API
 seal_get_src_pos(seal_src_t* src, float* px, float* py, float* pz)
 {
-    return get3f(src, AL_POSITION, px, py, pz);
+    get3f(src->pos, px, py, pz);
+
+    return SEAL_OK;
 }
 
 seal_err_t
 SEAL_API
 seal_get_src_vel(seal_src_t* src, float* px, float* py, float* pz)
 {
-    return get3f(src, AL_VELOCITY, px, py, pz);
+    get3f(src->vel, px, py, pz);
+
+    return SEAL_OK;
 }
 
 seal_err_t
 SEAL_API
 seal_get_src_pitch(seal_src_t* src, float* ppitch)
 {
-    return _seal_getf(src, AL_PITCH, ppitch, alGetSourcef);
+    *ppitch = src->pitch;
+
+    return SEAL_OK;
 }
 
 seal_err_t
 SEAL_API
 seal_get_src_gain(seal_src_t* src, float* pgain)
 {
-    return _seal_getf(src, AL_GAIN, pgain, alGetSourcef);
+    *pgain = src->gain;
+
+    return SEAL_OK;
+}
+
+seal_err_t
+SEAL_API
+seal_get_src_rolloff_factor(seal_src_t* src, float* pfactor)
+{
+    return _seal_getf(src, AL_ROLLOFF_FACTOR, pfactor, alGetSourcef);
+}
+
+seal_err_t
+SEAL_API
+seal_get_src_ref_dist(seal_src_t* src, float* pdist)
+{
+    return _seal_getf(src, AL_REFERENCE_DISTANCE, pdist, alGetSourcef);
+}
+
+seal_err_t
+SEAL_API
+seal_get_src_max_dist(seal_src_t* src, float* pdist)
+{
+    *pdist = src->max_dist;
+
+    return SEAL_OK;
 }
 
 seal_err_t
@@ -794,3 +1326,50 @@ seal_get_src_state(seal_src_t* src, seal_src_state_t* pstate)
 
     return err;
 }
+
+seal_err_t
+_seal_update_rendered_srcs(void)
+{
+    size_t i = 0;
+    seal_err_t err = SEAL_OK, next;
+
+    lock_rendered_srcs();
+    while (i < nrendered_srcs) {
+        if (update_once(rendered_srcs[i], &next)) {
+            ++i;
+            continue;
+        }
+        /* Done like an updater thread exiting. */
+        if (next != SEAL_OK && err == SEAL_OK)
+            err = next;
+        rendered_srcs[i] = rendered_srcs[--nrendered_srcs];
+    }
+    unlock_rendered_srcs();
+
+    return err;
+}
+
+seal_err_t
+_seal_init_rendered_srcs(void)
+{
+    if (rendered_srcs_mutex == 0
+        && (rendered_srcs_mutex = _seal_create_mutex()) == 0)
+        return SEAL_CANNOT_ALLOC_MEM;
+
+    return SEAL_OK;
+}
+
+void
+_seal_forget_rendered_srcs(void)
+{
+    lock_rendered_srcs();
+    free(rendered_srcs);
+    rendered_srcs = 0;
+    nrendered_srcs = 0;
+    rendered_srcs_cap = 0;
+    unlock_rendered_srcs();
+    if (rendered_srcs_mutex != 0) {
+        _seal_destroy_mutex(rendered_srcs_mutex);
+        rendered_srcs_mutex = 0;
+    }
+}
@@ -1,15 +1,39 @@
 #include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
 #include <seal/stream.h>
 #include <seal/raw.h>
 #include <seal/fmt.h>
+#include <seal/io.h>
+#include <seal/core.h>
 #include <seal/err.h>
 #include "ov.h"
 #include "mpg.h"
 #include "wav.h"
+#include "threading.h"
 
+static const size_t DEFAULT_READAHEAD = 262144;
+/* How often canceled waits notice it, in milliseconds. */
+static const unsigned int CANCEL_CHECK_INTERVAL = 20;
+
+static char fast_open = 0;
+
+/* State of a stream being opened in the background. */
+typedef struct opener_t
+{
+    /* Done when the stream is opened or failed to open. */
+    _seal_task_t*      task;
+    char*              filename;
+    seal_fmt_t         fmt;
+    seal_err_t         err;
+    seal_stream_cb_t*  callback;
+    void*              data;
+    seal_stream_t*     stream;
+} opener_t;
+
+static
 seal_err_t
-SEAL_API
-seal_open_stream(seal_stream_t* stream, const char* filename, seal_fmt_t fmt)
+open_stream(seal_stream_t* stream, const char* filename, seal_fmt_t fmt)
 {
     seal_err_t err;
 
@@ -33,10 +57,149 @@ seal_open_stream(seal_stream_t* stream, const char* filename, seal_fmt_t fmt)
     return err;
 }
 
+/*
+ * The routine of opener tasks, run by the workers.
+ */
+static
+void*
+open_in_background(void* args)
+{
+    opener_t* opener = args;
+
+    opener->err = open_stream(opener->stream, opener->filename, opener->fmt);
+    if (opener->callback != 0)
+        opener->callback(opener->stream, opener->err, opener->data);
+
+    return 0;
+}
+
+static
+void
+destroy_opener(opener_t* opener)
+{
+    _seal_destroy_task(opener->task);
+    free(opener->filename);
+    free(opener);
+}
+
+seal_err_t
+SEAL_API
+seal_open_stream(seal_stream_t* stream, const char* filename, seal_fmt_t fmt)
+{
+    stream->readahead = DEFAULT_READAHEAD;
+    stream->opener = 0;
+
+    return open_stream(stream, filename, fmt);
+}
+
+seal_err_t
+SEAL_API
+seal_open_stream_io(seal_stream_t* stream, seal_io_t* io, seal_fmt_t fmt)
+{
+    seal_err_t err;
+
+    stream->readahead = 0;
+    stream->opener = 0;
+    if (fmt == SEAL_UNKNOWN_FMT
+        && (err = seal_recognize_io_fmt(io, &fmt)) != SEAL_OK) {
+        io->close(io->handle);
+        return err;
+    }
+
+    switch (fmt) {
+    case SEAL_WAV_FMT:
+        return _seal_init_wav_stream_io(stream, io);
+    case SEAL_OV_FMT:
+        return _seal_init_ov_stream_io(stream, io);
+    case SEAL_MPG_FMT:
+        return _seal_init_mpg_stream_io(stream, io);
+    default:
+        io->close(io->handle);
+        return SEAL_BAD_AUDIO;
+    }
+}
+
+seal_err_t
+SEAL_API
+seal_open_stream_async(seal_stream_t* stream, const char* filename,
+                       seal_fmt_t fmt, seal_stream_cb_t* callback, void* data)
+{
+    opener_t* opener;
+
+    opener = malloc(sizeof (opener_t));
+    if (opener == 0)
+        return SEAL_CANNOT_ALLOC_MEM;
+    opener->filename = malloc(strlen(filename) + 1);
+    if (opener->filename == 0)
+        goto cleanup;
+    strcpy(opener->filename, filename);
+    opener->fmt = fmt;
+    opener->err = SEAL_OK;
+    opener->callback = callback;
+    opener->data = data;
+    opener->stream = stream;
+
+    /* Set here so that the stream can be configured while being opened. */
+    stream->readahead = DEFAULT_READAHEAD;
+    stream->id = 0;
+    stream->opener = opener;
+    opener->task = _seal_submit_task(open_in_background, opener);
+    if (opener->task == 0) {
+        stream->opener = 0;
+        goto cleanup;
+    }
+
+    return SEAL_OK;
+
+cleanup:
+    free(opener->filename);
+    free(opener);
+
+    return SEAL_CANNOT_ALLOC_MEM;
+}
+
+seal_err_t
+SEAL_API
+seal_is_stream_opening(seal_stream_t* stream, char* popening)
+{
+    *popening = _seal_is_stream_opening(stream);
+
+    return SEAL_OK;
+}
+
+seal_err_t
+SEAL_API
+seal_wait_stream(seal_stream_t* stream)
+{
+    opener_t* opener = stream->opener;
+
+    if (opener == 0)
+        return SEAL_OK;
+    /* Wakes up now and then to see if the wait is canceled. */
+    if (_seal_is_cancelable()) {
+        while (!_seal_wait_task_for(opener->task, CANCEL_CHECK_INTERVAL))
+            if (_seal_is_canceled())
+                return SEAL_CANCELED;
+    }
+    _seal_wait_task(opener->task);
+
+    return opener->err;
+}
+
+int
+_seal_is_stream_opening(seal_stream_t* stream)
+{
+    opener_t* opener = stream->opener;
+
+    return opener != 0 && !_seal_is_task_done(opener->task);
+}
+
 seal_err_t
 SEAL_API
 seal_stream(seal_stream_t* stream, seal_raw_t* raw, size_t* psize)
 {
+    if (seal_wait_stream(stream) == SEAL_CANCELED)
+        return SEAL_CANCELED;
     if (stream->id == 0)
         return SEAL_STREAM_UNOPENED;
 
@@ -52,10 +215,44 @@ seal_stream(seal_stream_t* stream, seal_raw_t* raw, size_t* psize)
     }
 }
 
+seal_err_t
+SEAL_API
+seal_stream_into(seal_stream_t* stream, seal_raw_t* raw, size_t* psize)
+{
+    seal_err_t err;
+
+    if (seal_wait_stream(stream) == SEAL_CANCELED)
+        return SEAL_CANCELED;
+    if (stream->id == 0)
+        return SEAL_STREAM_UNOPENED;
+
+    switch (stream->fmt) {
+    case SEAL_WAV_FMT:
+        err = _seal_stream_wav_into(stream, raw, psize);
+        break;
+    case SEAL_OV_FMT:
+        err = _seal_stream_ov_into(stream, raw, psize);
+        break;
+    case SEAL_MPG_FMT:
+        err = _seal_stream_mpg_into(stream, raw, psize);
+        break;
+    default:
+        return SEAL_BAD_AUDIO;
+    }
+    if (err == SEAL_OK) {
+        raw->size = *psize;
+        raw->attr = stream->attr;
+    }
+
+    return err;
+}
+
 seal_err_t
 SEAL_API
 seal_rewind_stream(seal_stream_t* stream)
 {
+    if (seal_wait_stream(stream) == SEAL_CANCELED)
+        return SEAL_CANCELED;
     if (stream->id == 0)
         return SEAL_STREAM_UNOPENED;
 
@@ -79,6 +276,11 @@ seal_close_stream(seal_stream_t* stream)
 {
     seal_err_t err;
 
+    if (stream->opener != 0) {
+        seal_wait_stream(stream);
+        destroy_opener(stream->opener);
+        stream->opener = 0;
+    }
     if (stream->id == 0)
         return SEAL_STREAM_UNOPENED;
 
@@ -105,3 +307,35 @@ seal_close_stream(seal_stream_t* stream)
 
     return err;
 }
+
+seal_err_t
+SEAL_API
+seal_set_stream_readahead(seal_stream_t* stream, size_t size)
+{
+    stream->readahead = size;
+
+    return SEAL_OK;
+}
+
+seal_err_t
+SEAL_API
+seal_get_stream_readahead(seal_stream_t* stream, size_t* psize)
+{
+    *psize = stream->readahead;
+
+    return SEAL_OK;
+}
+
+void
+SEAL_API
+seal_set_fast_stream_open(char value)
+{
+    fast_open = value != 0;
+}
+
+char
+SEAL_API
+seal_is_fast_stream_open(void)
+{
+    return fast_open;
+}
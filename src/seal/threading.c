@@ -1,17 +1,31 @@
+#if defined (__linux__)
+/* For `pthread_setaffinity_np' and `syscall'. */
+# define _GNU_SOURCE
+#endif
 #include <stdlib.h>
 #include <stdint.h>
+#include <seal/core.h>
+#include <seal/err.h>
 #include "threading.h"
 
 #if defined (__unix__) || defined (__APPLE_CC__)
 # include <pthread.h>
 # include <unistd.h>
+# include <sched.h>
+# include <errno.h>
+# include <time.h>
+# include <sys/resource.h>
+# if defined (__linux__)
+#  include <sys/syscall.h>
+# endif
 
 void*
 _seal_create_thread(_seal_routine_t* routine, void* args)
 {
     pthread_t thread;
 
-    pthread_create(&thread, 0, routine, args);
+    if (pthread_create(&thread, 0, routine, args) != 0)
+        return 0;
 
     return (void*) thread;
 }
@@ -28,23 +42,331 @@ _seal_calling_thread_is(void* thread)
     return pthread_self() == (pthread_t) thread;
 }
 
+typedef struct event_t
+{
+    pthread_mutex_t mutex;
+    pthread_cond_t  cond;
+    int             signaled;
+} event_t;
+
+void*
+_seal_create_event(void)
+{
+    event_t* event = malloc(sizeof (event_t));
+
+    if (event == 0)
+        return 0;
+    if (pthread_mutex_init(&event->mutex, 0) != 0) {
+        free(event);
+        return 0;
+    }
+    if (pthread_cond_init(&event->cond, 0) != 0) {
+        pthread_mutex_destroy(&event->mutex);
+        free(event);
+        return 0;
+    }
+    event->signaled = 0;
+
+    return event;
+}
+
+void
+_seal_destroy_event(void* _event)
+{
+    event_t* event = _event;
+
+    pthread_cond_destroy(&event->cond);
+    pthread_mutex_destroy(&event->mutex);
+    free(event);
+}
+
+void
+_seal_signal_event(void* _event)
+{
+    event_t* event = _event;
+
+    pthread_mutex_lock(&event->mutex);
+    event->signaled = 1;
+    pthread_cond_broadcast(&event->cond);
+    pthread_mutex_unlock(&event->mutex);
+}
+
+void
+_seal_wait_event(void* _event)
+{
+    event_t* event = _event;
+
+    pthread_mutex_lock(&event->mutex);
+    while (!event->signaled)
+        pthread_cond_wait(&event->cond, &event->mutex);
+    pthread_mutex_unlock(&event->mutex);
+}
+
+int
+_seal_wait_event_for(void* _event, unsigned int millisec)
+{
+    event_t* event = _event;
+    struct timespec deadline;
+    int signaled;
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += millisec / 1000;
+    deadline.tv_nsec += (long) (millisec % 1000) * 1000000;
+    if (deadline.tv_nsec >= 1000000000) {
+        ++deadline.tv_sec;
+        deadline.tv_nsec -= 1000000000;
+    }
+    pthread_mutex_lock(&event->mutex);
+    while (!event->signaled
+           && pthread_cond_timedwait(&event->cond, &event->mutex, &deadline)
+              == 0)
+        ;
+    signaled = event->signaled;
+    pthread_mutex_unlock(&event->mutex);
+
+    return signaled;
+}
+
+int
+_seal_is_event_signaled(void* _event)
+{
+    event_t* event = _event;
+    int signaled;
+
+    pthread_mutex_lock(&event->mutex);
+    signaled = event->signaled;
+    pthread_mutex_unlock(&event->mutex);
+
+    return signaled;
+}
+
+void*
+_seal_create_mutex(void)
+{
+    pthread_mutex_t* mutex = malloc(sizeof (pthread_mutex_t));
+
+    if (mutex == 0)
+        return 0;
+    if (pthread_mutex_init(mutex, 0) != 0) {
+        free(mutex);
+        return 0;
+    }
+
+    return mutex;
+}
+
+void
+_seal_destroy_mutex(void* mutex)
+{
+    pthread_mutex_destroy(mutex);
+    free(mutex);
+}
+
+void
+_seal_lock_mutex(void* mutex)
+{
+    pthread_mutex_lock(mutex);
+}
+
+void
+_seal_unlock_mutex(void* mutex)
+{
+    pthread_mutex_unlock(mutex);
+}
+
+void*
+_seal_create_cond(void)
+{
+    pthread_cond_t* cond = malloc(sizeof (pthread_cond_t));
+
+    if (cond == 0)
+        return 0;
+    if (pthread_cond_init(cond, 0) != 0) {
+        free(cond);
+        return 0;
+    }
+
+    return cond;
+}
+
+void
+_seal_destroy_cond(void* cond)
+{
+    pthread_cond_destroy(cond);
+    free(cond);
+}
+
+void
+_seal_wait_cond(void* cond, void* mutex)
+{
+    pthread_cond_wait(cond, mutex);
+}
+
+void
+_seal_signal_cond(void* cond)
+{
+    pthread_cond_signal(cond);
+}
+
+void
+_seal_broadcast_cond(void* cond)
+{
+    pthread_cond_broadcast(cond);
+}
+
+long
+_seal_cas_long(volatile long* dst, long expected, long desired)
+{
+    return __sync_val_compare_and_swap(dst, expected, desired);
+}
+
+long
+_seal_swap_long(volatile long* dst, long val)
+{
+    long old;
+
+    do
+        old = *dst;
+    while (__sync_val_compare_and_swap(dst, old, val) != old);
+
+    return old;
+}
+
+int
+_seal_get_ncpus(void)
+{
+    long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return ncpus > 0 ? (int) ncpus : 1;
+}
+
+int
+_seal_pin_calling_thread(int cpu)
+{
+#if defined (__linux__)
+    cpu_set_t set;
+
+    if (cpu < 0 || cpu >= CPU_SETSIZE)
+        return 0;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+
+    return pthread_setaffinity_np(pthread_self(), sizeof set, &set) == 0;
+#else
+    return 0;
+#endif
+}
+
+/*
+ * Schedules the calling thread with some settings, as far as permitted.
+ *
+ * @param sched     the settings to ask for
+ * @param pobtained the receiver of the settings obtained
+ */
+static
+void
+sched_calling_thread(const seal_sched_t* sched, seal_sched_t* pobtained)
+{
+    pthread_t self = pthread_self();
+    struct sched_param param;
+    int policy, min, max;
+
+    pobtained->policy = SEAL_DEFAULT_SCHED;
+    pobtained->priority = 0;
+    pobtained->nice = 0;
+    pobtained->cpu_mask = 0;
+
+    if (sched->policy != SEAL_DEFAULT_SCHED) {
+        policy = sched->policy == SEAL_FIFO_SCHED ? SCHED_FIFO : SCHED_RR;
+        min = sched_get_priority_min(policy);
+        max = sched_get_priority_max(policy);
+        param.sched_priority = sched->priority < min ? min
+                               : sched->priority > max ? max
+                               : sched->priority;
+        if (pthread_setschedparam(self, policy, &param) == 0
+            && pthread_getschedparam(self, &policy, &param) == 0
+            && (policy == SCHED_FIFO || policy == SCHED_RR)) {
+            pobtained->policy = policy == SCHED_FIFO ? SEAL_FIFO_SCHED
+                                                     : SEAL_RR_SCHED;
+            pobtained->priority = param.sched_priority;
+        }
+    }
+
+#if defined (__linux__)
+    /* Linux keeps a nice level per thread, unlike the other systems. */
+    if (pobtained->policy == SEAL_DEFAULT_SCHED && sched->nice != 0) {
+        id_t tid = (id_t) syscall(SYS_gettid);
+        int old, now;
+
+        errno = 0;
+        old = getpriority(PRIO_PROCESS, tid);
+        if (errno == 0) {
+            setpriority(PRIO_PROCESS, tid, old + sched->nice);
+            errno = 0;
+            now = getpriority(PRIO_PROCESS, tid);
+            if (errno == 0)
+                pobtained->nice = now - old;
+        }
+    }
+
+    if (sched->cpu_mask != 0) {
+        cpu_set_t set;
+        size_t i;
+
+        CPU_ZERO(&set);
+        for (i = 0; i < sizeof sched->cpu_mask * 8 && i < CPU_SETSIZE; ++i)
+            if (sched->cpu_mask >> i & 1)
+                CPU_SET(i, &set);
+        if (pthread_setaffinity_np(self, sizeof set, &set) == 0
+            && pthread_getaffinity_np(self, sizeof set, &set) == 0) {
+            for (i = 0; i < sizeof sched->cpu_mask * 8 && i < CPU_SETSIZE;
+                 ++i)
+                if (CPU_ISSET(i, &set))
+                    pobtained->cpu_mask |= 1UL << i;
+        }
+    }
+#endif
+}
+
+/* Locks that can be initialized statically. */
+typedef pthread_mutex_t static_lock_t;
+#define STATIC_LOCK_INITIALIZER PTHREAD_MUTEX_INITIALIZER
+
+static
+void
+lock_static(static_lock_t* lock)
+{
+    pthread_mutex_lock(lock);
+}
+
+static
+void
+unlock_static(static_lock_t* lock)
+{
+    pthread_mutex_unlock(lock);
+}
+
 #elif defined (_WIN32)
-# define _WIN32_WINNT 0x0500
+/* Vista for condition variables and slim reader/writer locks. */
+# define _WIN32_WINNT 0x0600
 # include <Windows.h>
 
 void*
 _seal_create_thread(_seal_routine_t* routine, void* args)
 {
     DWORD thread;
-
-    CloseHandle(CreateThread(
+    HANDLE handle = CreateThread(
         0,
         0,
         (LPTHREAD_START_ROUTINE) routine,
         args,
         0,
         &thread
-    ));
+    );
+
+    if (handle == 0)
+        return 0;
+    CloseHandle(handle);
 
     return (void*) thread;
 }
@@ -63,4 +385,744 @@ _seal_calling_thread_is(void* thread)
     return GetCurrentThreadId() == (DWORD) thread;
 }
 
+void*
+_seal_create_event(void)
+{
+    return CreateEvent(0, TRUE, FALSE, 0);
+}
+
+void
+_seal_destroy_event(void* event)
+{
+    CloseHandle(event);
+}
+
+void
+_seal_signal_event(void* event)
+{
+    SetEvent(event);
+}
+
+void
+_seal_wait_event(void* event)
+{
+    WaitForSingleObject(event, INFINITE);
+}
+
+int
+_seal_wait_event_for(void* event, unsigned int millisec)
+{
+    return WaitForSingleObject(event, millisec) == WAIT_OBJECT_0;
+}
+
+int
+_seal_is_event_signaled(void* event)
+{
+    return WaitForSingleObject(event, 0) == WAIT_OBJECT_0;
+}
+
+void*
+_seal_create_mutex(void)
+{
+    CRITICAL_SECTION* mutex = malloc(sizeof (CRITICAL_SECTION));
+
+    if (mutex != 0)
+        InitializeCriticalSection(mutex);
+
+    return mutex;
+}
+
+void
+_seal_destroy_mutex(void* mutex)
+{
+    DeleteCriticalSection(mutex);
+    free(mutex);
+}
+
+void
+_seal_lock_mutex(void* mutex)
+{
+    EnterCriticalSection(mutex);
+}
+
+void
+_seal_unlock_mutex(void* mutex)
+{
+    LeaveCriticalSection(mutex);
+}
+
+void*
+_seal_create_cond(void)
+{
+    CONDITION_VARIABLE* cond = malloc(sizeof (CONDITION_VARIABLE));
+
+    if (cond != 0)
+        InitializeConditionVariable(cond);
+
+    return cond;
+}
+
+void
+_seal_destroy_cond(void* cond)
+{
+    free(cond);
+}
+
+void
+_seal_wait_cond(void* cond, void* mutex)
+{
+    SleepConditionVariableCS(cond, mutex, INFINITE);
+}
+
+void
+_seal_signal_cond(void* cond)
+{
+    WakeConditionVariable(cond);
+}
+
+void
+_seal_broadcast_cond(void* cond)
+{
+    WakeAllConditionVariable(cond);
+}
+
+long
+_seal_cas_long(volatile long* dst, long expected, long desired)
+{
+    return InterlockedCompareExchange(dst, desired, expected);
+}
+
+long
+_seal_swap_long(volatile long* dst, long val)
+{
+    return InterlockedExchange(dst, val);
+}
+
+int
+_seal_get_ncpus(void)
+{
+    SYSTEM_INFO info;
+
+    GetSystemInfo(&info);
+
+    return info.dwNumberOfProcessors > 0 ? (int) info.dwNumberOfProcessors : 1;
+}
+
+int
+_seal_pin_calling_thread(int cpu)
+{
+    if (cpu < 0 || cpu >= (int) sizeof (DWORD_PTR) * 8)
+        return 0;
+
+    return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR) 1 << cpu)
+           != 0;
+}
+
+/*
+ * Schedules the calling thread with some settings, as far as permitted.
+ * Real-time policies get the highest priority, which is reported as the
+ * lowest nice level as there is no real-time policy to report, and nice
+ * levels the priorities around the normal one.
+ *
+ * @param sched     the settings to ask for
+ * @param pobtained the receiver of the settings obtained
+ */
+static
+void
+sched_calling_thread(const seal_sched_t* sched, seal_sched_t* pobtained)
+{
+    enum { MIN_NICE = -20 };
+    HANDLE self = GetCurrentThread();
+    int priority;
+
+    pobtained->policy = SEAL_DEFAULT_SCHED;
+    pobtained->priority = 0;
+    pobtained->nice = 0;
+    pobtained->cpu_mask = 0;
+
+    if (sched->policy != SEAL_DEFAULT_SCHED
+        && SetThreadPriority(self, THREAD_PRIORITY_TIME_CRITICAL)) {
+        pobtained->nice = MIN_NICE;
+    } else if (sched->nice != 0) {
+        if (sched->nice <= MIN_NICE)
+            priority = THREAD_PRIORITY_TIME_CRITICAL;
+        else if (sched->nice <= -10)
+            priority = THREAD_PRIORITY_HIGHEST;
+        else if (sched->nice < 0)
+            priority = THREAD_PRIORITY_ABOVE_NORMAL;
+        else if (sched->nice < 10)
+            priority = THREAD_PRIORITY_BELOW_NORMAL;
+        else
+            priority = THREAD_PRIORITY_LOWEST;
+        if (SetThreadPriority(self, priority))
+            pobtained->nice = sched->nice;
+    }
+
+    if (sched->cpu_mask != 0
+        && SetThreadAffinityMask(self, (DWORD_PTR) sched->cpu_mask) != 0)
+        pobtained->cpu_mask = sched->cpu_mask;
+}
+
+/* Locks that can be initialized statically. */
+typedef SRWLOCK static_lock_t;
+#define STATIC_LOCK_INITIALIZER SRWLOCK_INIT
+
+static
+void
+lock_static(static_lock_t* lock)
+{
+    AcquireSRWLockExclusive(lock);
+}
+
+static
+void
+unlock_static(static_lock_t* lock)
+{
+    ReleaseSRWLockExclusive(lock);
+}
+
 #endif /* __unix__, _WIN32 */
+
+static static_lock_t lazy_init_lock = STATIC_LOCK_INITIALIZER;
+
+void
+_seal_lock_lazy_init(void)
+{
+    lock_static(&lazy_init_lock);
+}
+
+void
+_seal_unlock_lazy_init(void)
+{
+    unlock_static(&lazy_init_lock);
+}
+
+/* Guards `streaming_sched'. */
+static static_lock_t sched_lock = STATIC_LOCK_INITIALIZER;
+/* How the updater threads of streaming sources are scheduled. */
+static seal_sched_t streaming_sched = { SEAL_DEFAULT_SCHED, 0, 0, 0 };
+
+typedef struct probe_t
+{
+    const seal_sched_t* sched;
+    seal_sched_t        obtained;
+} probe_t;
+
+static
+void*
+probe_sched(void* args)
+{
+    probe_t* probe = args;
+
+    sched_calling_thread(probe->sched, &probe->obtained);
+
+    return 0;
+}
+
+seal_err_t
+SEAL_API
+seal_set_streaming_sched(const seal_sched_t* sched, seal_sched_t* pobtained)
+{
+    probe_t probe = { 0, { SEAL_DEFAULT_SCHED, 0, 0, 0 } };
+    void* thread;
+
+    if (sched->policy != SEAL_DEFAULT_SCHED && sched->policy != SEAL_FIFO_SCHED
+        && sched->policy != SEAL_RR_SCHED)
+        return SEAL_BAD_ENUM;
+
+    /* Tried on a thread of its own so that the caller stays as it is. */
+    probe.sched = sched;
+    if ((thread = _seal_create_thread(probe_sched, &probe)) == 0)
+        return SEAL_CANNOT_ALLOC_MEM;
+    _seal_join_thread(thread);
+
+    lock_static(&sched_lock);
+    streaming_sched = probe.obtained;
+    unlock_static(&sched_lock);
+    if (pobtained != 0)
+        *pobtained = probe.obtained;
+
+    return SEAL_OK;
+}
+
+seal_err_t
+SEAL_API
+seal_get_streaming_sched(seal_sched_t* psched)
+{
+    lock_static(&sched_lock);
+    *psched = streaming_sched;
+    unlock_static(&sched_lock);
+
+    return SEAL_OK;
+}
+
+void
+_seal_sched_streaming_thread(void)
+{
+    seal_sched_t sched, obtained;
+
+    lock_static(&sched_lock);
+    sched = streaming_sched;
+    unlock_static(&sched_lock);
+    if (sched.policy != SEAL_DEFAULT_SCHED || sched.nice != 0
+        || sched.cpu_mask != 0)
+        sched_calling_thread(&sched, &obtained);
+}
+
+/*
+ *****************************************************************************
+ * The worker pool, built on the primitives above.
+ *****************************************************************************
+ */
+
+typedef struct deque_t
+{
+    void*           mutex;
+    /* A ring buffer, with the oldest task at index `top'. */
+    _seal_task_t**  tasks;
+    size_t          top;
+    size_t          len;
+    size_t          cap;
+} deque_t;
+
+typedef struct worker_t
+{
+    void*   thread;
+    size_t  index;
+    /* The processor to pin the worker to, or -1. */
+    int     cpu;
+    deque_t deque;
+} worker_t;
+
+struct _seal_task_t
+{
+    _seal_routine_t*    routine;
+    void*               args;
+    void*               result;
+    void*               done;
+};
+
+enum { INITIAL_DEQUE_CAP = 16 };
+
+/*
+ * Guards the settings below and the starting and stopping of the workers. Not
+ * the lazy initialization lock, which tasks may need while being joined.
+ */
+static static_lock_t pool_lock = STATIC_LOCK_INITIALIZER;
+/* The number of workers to start, or 0 for the default. */
+static size_t worker_count = 0;
+static char worker_affinity = 0;
+
+/* 0 while the workers are stopped. */
+static worker_t* workers = 0;
+static size_t nworkers = 0;
+/* Tasks submitted by threads other than the workers. */
+static deque_t shared;
+/* Guards the two below; idle workers sleep on `wakeup'. */
+static void* pool_mutex;
+static void* wakeup;
+/* The number of tasks in the deques. */
+static size_t npending;
+static char stopping;
+
+static _SEAL_THREAD_LOCAL worker_t* current_worker = 0;
+
+static
+size_t
+get_default_worker_count(void)
+{
+    int ncpus = _seal_get_ncpus();
+
+    /* Leaves a processor to the thread driving Seal. */
+    return ncpus > 1 ? ncpus - 1 : 1;
+}
+
+static
+int
+init_deque(deque_t* deque)
+{
+    deque->tasks = 0;
+    deque->top = 0;
+    deque->len = 0;
+    deque->cap = 0;
+
+    return (deque->mutex = _seal_create_mutex()) != 0;
+}
+
+static
+void
+destroy_deque(deque_t* deque)
+{
+    _seal_destroy_mutex(deque->mutex);
+    free(deque->tasks);
+}
+
+static
+int
+push(deque_t* deque, _seal_task_t* task)
+{
+    int ok = 1;
+
+    _seal_lock_mutex(deque->mutex);
+    if (deque->len == deque->cap) {
+        size_t cap = deque->cap > 0 ? deque->cap * 2 : INITIAL_DEQUE_CAP;
+        _seal_task_t** tasks = malloc(cap * sizeof (_seal_task_t*));
+        size_t i;
+
+        if (tasks != 0) {
+            for (i = 0; i < deque->len; ++i)
+                tasks[i] = deque->tasks[(deque->top + i) % deque->cap];
+            free(deque->tasks);
+            deque->tasks = tasks;
+            deque->top = 0;
+            deque->cap = cap;
+        } else {
+            ok = 0;
+        }
+    }
+    if (ok)
+        deque->tasks[(deque->top + deque->len++) % deque->cap] = task;
+    _seal_unlock_mutex(deque->mutex);
+
+    return ok;
+}
+
+/* Takes the newest task, which is what its owner does. */
+static
+_seal_task_t*
+pop_bottom(deque_t* deque)
+{
+    _seal_task_t* task = 0;
+
+    _seal_lock_mutex(deque->mutex);
+    if (deque->len > 0) {
+        --deque->len;
+        task = deque->tasks[(deque->top + deque->len) % deque->cap];
+    }
+    _seal_unlock_mutex(deque->mutex);
+
+    return task;
+}
+
+/* Takes the oldest task, which is what thieves do. */
+static
+_seal_task_t*
+pop_top(deque_t* deque)
+{
+    _seal_task_t* task = 0;
+
+    _seal_lock_mutex(deque->mutex);
+    if (deque->len > 0) {
+        task = deque->tasks[deque->top];
+        deque->top = (deque->top + 1) % deque->cap;
+        --deque->len;
+    }
+    _seal_unlock_mutex(deque->mutex);
+
+    return task;
+}
+
+/*
+ * Takes a task for a worker: its own newest task, or else the oldest one
+ * submitted from outside, or else the oldest one of another worker.
+ */
+static
+_seal_task_t*
+take(worker_t* worker)
+{
+    _seal_task_t* task = pop_bottom(&worker->deque);
+    size_t i;
+
+    if (task == 0)
+        task = pop_top(&shared);
+    /* Starts with the next worker so that thieves spread out. */
+    for (i = 1; task == 0 && i < nworkers; ++i)
+        task = pop_top(&workers[(worker->index + i) % nworkers].deque);
+    if (task != 0) {
+        _seal_lock_mutex(pool_mutex);
+        --npending;
+        _seal_unlock_mutex(pool_mutex);
+    }
+
+    return task;
+}
+
+static
+void
+run(_seal_task_t* task)
+{
+    task->result = task->routine(task->args);
+    _seal_signal_event(task->done);
+}
+
+/*
+ * The main routine for workers, which exit once stopped and there are no
+ * tasks left.
+ */
+static
+void*
+work(void* args)
+{
+    worker_t* worker = args;
+    _seal_task_t* task;
+    int exiting;
+
+    current_worker = worker;
+    if (worker->cpu >= 0)
+        _seal_pin_calling_thread(worker->cpu);
+
+    for (;;) {
+        if ((task = take(worker)) != 0) {
+            run(task);
+            continue;
+        }
+        _seal_lock_mutex(pool_mutex);
+        while (npending == 0 && !stopping)
+            _seal_wait_cond(wakeup, pool_mutex);
+        exiting = npending == 0;
+        _seal_unlock_mutex(pool_mutex);
+        if (exiting)
+            break;
+    }
+
+    return 0;
+}
+
+/* Starts the workers; called with `pool_lock' held. */
+static
+int
+start_workers(void)
+{
+    size_t count = worker_count > 0 ? worker_count
+                                    : get_default_worker_count();
+    int ncpus = _seal_get_ncpus();
+    size_t i;
+
+    if ((workers = calloc(count, sizeof (worker_t))) == 0)
+        return 0;
+    if ((pool_mutex = _seal_create_mutex()) == 0)
+        goto clean_workers;
+    if ((wakeup = _seal_create_cond()) == 0)
+        goto clean_mutex;
+    if (!init_deque(&shared))
+        goto clean_cond;
+    for (i = 0; i < count; ++i) {
+        if (!init_deque(&workers[i].deque))
+            goto clean_deques;
+    }
+
+    npending = 0;
+    stopping = 0;
+    nworkers = count;
+    for (i = 0; i < count; ++i) {
+        workers[i].index = i;
+        workers[i].cpu = worker_affinity ? (int) (i % ncpus) : -1;
+    }
+    /*
+     * Makes do with the workers that could be started; the deques of the
+     * others stay empty, so stealing from them is harmless.
+     */
+    for (i = 0; i < count; ++i)
+        if ((workers[i].thread = _seal_create_thread(work, workers + i)) == 0)
+            break;
+    if (i > 0)
+        return 1;
+
+    nworkers = 0;
+    i = count;
+
+clean_deques:
+    while (i-- > 0)
+        destroy_deque(&workers[i].deque);
+    destroy_deque(&shared);
+clean_cond:
+    _seal_destroy_cond(wakeup);
+clean_mutex:
+    _seal_destroy_mutex(pool_mutex);
+clean_workers:
+    free(workers);
+    workers = 0;
+
+    return 0;
+}
+
+/*
+ * Pushes a task and wakes up a worker. The task is counted before it can be
+ * taken, which uncounts it, so that `npending' never wraps around.
+ */
+static
+int
+enqueue(deque_t* deque, _seal_task_t* task)
+{
+    int ok;
+
+    _seal_lock_mutex(pool_mutex);
+    ++npending;
+    _seal_unlock_mutex(pool_mutex);
+    ok = push(deque, task);
+    _seal_lock_mutex(pool_mutex);
+    if (ok)
+        _seal_signal_cond(wakeup);
+    else
+        --npending;
+    _seal_unlock_mutex(pool_mutex);
+
+    return ok;
+}
+
+/* Stops the workers; called with `pool_lock' held. */
+static
+void
+stop_workers(void)
+{
+    size_t i;
+
+    if (workers == 0)
+        return;
+
+    _seal_lock_mutex(pool_mutex);
+    stopping = 1;
+    _seal_broadcast_cond(wakeup);
+    _seal_unlock_mutex(pool_mutex);
+    for (i = 0; i < nworkers && workers[i].thread != 0; ++i)
+        _seal_join_thread(workers[i].thread);
+
+    for (i = 0; i < nworkers; ++i)
+        destroy_deque(&workers[i].deque);
+    destroy_deque(&shared);
+    _seal_destroy_cond(wakeup);
+    _seal_destroy_mutex(pool_mutex);
+    free(workers);
+    workers = 0;
+    nworkers = 0;
+}
+
+_seal_task_t*
+_seal_submit_task(_seal_routine_t* routine, void* args)
+{
+    _seal_task_t* task;
+    int ok;
+
+    if ((task = malloc(sizeof (_seal_task_t))) == 0)
+        return 0;
+    if ((task->done = _seal_create_event()) == 0) {
+        free(task);
+        return 0;
+    }
+    task->routine = routine;
+    task->args = args;
+    task->result = 0;
+
+    /* Workers are never stopped while running tasks. */
+    if (current_worker != 0) {
+        ok = enqueue(&current_worker->deque, task);
+    } else {
+        lock_static(&pool_lock);
+        ok = (workers != 0 || start_workers()) && enqueue(&shared, task);
+        unlock_static(&pool_lock);
+    }
+
+    if (!ok) {
+        _seal_destroy_event(task->done);
+        free(task);
+        return 0;
+    }
+
+    return task;
+}
+
+void*
+_seal_wait_task(_seal_task_t* task)
+{
+    _seal_task_t* other;
+
+    /* Blocking a worker could leave the task nobody to run it. */
+    while (current_worker != 0 && !_seal_is_event_signaled(task->done)) {
+        if ((other = take(current_worker)) == 0)
+            break;
+        run(other);
+    }
+    _seal_wait_event(task->done);
+
+    return task->result;
+}
+
+int
+_seal_is_task_done(_seal_task_t* task)
+{
+    return _seal_is_event_signaled(task->done);
+}
+
+int
+_seal_wait_task_for(_seal_task_t* task, unsigned int millisec)
+{
+    return _seal_wait_event_for(task->done, millisec);
+}
+
+void
+_seal_destroy_task(_seal_task_t* task)
+{
+    _seal_wait_task(task);
+    _seal_destroy_event(task->done);
+    free(task);
+}
+
+void
+_seal_stop_workers(void)
+{
+    lock_static(&pool_lock);
+    stop_workers();
+    unlock_static(&pool_lock);
+}
+
+seal_err_t
+SEAL_API
+seal_set_worker_count(size_t count)
+{
+    if (count == 0)
+        return SEAL_BAD_VAL;
+    if (current_worker != 0)
+        return SEAL_BAD_OP;
+
+    lock_static(&pool_lock);
+    stop_workers();
+    worker_count = count;
+    unlock_static(&pool_lock);
+
+    return SEAL_OK;
+}
+
+size_t
+SEAL_API
+seal_get_worker_count(void)
+{
+    size_t count;
+
+    lock_static(&pool_lock);
+    count = worker_count > 0 ? worker_count : get_default_worker_count();
+    unlock_static(&pool_lock);
+
+    return count;
+}
+
+seal_err_t
+SEAL_API
+seal_set_worker_affinity(char affinity)
+{
+    if (current_worker != 0)
+        return SEAL_BAD_OP;
+
+    lock_static(&pool_lock);
+    stop_workers();
+    worker_affinity = affinity != 0;
+    unlock_static(&pool_lock);
+
+    return SEAL_OK;
+}
+
+char
+SEAL_API
+seal_has_worker_affinity(void)
+{
+    return worker_affinity;
+}
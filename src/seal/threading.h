@@ -7,9 +7,125 @@
 
 typedef void* _seal_routine_t(void*);
 
-/* Thread manipulations. */
+/* Storage class of variables each thread has its own copy of. */
+#if defined (_MSC_VER)
+# define _SEAL_THREAD_LOCAL __declspec(thread)
+#else
+# define _SEAL_THREAD_LOCAL __thread
+#endif
+
+/* Thread manipulations. `_seal_create_thread' returns 0 on failure. */
 void* _seal_create_thread(_seal_routine_t*, void* /*args*/);
 void _seal_join_thread(void* /*thread*/);
 int _seal_calling_thread_is(void* /*thread*/);
 
+/*
+ * Manual-reset events: once signaled, an event stays signaled and every
+ * current and future wait on it returns immediately. `_seal_create_event'
+ * returns 0 on failure.
+ */
+void* _seal_create_event(void);
+void _seal_destroy_event(void* /*event*/);
+void _seal_signal_event(void* /*event*/);
+void _seal_wait_event(void* /*event*/);
+/* @return  1 if signaled within some milliseconds or otherwise 0 */
+int _seal_wait_event_for(void* /*event*/, unsigned int /*millisec*/);
+int _seal_is_event_signaled(void* /*event*/);
+
+/*
+ * Mutexes and condition variables. The create functions return 0 on
+ * failure. Waiting on a condition variable releases the mutex, which must be
+ * locked by the calling thread, and locks it again before returning; waits
+ * may wake up spuriously.
+ */
+void* _seal_create_mutex(void);
+void _seal_destroy_mutex(void* /*mutex*/);
+void _seal_lock_mutex(void* /*mutex*/);
+void _seal_unlock_mutex(void* /*mutex*/);
+void* _seal_create_cond(void);
+void _seal_destroy_cond(void* /*cond*/);
+void _seal_wait_cond(void* /*cond*/, void* /*mutex*/);
+void _seal_signal_cond(void* /*cond*/);
+void _seal_broadcast_cond(void* /*cond*/);
+
+/*
+ * Atomic operations on longs. `_seal_cas_long' replaces the value with
+ * `desired' if it is `expected' and `_seal_swap_long' replaces it
+ * unconditionally; both return the previous value.
+ */
+long _seal_cas_long(volatile long*, long /*expected*/, long /*desired*/);
+long _seal_swap_long(volatile long*, long /*val*/);
+
+/* @return  the number of processors online, at least 1 */
+int _seal_get_ncpus(void);
+
+/*
+ * Asks for the calling thread to run on a single processor. Only a hint:
+ * not every platform supports it.
+ *
+ * @return  1 if the thread was pinned or otherwise 0
+ */
+int _seal_pin_calling_thread(int /*cpu*/);
+
+/*
+ * Schedules the calling thread as set by `seal_set_streaming_sched'; called
+ * by the updater threads of streaming sources as they start.
+ */
+void _seal_sched_streaming_thread(void);
+
+/*
+ * A process-wide lock over the lazy initialization of optional subsystems,
+ * which needs no setup so that it can be taken before `seal_startup' and
+ * from any thread.
+ */
+void _seal_lock_lazy_init(void);
+void _seal_unlock_lazy_init(void);
+
+/*
+ * The worker pool, which runs short background work such as opening streams
+ * asynchronously. The workers are started on the first submission, with the
+ * count and affinity set by `seal_set_worker_count' and
+ * `seal_set_worker_affinity'. Each worker has a deque of its own: tasks
+ * submitted by a worker go to the bottom of its deque, where the worker
+ * takes them back first, while idle workers steal the oldest tasks from the
+ * top of the others' deques. Tasks submitted by other threads are queued in
+ * order in a shared queue.
+ */
+typedef struct _seal_task_t _seal_task_t;
+
+/*
+ * Submits a routine to the worker pool.
+ *
+ * @return  the handle of the task, which has to be passed to
+ *          `_seal_destroy_task' eventually, or 0 on failure
+ */
+_seal_task_t* _seal_submit_task(_seal_routine_t*, void* /*args*/);
+
+/*
+ * Waits until a task is done. A worker runs other tasks meanwhile instead of
+ * blocking, so tasks can wait on tasks they submit.
+ *
+ * @return  what the routine of the task returned
+ */
+void* _seal_wait_task(_seal_task_t*);
+
+int _seal_is_task_done(_seal_task_t*);
+
+/*
+ * Waits some milliseconds at most for a task to be done, without running
+ * other tasks.
+ *
+ * @return  1 if the task is done or otherwise 0
+ */
+int _seal_wait_task_for(_seal_task_t*, unsigned int /*millisec*/);
+
+/* Waits until a task is done and releases its handle. */
+void _seal_destroy_task(_seal_task_t*);
+
+/*
+ * Lets the workers finish all the submitted tasks and joins them. The next
+ * submission starts the workers again. Must not be called from a worker.
+ */
+void _seal_stop_workers(void);
+
 #endif /* _SEAL_THREADING_H_ */
\ No newline at end of file
@@ -2,8 +2,10 @@
 #include <stdio.h>
 #include <seal/raw.h>
 #include <seal/stream.h>
+#include <seal/io.h>
 #include <seal/err.h>
 #include "reader.h"
+#include "adpcm.h"
 #include "wav.h"
 
 enum
@@ -31,27 +33,77 @@ enum io_state_t
 
 struct wav_stream_t
 {
-    FILE*    file;
-    uint32_t base_offset;
-    uint32_t offset;
-    uint32_t end_offset;
+    seal_io_t     io;
+    uint32_t      base_offset;
+    uint32_t      offset;
+    uint32_t      end_offset;
+    _seal_adpcm_t adpcm;
 };
 
 typedef enum io_state_t io_state_t;
 typedef struct wav_stream_t wav_stream_t;
 
 static const uint16_t PCM_CODE       = 1;
+static const uint16_t MS_ADPCM_CODE  = 2;
+static const uint16_t IMA_ADPCM_CODE = 0x11;
 static const uint32_t CHUNK_MIN_SIZE = 4;
 
+/*
+ * Reads the extra format data of Microsoft ADPCM, which is the coefficient
+ * table, and returns the number of bytes read.
+ */
+static
+uint32_t
+read_msadpcm_coefs(
+    _seal_adpcm_t* adpcm,
+    uint32_t nbytes_left,
+    seal_io_t* wav
+)
+{
+    uint16_t ncoefs = 0;
+
+    /* Falls back to the standard table if the extra data are missing. */
+    if (nbytes_left < 6) {
+        _seal_init_msadpcm_coefs(adpcm);
+        return 0;
+    }
+
+    /* The extra data size and the number of samples per block are ignored. */
+    _seal_skip(4, wav);
+    _seal_read_uint16le(&ncoefs, 1, wav);
+    if (ncoefs > _SEAL_MAX_MSADPCM_NCOEFS
+        || nbytes_left - 6 < ncoefs * 4u) {
+        /* Caller is failing anyway. */
+        adpcm->ncoefs = 0;
+        return 6;
+    }
+    adpcm->ncoefs = ncoefs;
+    _seal_read_uint16le((uint16_t*) adpcm->coefs, ncoefs * 2, wav);
+
+    return 6 + ncoefs * 4;
+}
+
 static
 seal_err_t
-read_fmt_(seal_raw_attr_t* attr, uint32_t chunk_size, FILE* wav)
+read_fmt_(
+    seal_raw_attr_t* attr,
+    _seal_adpcm_t* adpcm,
+    uint32_t chunk_size,
+    seal_io_t* wav
+)
 {
     uint16_t compression_code = 0;
-    uint16_t nchannels = 0, bit_depth = 0;
+    uint16_t nchannels = 0, bit_depth = 0, block_align = 0;
+    uint32_t nbytes_left = chunk_size - 16;
 
     _seal_read_uint16le(&compression_code, 1, wav);
-    if (compression_code != PCM_CODE)
+    if (compression_code == PCM_CODE)
+        adpcm->codec = _SEAL_NO_ADPCM;
+    else if (compression_code == IMA_ADPCM_CODE)
+        adpcm->codec = _SEAL_IMA_ADPCM;
+    else if (compression_code == MS_ADPCM_CODE)
+        adpcm->codec = _SEAL_MS_ADPCM;
+    else
         return SEAL_BAD_WAV_SUBTYPE;
 
     _seal_read_uint16le(&nchannels, 1, wav);
@@ -60,74 +112,99 @@ read_fmt_(seal_raw_attr_t* attr, uint32_t chunk_size, FILE* wav)
     if (attr->freq == 0)
         return FILE_BAD_WAV_FREQ;
 
-    /* average B/s and block align are ignored. */
-    _seal_skip(6, wav);
+    /* average B/s is ignored. */
+    _seal_skip(4, wav);
 
+    _seal_read_uint16le(&block_align, 1, wav);
     _seal_read_uint16le(&bit_depth, 1, wav);
 
     attr->nchannels = nchannels;
     attr->bit_depth = bit_depth;
 
+    if (adpcm->codec == _SEAL_MS_ADPCM && chunk_size >= 16)
+        nbytes_left -= read_msadpcm_coefs(adpcm, nbytes_left, wav);
+
     /* Extra format data are ignored. */
-    _seal_skip(chunk_size - 16, wav);
+    _seal_skip(nbytes_left, wav);
+
+    if (adpcm->codec != _SEAL_NO_ADPCM) {
+        if (nchannels < 1 || nchannels > 2)
+            return SEAL_BAD_WAV_NCHANNELS;
+        adpcm->block_align = block_align;
+        adpcm->nframes_per_block = _seal_get_adpcm_nframes(adpcm->codec,
+                                                           block_align,
+                                                           nchannels);
+        if (adpcm->nframes_per_block == 0)
+            return SEAL_BAD_WAV_SUBTYPE;
+        if (adpcm->codec == _SEAL_MS_ADPCM && adpcm->ncoefs == 0)
+            return SEAL_BAD_WAV_SUBTYPE;
+    }
 
     return SEAL_OK;
 }
 
 static
 seal_err_t
-read_data(seal_raw_t* raw, uint32_t chunk_size, FILE* wav)
+read_data(seal_raw_t* raw, uint32_t chunk_size, seal_io_t* wav)
 {
     seal_err_t err;
 
     if ((err = seal_alloc_raw_data(raw, chunk_size)) != SEAL_OK)
         return err;
 
-    fread(raw->data, 1, chunk_size, wav);
+    wav->read(wav->handle, raw->data, chunk_size);
 
     return SEAL_OK;
 }
 
+/*
+ * Leaves the I/O object at the start of the data so that streaming can begin
+ * right away without reading through the data or seeking back to it. The
+ * format chunk always precedes the data chunk, so no chunk after it matters.
+ */
 static
 void
 prepare_data(wav_stream_t* wav_stream, uint32_t chunk_size)
 {
-    wav_stream->offset = wav_stream->base_offset = ftell(wav_stream->file);
+    seal_io_t* wav = &wav_stream->io;
+
+    wav_stream->offset = wav_stream->base_offset = wav->tell(wav->handle);
     wav_stream->end_offset = wav_stream->base_offset + chunk_size;
-    _seal_skip(chunk_size, wav_stream->file);
 }
 
 static
 seal_err_t
 read_chunk(
     seal_raw_t* raw,
+    _seal_adpcm_t* adpcm,
     wav_stream_t* wav_stream,
-    FILE* wav,
+    seal_io_t* wav,
     io_state_t* pstate
 )
 {
     uint32_t chunk_id, chunk_size = 0;
     seal_err_t err = SEAL_OK;
 
-    _seal_read_uint32le(&chunk_id, 1, wav);
-    if (feof(wav)) {
+    if (_seal_read_uint32le(&chunk_id, 1, wav) == 0) {
         *pstate = NO_MORE_CHUNKS;
         return SEAL_OK;
     }
 
     _seal_read_uint32le(&chunk_size, 1, wav);
-    if (chunk_size <= CHUNK_MIN_SIZE)
+    if (chunk_size < CHUNK_MIN_SIZE)
         return SEAL_BAD_WAV_CHUNK_SIZE;
 
     switch (chunk_id) {
     case FMT_:
-        err = read_fmt_(&raw->attr, chunk_size, wav);
+        err = read_fmt_(&raw->attr, adpcm, chunk_size, wav);
         break;
     case DATA:
-        if (wav_stream != 0)
+        if (wav_stream != 0) {
             prepare_data(wav_stream, chunk_size);
-        else
-            err = read_data(raw, chunk_size, wav);
+            *pstate = NO_MORE_CHUNKS;
+            return SEAL_OK;
+        }
+        err = read_data(raw, chunk_size, wav);
         break;
     case FACT:
     case WAVL:
@@ -154,15 +231,22 @@ read_chunk(
 
 static
 seal_err_t
-read_chunks(seal_raw_t* raw, wav_stream_t* wav_stream, FILE* wav)
+read_chunks(
+    seal_raw_t* raw,
+    _seal_adpcm_t* adpcm,
+    wav_stream_t* wav_stream,
+    seal_io_t* wav
+)
 {
     io_state_t state;
     seal_err_t err;
 
+    adpcm->codec = _SEAL_NO_ADPCM;
     /* Assumes the first 12 bytes are correct. */
     _seal_skip(12, wav);
     do {
-        if ((err = read_chunk(raw, wav_stream, wav, &state)) != SEAL_OK)
+        err = read_chunk(raw, adpcm, wav_stream, wav, &state);
+        if (err != SEAL_OK)
             return err;
     } while (state == NEED_MORE_CHUNKS);
 
@@ -170,17 +254,17 @@ read_chunks(seal_raw_t* raw, wav_stream_t* wav_stream, FILE* wav)
 }
 
 seal_err_t
-_seal_load_wav(seal_raw_t* raw, const char* filename)
+_seal_load_wav_encoded(
+    seal_raw_t* raw,
+    _seal_adpcm_t* adpcm,
+    seal_io_t* io
+)
 {
-    FILE* wav;
     seal_raw_t tmp_raw = SEAL_RAW_INIT_LST;
     seal_err_t err;
 
-    wav = _seal_fopen(filename);
-    if (wav == 0)
-        return SEAL_CANNOT_OPEN_FILE;
-    err = read_chunks(&tmp_raw, 0, wav);
-    _seal_fclose(wav);
+    err = read_chunks(&tmp_raw, adpcm, 0, io);
+    io->close(io->handle);
     if (err != SEAL_OK)
         goto cleanup;
     if (tmp_raw.data == 0 || tmp_raw.attr.freq == 0) {
@@ -199,24 +283,55 @@ cleanup:
     return err;
 }
 
+seal_err_t
+_seal_load_wav(seal_raw_t* raw, seal_io_t* io)
+{
+    seal_raw_t encoded_raw;
+    _seal_adpcm_t adpcm;
+    seal_err_t err;
+
+    if ((err = _seal_load_wav_encoded(raw, &adpcm, io)) != SEAL_OK)
+        return err;
+    if (adpcm.codec == _SEAL_NO_ADPCM)
+        return SEAL_OK;
+
+    encoded_raw = *raw;
+    err = _seal_decode_adpcm(raw, &adpcm, encoded_raw.data, encoded_raw.size);
+    free(encoded_raw.data);
+
+    return err;
+}
+
 seal_err_t
 _seal_init_wav_stream(seal_stream_t* stream, const char* filename)
+{
+    seal_io_t io;
+    seal_err_t err;
+
+    err = _seal_open_readahead_file_io(&io, filename, &stream->readahead);
+    if (err != SEAL_OK)
+        return err;
+
+    return _seal_init_wav_stream_io(stream, &io);
+}
+
+seal_err_t
+_seal_init_wav_stream_io(seal_stream_t* stream, seal_io_t* io)
 {
     wav_stream_t* wav_stream;
     seal_raw_t tmp_raw = SEAL_RAW_INIT_LST;
     seal_err_t err;
 
     wav_stream = malloc(sizeof (wav_stream_t));
-    if (wav_stream == 0)
+    if (wav_stream == 0) {
+        io->close(io->handle);
         return SEAL_CANNOT_ALLOC_MEM;
-
-    wav_stream->file = _seal_fopen(filename);
-    if (wav_stream->file == 0) {
-        err = SEAL_CANNOT_OPEN_FILE;
-        goto mem_cleanup;
     }
+    wav_stream->io = *io;
+    wav_stream->base_offset = wav_stream->end_offset = 0;
 
-    err = read_chunks(&tmp_raw, wav_stream, wav_stream->file);
+    err = read_chunks(&tmp_raw, &wav_stream->adpcm, wav_stream,
+                      &wav_stream->io);
     if (err != SEAL_OK)
         goto cleanup;
     if (wav_stream->base_offset == wav_stream->end_offset
@@ -228,45 +343,132 @@ _seal_init_wav_stream(seal_stream_t* stream, const char* filename)
     stream->id = wav_stream;
     stream->fmt = SEAL_WAV_FMT;
     stream->attr = tmp_raw.attr;
-    _seal_rewind_wav_stream(stream);
+    /* ADPCM streams are decoded to 16-bit PCM on the fly. */
+    if (wav_stream->adpcm.codec != _SEAL_NO_ADPCM)
+        stream->attr.bit_depth = 16;
 
     return SEAL_OK;
 
 cleanup:
-    /* For streaming, close file only on errors. */
-    _seal_fclose(wav_stream->file);
-mem_cleanup:
+    /* For streaming, close the I/O object only on errors. */
+    io->close(io->handle);
     free(wav_stream);
 
     return err;
 }
 
+/*
+ * Streams whole ADPCM blocks that decode to about `raw->size' bytes.
+ */
+/* Size, in bytes, of the PCM data decoded from a whole ADPCM block. */
+static
+size_t
+get_block_pcm_size(seal_stream_t* stream)
+{
+    wav_stream_t* wav_stream = stream->id;
+
+    return wav_stream->adpcm.nframes_per_block * stream->attr.nchannels * 2;
+}
+
+/*
+ * Decodes as many whole ADPCM blocks as fit in `raw->size' bytes of PCM data
+ * to `raw->data'.
+ */
+static
 seal_err_t
-_seal_stream_wav(seal_stream_t* stream, seal_raw_t* raw, size_t* psize)
+stream_adpcm_into(seal_stream_t* stream, seal_raw_t* raw, size_t* psize)
 {
     void* data;
-    size_t nbytes_left, nbytes = 0;
+    size_t nbytes_left, nbytes, nblocks;
     wav_stream_t* wav_stream;
+    seal_raw_t tmp_raw;
+    seal_err_t err;
 
     wav_stream = stream->id;
-    if (wav_stream->offset >= wav_stream->end_offset)
-        goto done;
-
+    nblocks = raw->size / get_block_pcm_size(stream);
+    if (nblocks == 0)
+        return SEAL_BAD_VAL;
     nbytes_left = wav_stream->end_offset - wav_stream->offset;
-    nbytes = nbytes_left < raw->size ? nbytes_left : raw->size;
+    nbytes = nblocks * wav_stream->adpcm.block_align;
+    if (nbytes > nbytes_left)
+        nbytes = nbytes_left;
 
     data = malloc(nbytes);
     if (data == 0)
         return SEAL_CANNOT_ALLOC_MEM;
 
     wav_stream->offset += nbytes;
-    nbytes_left = fread(data, 1, nbytes, wav_stream->file);
+    nbytes = wav_stream->io.read(wav_stream->io.handle, data, nbytes);
+
+    tmp_raw.data = raw->data;
+    tmp_raw.attr = stream->attr;
+    err = _seal_decode_adpcm_into(&tmp_raw, &wav_stream->adpcm, data, nbytes);
+    free(data);
+    if (err != SEAL_OK)
+        return err;
+    *psize = tmp_raw.size;
+
+    return SEAL_OK;
+}
+
+seal_err_t
+_seal_stream_wav_into(seal_stream_t* stream, seal_raw_t* raw, size_t* psize)
+{
+    size_t nbytes_left, nbytes;
+    wav_stream_t* wav_stream;
+
+    wav_stream = stream->id;
+    if (wav_stream->offset >= wav_stream->end_offset) {
+        *psize = 0;
+        return SEAL_OK;
+    }
+    if (wav_stream->adpcm.codec != _SEAL_NO_ADPCM)
+        return stream_adpcm_into(stream, raw, psize);
+
+    nbytes_left = wav_stream->end_offset - wav_stream->offset;
+    nbytes = nbytes_left < raw->size ? nbytes_left : raw->size;
+    wav_stream->offset += nbytes;
+    *psize = wav_stream->io.read(wav_stream->io.handle, raw->data, nbytes);
+
+    return SEAL_OK;
+}
+
+seal_err_t
+_seal_stream_wav(seal_stream_t* stream, seal_raw_t* raw, size_t* psize)
+{
+    size_t nbytes_left, nbytes, block_pcm_size;
+    wav_stream_t* wav_stream;
+    seal_raw_t tmp_raw;
+    seal_err_t err;
+
+    wav_stream = stream->id;
+    if (wav_stream->offset >= wav_stream->end_offset) {
+        *psize = 0;
+        return SEAL_OK;
+    }
 
-    raw->data = data;
+    if (wav_stream->adpcm.codec != _SEAL_NO_ADPCM) {
+        /* Always decode at least one block. */
+        block_pcm_size = get_block_pcm_size(stream);
+        nbytes = raw->size / block_pcm_size * block_pcm_size;
+        if (nbytes == 0)
+            nbytes = block_pcm_size;
+    } else {
+        nbytes_left = wav_stream->end_offset - wav_stream->offset;
+        nbytes = nbytes_left < raw->size ? nbytes_left : raw->size;
+    }
+
+    if ((err = seal_alloc_raw_data(&tmp_raw, nbytes)) != SEAL_OK)
+        return err;
+    err = _seal_stream_wav_into(stream, &tmp_raw, psize);
+    if (err != SEAL_OK || *psize == 0) {
+        seal_free_raw_data(&tmp_raw);
+        return err;
+    }
+
+    raw->data = tmp_raw.data;
+    raw->size = *psize;
     raw->attr = stream->attr;
-    raw->size = nbytes;
-done:
-    *psize = nbytes;
 
     return SEAL_OK;
 }
@@ -278,7 +480,8 @@ _seal_rewind_wav_stream(seal_stream_t* stream)
 
     wav_stream = stream->id;
     wav_stream->offset = wav_stream->base_offset;
-    if (fseek(wav_stream->file, wav_stream->base_offset, SEEK_SET) != 0)
+    if (wav_stream->io.seek(wav_stream->io.handle, wav_stream->base_offset,
+                            SEEK_SET) != 0)
         return SEAL_CANNOT_REWIND_WAV;
 
     return SEAL_OK;
@@ -287,8 +490,27 @@ _seal_rewind_wav_stream(seal_stream_t* stream)
 seal_err_t
 _seal_close_wav_stream(seal_stream_t* stream)
 {
-    _seal_fclose(((wav_stream_t*) stream->id)->file);
-    free(stream->id);
+    wav_stream_t* wav_stream = stream->id;
+
+    wav_stream->io.close(wav_stream->io.handle);
+    free(wav_stream);
 
     return SEAL_OK;
 }
+
+size_t
+_seal_get_wav_stream_nframes(seal_stream_t* stream)
+{
+    wav_stream_t* wav_stream = stream->id;
+    size_t nbytes = wav_stream->end_offset - wav_stream->base_offset;
+    _seal_adpcm_t* adpcm = &wav_stream->adpcm;
+
+    if (adpcm->codec == _SEAL_NO_ADPCM)
+        return nbytes / (stream->attr.nchannels * stream->attr.bit_depth / 8);
+
+    /* A trailing partial block still decodes to some frames. */
+    return nbytes / adpcm->block_align * adpcm->nframes_per_block
+           + _seal_get_adpcm_nframes(adpcm->codec,
+                                     nbytes % adpcm->block_align,
+                                     stream->attr.nchannels);
+}
@@ -1,6 +1,7 @@
 /*
  * Interfaces to decode WAVE audio files. Currently only uncompressed waveform
- * data with no more than 16-bit depth are supported.
+ * data with no more than 16-bit depth, IMA ADPCM and Microsoft ADPCM are
+ * supported. ADPCM data are decoded to 16-bit PCM.
  */
 
 #ifndef _SEAL_WAV_H_
@@ -9,11 +10,39 @@
 #include <stddef.h>
 #include <seal/raw.h>
 #include <seal/stream.h>
+#include <seal/io.h>
+#include "adpcm.h"
 
-seal_err_t _seal_load_wav(seal_raw_t*, const char* /*filename*/);
+/*
+ * Takes the ownership of `io' whether or not it succeeds.
+ */
+seal_err_t _seal_load_wav(seal_raw_t*, seal_io_t*);
+
+/*
+ * Loads the data chunk of a WAVE file without decoding ADPCM, so that it can
+ * be handed to an OpenAL implementation that understands it. `raw->attr'
+ * receives the attribute as stored in the file.
+ *
+ * @param raw       the receiver of the loaded data
+ * @param adpcm     the receiver of the ADPCM parameters; `adpcm->codec' is
+ *                  `_SEAL_NO_ADPCM' for PCM data
+ * @param io        the I/O object of the audio; owned by this function whether
+ *                  or not it succeeds
+ */
+seal_err_t _seal_load_wav_encoded(seal_raw_t*, _seal_adpcm_t*, seal_io_t*);
 seal_err_t _seal_init_wav_stream(seal_stream_t*, const char* /*filename*/);
+/*
+ * Takes the ownership of `io' whether or not it succeeds.
+ */
+seal_err_t _seal_init_wav_stream_io(seal_stream_t*, seal_io_t*);
 seal_err_t _seal_stream_wav(seal_stream_t*, seal_raw_t*, size_t* /*psize*/);
+seal_err_t _seal_stream_wav_into(seal_stream_t*, seal_raw_t*,
+                                 size_t* /*psize*/);
 seal_err_t _seal_rewind_wav_stream(seal_stream_t*);
 seal_err_t _seal_close_wav_stream(seal_stream_t*);
+/*
+ * @return  the total number of sample frames of an opened stream
+ */
+size_t _seal_get_wav_stream_nframes(seal_stream_t*);
 
 #endif /* _SEAL_WAV_H_ */
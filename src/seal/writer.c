@@ -0,0 +1,342 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <seal/writer.h>
+#include <seal/raw.h>
+#include <seal/err.h>
+#include "reader.h"
+
+enum
+{
+    /* Large enough for the disk to be written at full speed. */
+    BUF_SIZE = 262144,
+    PCM_HEADER_SIZE = 44,
+    /* Float data need a `fact' chunk and the extended `fmt ' chunk. */
+    FLOAT_HEADER_SIZE = 58
+};
+
+static const uint16_t PCM_CODE = 1;
+static const uint16_t FLOAT_CODE = 3;
+/* RIFF sizes are 32-bit, including the header but the first 8 bytes. */
+static const unsigned long MAX_DATA_SIZE = 0xffffffffUL - FLOAT_HEADER_SIZE;
+
+static
+void
+reset(seal_writer_t* writer)
+{
+    writer->file = 0;
+    writer->buf = 0;
+    writer->buf_len = 0;
+    writer->buf_cap = 0;
+    writer->data_size = 0;
+}
+
+static
+int
+is_little_endian(void)
+{
+    const uint16_t one = 1;
+
+    return *(const unsigned char*) &one;
+}
+
+static
+unsigned char*
+put_uint16le(unsigned char* dst, uint16_t val)
+{
+    dst[0] = val & 0xff;
+    dst[1] = val >> 8 & 0xff;
+
+    return dst + 2;
+}
+
+static
+unsigned char*
+put_uint32le(unsigned char* dst, uint32_t val)
+{
+    dst[0] = val & 0xff;
+    dst[1] = val >> 8 & 0xff;
+    dst[2] = val >> 16 & 0xff;
+    dst[3] = val >> 24 & 0xff;
+
+    return dst + 4;
+}
+
+static
+unsigned char*
+put_tag(unsigned char* dst, const char* tag)
+{
+    memcpy(dst, tag, 4);
+
+    return dst + 4;
+}
+
+/*
+ * Fills in a header for the data written so far.
+ *
+ * @return  the size of the header
+ */
+static
+size_t
+make_header(seal_writer_t* writer, unsigned char* header)
+{
+    int is_float = writer->attr.bit_depth == 32;
+    size_t header_size = is_float ? FLOAT_HEADER_SIZE : PCM_HEADER_SIZE;
+    uint16_t block_align = writer->attr.nchannels
+                           * (writer->attr.bit_depth / 8);
+    unsigned char* p = header;
+
+    p = put_tag(p, "RIFF");
+    p = put_uint32le(p, header_size - 8 + writer->data_size
+                        + (writer->data_size & 1));
+    p = put_tag(p, "WAVE");
+    p = put_tag(p, "fmt ");
+    p = put_uint32le(p, is_float ? 18 : 16);
+    p = put_uint16le(p, is_float ? FLOAT_CODE : PCM_CODE);
+    p = put_uint16le(p, writer->attr.nchannels);
+    p = put_uint32le(p, writer->attr.freq);
+    p = put_uint32le(p, writer->attr.freq * block_align);
+    p = put_uint16le(p, block_align);
+    p = put_uint16le(p, writer->attr.bit_depth);
+    if (is_float) {
+        p = put_uint16le(p, 0);
+        p = put_tag(p, "fact");
+        p = put_uint32le(p, 4);
+        p = put_uint32le(p, writer->data_size / block_align);
+    }
+    p = put_tag(p, "data");
+    put_uint32le(p, writer->data_size);
+
+    return header_size;
+}
+
+/* Converts a sample to a 32-bit integer at full scale. */
+static
+int32_t
+read_int(const unsigned char* src, int bit_depth)
+{
+    int16_t s16;
+    float f;
+
+    switch (bit_depth) {
+    case 8:
+        return ((int32_t) src[0] - 128) * 16777216;
+    case 16:
+        memcpy(&s16, src, 2);
+        return (int32_t) s16 * 65536;
+    case 24:
+        return (int32_t) ((uint32_t) src[0] << 8 | (uint32_t) src[1] << 16
+                          | (uint32_t) src[2] << 24);
+    default:
+        memcpy(&f, src, 4);
+        if (f != f)
+            return 0;
+        if (f >= 1)
+            return INT32_MAX;
+        if (f <= -1)
+            return INT32_MIN;
+        return (int32_t) (f * 2147483648.0);
+    }
+}
+
+/* Converts a sample to a float in [-1, 1]. */
+static
+float
+read_float(const unsigned char* src, int bit_depth)
+{
+    float f;
+
+    if (bit_depth == 32) {
+        memcpy(&f, src, 4);
+        return f;
+    }
+
+    return (float) (read_int(src, bit_depth) / 2147483648.0);
+}
+
+/* Converts samples to the bit depth of a writer, in little-endian. */
+static
+void
+convert(seal_writer_t* writer, unsigned char* dst, const unsigned char* src,
+        int src_depth, size_t nsamples)
+{
+    int dst_depth = writer->attr.bit_depth;
+    size_t src_size = src_depth / 8;
+    size_t i;
+
+    for (i = 0; i < nsamples; ++i, src += src_size) {
+        int32_t s;
+        float f;
+        uint32_t bits;
+
+        switch (dst_depth) {
+        case 16:
+            s = read_int(src, src_depth);
+            dst = put_uint16le(dst, (uint16_t) ((uint32_t) s >> 16));
+            break;
+        case 24:
+            s = read_int(src, src_depth);
+            dst[0] = (uint32_t) s >> 8 & 0xff;
+            dst[1] = (uint32_t) s >> 16 & 0xff;
+            dst[2] = (uint32_t) s >> 24 & 0xff;
+            dst += 3;
+            break;
+        default:
+            f = read_float(src, src_depth);
+            memcpy(&bits, &f, 4);
+            dst = put_uint32le(dst, bits);
+        }
+    }
+}
+
+static
+seal_err_t
+flush(seal_writer_t* writer)
+{
+    size_t len = writer->buf_len;
+
+    writer->buf_len = 0;
+    if (fwrite(writer->buf, 1, len, writer->file) != len)
+        return SEAL_CANNOT_OPEN_FILE;
+
+    return SEAL_OK;
+}
+
+seal_err_t
+SEAL_API
+seal_open_writer(seal_writer_t* writer, const char* filename,
+                 const seal_raw_attr_t* attr)
+{
+    unsigned char header[FLOAT_HEADER_SIZE];
+    size_t header_size;
+    FILE* file;
+
+    reset(writer);
+    if ((attr->bit_depth != 16 && attr->bit_depth != 24
+         && attr->bit_depth != 32) || attr->nchannels <= 0
+        || attr->nchannels > 0xffff || attr->freq <= 0)
+        return SEAL_BAD_VAL;
+
+    writer->buf = malloc(BUF_SIZE);
+    if (writer->buf == 0)
+        return SEAL_CANNOT_ALLOC_MEM;
+    if ((file = _seal_fcreate(filename)) == 0) {
+        free(writer->buf);
+        reset(writer);
+        return SEAL_CANNOT_OPEN_FILE;
+    }
+    /* Writes are already big; the stdio buffer would only add a copy. */
+    setvbuf(file, 0, _IONBF, 0);
+    writer->file = file;
+    writer->buf_cap = BUF_SIZE;
+    writer->attr = *attr;
+
+    /* Reserves the header, which is written again on close. */
+    header_size = make_header(writer, header);
+    if (fwrite(header, 1, header_size, file) != header_size) {
+        seal_close_writer(writer);
+        return SEAL_CANNOT_OPEN_FILE;
+    }
+
+    return SEAL_OK;
+}
+
+seal_err_t
+SEAL_API
+seal_write_raw(seal_writer_t* writer, const seal_raw_t* raw)
+{
+    int src_depth = raw->attr.bit_depth;
+    size_t src_size = src_depth / 8;
+    size_t dst_size = writer->attr.bit_depth / 8;
+    const unsigned char* src = raw->data;
+    size_t nsamples;
+    seal_err_t err;
+
+    if (writer->file == 0)
+        return SEAL_BAD_OP;
+    if ((src_depth != 8 && src_depth != 16 && src_depth != 24
+         && src_depth != 32) || raw->attr.nchannels != writer->attr.nchannels
+        || raw->attr.freq != writer->attr.freq
+        || raw->size % (src_size * raw->attr.nchannels) != 0)
+        return SEAL_BAD_VAL;
+    nsamples = raw->size / src_size;
+    if (nsamples > (MAX_DATA_SIZE - writer->data_size) / dst_size)
+        return SEAL_BAD_OP;
+
+    /* Big blocks already in the format of the file skip the buffer. */
+    if (src_depth == writer->attr.bit_depth
+        && (src_depth == 24 || is_little_endian())
+        && raw->size >= writer->buf_cap) {
+        if ((err = flush(writer)) != SEAL_OK)
+            return err;
+        if (fwrite(src, 1, raw->size, writer->file) != raw->size)
+            return SEAL_CANNOT_OPEN_FILE;
+        writer->data_size += raw->size;
+        return SEAL_OK;
+    }
+
+    while (nsamples > 0) {
+        size_t n = (writer->buf_cap - writer->buf_len) / dst_size;
+        unsigned char* dst = writer->buf + writer->buf_len;
+
+        if (n == 0) {
+            if ((err = flush(writer)) != SEAL_OK)
+                return err;
+            continue;
+        }
+        if (n > nsamples)
+            n = nsamples;
+        if (src_depth == writer->attr.bit_depth
+            && (src_depth == 24 || is_little_endian()))
+            memcpy(dst, src, n * src_size);
+        else
+            convert(writer, dst, src, src_depth, n);
+        writer->buf_len += n * dst_size;
+        writer->data_size += n * dst_size;
+        src += n * src_size;
+        nsamples -= n;
+    }
+
+    return SEAL_OK;
+}
+
+seal_err_t
+SEAL_API
+seal_close_writer(seal_writer_t* writer)
+{
+    FILE* file = writer->file;
+    unsigned char header[FLOAT_HEADER_SIZE];
+    size_t header_size;
+    seal_err_t err;
+
+    if (file == 0)
+        return SEAL_OK;
+
+    err = flush(writer);
+    /* Chunks are padded to even sizes. */
+    if (err == SEAL_OK && writer->data_size & 1 && fputc(0, file) == EOF)
+        err = SEAL_CANNOT_OPEN_FILE;
+    header_size = make_header(writer, header);
+    if (err == SEAL_OK && (fseek(file, 0, SEEK_SET) != 0
+                           || fwrite(header, 1, header_size, file)
+                              != header_size))
+        err = SEAL_CANNOT_OPEN_FILE;
+    if (fclose(file) != 0 && err == SEAL_OK)
+        err = SEAL_CANNOT_OPEN_FILE;
+    free(writer->buf);
+    reset(writer);
+
+    return err;
+}
+
+seal_err_t
+SEAL_API
+seal_get_writer_nframes(seal_writer_t* writer, size_t* pnframes)
+{
+    size_t frame_size = writer->attr.nchannels * (writer->attr.bit_depth / 8);
+
+    *pnframes = writer->file == 0 ? 0 : writer->data_size / frame_size;
+
+    return SEAL_OK;
+}
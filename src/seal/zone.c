@@ -0,0 +1,326 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <math.h>
+#include <seal/zone.h>
+#include <seal/efs.h>
+#include <seal/rvb.h>
+#include <seal/listener.h>
+#include <seal/core.h>
+#include <seal/err.h>
+
+typedef seal_err_t SEAL_API rvb_setterf_t(seal_rvb_t*, float);
+
+typedef struct slot_t slot_t;
+typedef struct param_t param_t;
+
+struct slot_t
+{
+    seal_efs_t          efs;
+    seal_rvb_t          rvb;
+    /* The parameters and gain last written. */
+    seal_rvb_params_t   params;
+    float               gain;
+    /* 1 if the reverb has to be loaded into the slot again. */
+    char                dirty;
+    /* Weighted sum of the parameters of the zones the listener is in. */
+    seal_rvb_params_t   sum;
+    /* The sum and the largest of the weights of those zones. */
+    float               total;
+    float               peak;
+};
+
+struct param_t
+{
+    size_t          offset;
+    rvb_setterf_t*  set;
+};
+
+/* The float parameters, which are interpolated. */
+static const param_t PARAMS[] = {
+    { offsetof(seal_rvb_params_t, density), seal_set_rvb_density },
+    { offsetof(seal_rvb_params_t, diffusion), seal_set_rvb_diffusion },
+    { offsetof(seal_rvb_params_t, gain), seal_set_rvb_gain },
+    { offsetof(seal_rvb_params_t, hfgain), seal_set_rvb_hfgain },
+    { offsetof(seal_rvb_params_t, decay_time), seal_set_rvb_decay_time },
+    {
+        offsetof(seal_rvb_params_t, hfdecay_ratio),
+        seal_set_rvb_hfdecay_ratio
+    },
+    {
+        offsetof(seal_rvb_params_t, reflections_gain),
+        seal_set_rvb_reflections_gain
+    },
+    {
+        offsetof(seal_rvb_params_t, reflections_delay),
+        seal_set_rvb_reflections_delay
+    },
+    { offsetof(seal_rvb_params_t, late_gain), seal_set_rvb_late_gain },
+    { offsetof(seal_rvb_params_t, late_delay), seal_set_rvb_late_delay },
+    {
+        offsetof(seal_rvb_params_t, air_absorbtion_hfgain),
+        seal_set_rvb_air_absorbtion_hfgain
+    },
+    {
+        offsetof(seal_rvb_params_t, room_rolloff_factor),
+        seal_set_rvb_room_rolloff_factor
+    }
+};
+
+#define NPARAMS (sizeof PARAMS / sizeof PARAMS[0])
+
+static
+float*
+get_param(seal_rvb_params_t* params, size_t i)
+{
+    return (float*) ((char*) params + PARAMS[i].offset);
+}
+
+static
+void
+reset(seal_zones_t* zones)
+{
+    zones->slots = 0;
+    zones->nslots = 0;
+    zones->zones = 0;
+    zones->nzones = 0;
+}
+
+/*
+ * @return  1 within the radius of the zone, falling linearly to 0 at the end
+ *          of the fade distance
+ */
+static
+float
+weigh(const seal_zone_t* zone, const float* listener)
+{
+    float dx = listener[0] - zone->pos[0];
+    float dy = listener[1] - zone->pos[1];
+    float dz = listener[2] - zone->pos[2];
+    float dist = (float) sqrt(dx * dx + dy * dy + dz * dz);
+
+    if (dist <= zone->radius)
+        return 1;
+    if (!(dist < zone->radius + zone->fade))
+        return 0;
+
+    return 1 - (dist - zone->radius) / zone->fade;
+}
+
+static
+void
+accumulate(slot_t* slot, const seal_zone_t* zone, float weight)
+{
+    size_t i;
+
+    for (i = 0; i < NPARAMS; ++i) {
+        *get_param(&slot->sum, i) += weight
+            * *get_param((seal_rvb_params_t*) &zone->params, i);
+    }
+    slot->total += weight;
+    /* The flag cannot be blended so the nearest zone decides. */
+    if (weight > slot->peak) {
+        slot->peak = weight;
+        slot->sum.hfdecay_limited = zone->params.hfdecay_limited;
+    }
+}
+
+/* Makes the writes of a slot whose zones have been accumulated. */
+static
+seal_err_t
+write_slot(slot_t* slot)
+{
+    seal_err_t err = SEAL_OK;
+    float gain = slot->total < 1 ? slot->total : 1;
+    size_t i;
+
+    if (slot->gain != gain) {
+        err = seal_set_efs_gain(&slot->efs, gain);
+        slot->gain = gain;
+    }
+    /* Keeps the last parameters while the slot fades out. */
+    if (slot->total == 0)
+        return err;
+
+    for (i = 0; i < NPARAMS; ++i) {
+        float val = *get_param(&slot->sum, i) / slot->total;
+        float* written = get_param(&slot->params, i);
+
+        if (val != *written) {
+            PARAMS[i].set(&slot->rvb, val);
+            *written = val;
+            slot->dirty = 1;
+        }
+    }
+    if (slot->sum.hfdecay_limited != slot->params.hfdecay_limited) {
+        seal_err_t limit_err = seal_set_rvb_hfdecay_limited(
+            &slot->rvb,
+            slot->sum.hfdecay_limited
+        );
+
+        if (err == SEAL_OK)
+            err = limit_err;
+        slot->params.hfdecay_limited = slot->sum.hfdecay_limited;
+        slot->dirty = 1;
+    }
+
+    return err;
+}
+
+seal_err_t
+SEAL_API
+seal_init_zones(seal_zones_t* zones, size_t nslots)
+{
+    slot_t* slots;
+    size_t i;
+    seal_err_t err;
+
+    if (nslots == 0)
+        return SEAL_BAD_VAL;
+
+    reset(zones);
+    slots = calloc(nslots, sizeof (slot_t));
+    if (slots == 0)
+        return SEAL_CANNOT_ALLOC_MEM;
+    zones->slots = slots;
+
+    for (i = 0; i < nslots; ++i) {
+        slot_t* slot = slots + i;
+
+        if ((err = seal_init_efs(&slot->efs)) != SEAL_OK)
+            goto cleanup;
+        if ((err = seal_init_rvb(&slot->rvb)) != SEAL_OK) {
+            seal_destroy_efs(&slot->efs);
+            goto cleanup;
+        }
+        ++zones->nslots;
+        seal_get_rvb_preset(SEAL_GENERIC_REVERB, &slot->params);
+        if ((err = seal_set_rvb_params(&slot->rvb, &slot->params)) != SEAL_OK
+            || (err = seal_set_efs_gain(&slot->efs, 0)) != SEAL_OK
+            || (err = seal_set_efs_effect(&slot->efs, &slot->rvb)) != SEAL_OK)
+            goto cleanup;
+    }
+
+    return SEAL_OK;
+
+cleanup:
+    seal_destroy_zones(zones);
+
+    return err;
+}
+
+seal_err_t
+SEAL_API
+seal_destroy_zones(seal_zones_t* zones)
+{
+    slot_t* slots = zones->slots;
+    size_t i;
+    seal_err_t err = SEAL_OK, next;
+
+    for (i = 0; i < zones->nslots; ++i) {
+        if ((next = seal_destroy_efs(&slots[i].efs)) != SEAL_OK
+            && err == SEAL_OK)
+            err = next;
+        if ((next = seal_destroy_rvb(&slots[i].rvb)) != SEAL_OK
+            && err == SEAL_OK)
+            err = next;
+    }
+    free(zones->slots);
+    free(zones->zones);
+    reset(zones);
+
+    return err;
+}
+
+seal_err_t
+SEAL_API
+seal_set_zones(seal_zones_t* zones, const seal_zone_t* zone_arr,
+               size_t nzones)
+{
+    seal_zone_t* copies = 0;
+    size_t i;
+
+    for (i = 0; i < nzones; ++i) {
+        const seal_zone_t* zone = zone_arr + i;
+
+        if (zone->slot >= zones->nslots || !(zone->radius >= 0)
+            || !(zone->fade >= 0))
+            return SEAL_BAD_VAL;
+    }
+    if (nzones > 0) {
+        copies = malloc(nzones * sizeof (seal_zone_t));
+        if (copies == 0)
+            return SEAL_CANNOT_ALLOC_MEM;
+        memcpy(copies, zone_arr, nzones * sizeof (seal_zone_t));
+    }
+    free(zones->zones);
+    zones->zones = copies;
+    zones->nzones = nzones;
+
+    return SEAL_OK;
+}
+
+seal_err_t
+SEAL_API
+seal_update_zones(seal_zones_t* zones)
+{
+    slot_t* slots = zones->slots;
+    float listener[3];
+    size_t i;
+    seal_err_t err = SEAL_OK, next;
+
+    seal_get_listener_pos(listener, listener + 1, listener + 2);
+    for (i = 0; i < zones->nslots; ++i) {
+        memset(&slots[i].sum, 0, sizeof slots[i].sum);
+        slots[i].total = 0;
+        slots[i].peak = 0;
+    }
+    for (i = 0; i < zones->nzones; ++i) {
+        const seal_zone_t* zone = zones->zones + i;
+        float weight = weigh(zone, listener);
+
+        if (weight > 0)
+            accumulate(slots + zone->slot, zone, weight);
+    }
+
+    /* Checks the float writes of all the slots for errors at once. */
+    seal_begin_batch();
+    for (i = 0; i < zones->nslots; ++i) {
+        if ((next = write_slot(slots + i)) != SEAL_OK && err == SEAL_OK)
+            err = next;
+    }
+    if ((next = seal_commit_batch()) != SEAL_OK && err == SEAL_OK)
+        err = next;
+
+    /* A slot only picks up the parameters of a reverb when loaded with it. */
+    for (i = 0; i < zones->nslots; ++i) {
+        if (!slots[i].dirty)
+            continue;
+        next = seal_set_efs_effect(&slots[i].efs, &slots[i].rvb);
+        if (next == SEAL_OK)
+            slots[i].dirty = 0;
+        else if (err == SEAL_OK)
+            err = next;
+    }
+
+    return err;
+}
+
+seal_efs_t*
+SEAL_API
+seal_get_zones_efs(seal_zones_t* zones, size_t slot)
+{
+    if (slot >= zones->nslots)
+        return 0;
+
+    return &((slot_t*) zones->slots)[slot].efs;
+}
+
+seal_err_t
+SEAL_API
+seal_get_zones_size(seal_zones_t* zones, size_t* psize)
+{
+    *psize = zones->nzones;
+
+    return SEAL_OK;
+}
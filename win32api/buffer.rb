@@ -7,21 +7,44 @@ module Seal
     INIT = SealAPI.new('init_buf', 'p')
     DESTROY = SealAPI.new('destroy_buf', 'p')
     LOAD = SealAPI.new('load2buf', 'ppi')
+    LOAD_MONO = SealAPI.new('load_mono2buf', 'ppi')
     GET_SIZE = SealAPI.new('get_buf_size', 'pp')
     GET_FREQ = SealAPI.new('get_buf_freq', 'pp')
     GET_BPS = SealAPI.new('get_buf_bps', 'pp')
     GET_NCHANNELS = SealAPI.new('get_buf_nchannels', 'pp')
+    RAW2BUF = SealAPI.new('raw2buf', 'pp')
 
-    def initialize(filename, format = Format::UNKNOWN)
+    class << self
+      include Helper
+
+      def from_pcm(pcm, options)
+        pcm = pcm.to_str
+        raw = [pcm, pcm.bytesize, options.fetch(:bit_depth),
+               options.fetch(:channels), options.fetch(:frequency)]
+        allocate.tap do |buffer|
+          handle = '    '
+          check_error(INIT[handle])
+          ObjectSpace.define_finalizer(buffer, Helper.free(handle, DESTROY))
+          buffer.instance_variable_set(:@buffer, handle)
+          check_error(RAW2BUF[handle, raw.pack('pLi3')])
+        end
+      end
+    end
+
+    def initialize(filename, format = Format::UNKNOWN, options = {})
       @buffer = '    '
       check_error(INIT[@buffer])
-      input_audio(@buffer, filename, format, LOAD)
+      load(filename, format, options)
       ObjectSpace.define_finalizer(self, Helper.free(@buffer, DESTROY))
       self
     end
 
-    def load(filename, format = Format::UNKNOWN)
-      input_audio(@buffer, filename, format, LOAD)
+    def load(filename, format = Format::UNKNOWN, options = {})
+      if format.is_a? Hash
+        options = format
+        format = Format::UNKNOWN
+      end
+      input_audio(@buffer, filename, format, options[:mono] ? LOAD_MONO : LOAD)
       self
     end
 
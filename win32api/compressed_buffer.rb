@@ -0,0 +1,45 @@
+require File.join(File.dirname(__FILE__), 'core')
+
+module Seal
+  class CompressedBuffer
+    include Helper
+
+    INIT = SealAPI.new('init_cbuf', 'p')
+    DESTROY = SealAPI.new('destroy_cbuf', 'p')
+    LOAD = SealAPI.new('load2cbuf', 'ppi')
+    GET_SIZE = SealAPI.new('get_cbuf_size', 'pp')
+    GET_FREQ = SealAPI.new('get_cbuf_freq', 'pp')
+    GET_BPS = SealAPI.new('get_cbuf_bps', 'pp')
+    GET_NCHANNELS = SealAPI.new('get_cbuf_nchannels', 'pp')
+
+    def initialize(filename, format = Format::UNKNOWN)
+      @compressed_buffer = '    ' * 6
+      check_error(INIT[@compressed_buffer])
+      input_audio(@compressed_buffer, filename, format, LOAD)
+      ObjectSpace.define_finalizer(self,
+                                  Helper.free(@compressed_buffer, DESTROY))
+      self
+    end
+
+    def load(filename, format = Format::UNKNOWN)
+      input_audio(@compressed_buffer, filename, format, LOAD)
+      self
+    end
+
+    def size
+      get_obj_int(@compressed_buffer, GET_SIZE)
+    end
+
+    def frequency
+      get_obj_int(@compressed_buffer, GET_FREQ)
+    end
+
+    def bit_depth
+      get_obj_int(@compressed_buffer, GET_BPS)
+    end
+
+    def channel_count
+      get_obj_int(@compressed_buffer, GET_NCHANNELS)
+    end
+  end
+end
\ No newline at end of file
@@ -0,0 +1,43 @@
+require File.join(File.dirname(__FILE__), 'core')
+
+module Seal
+  class Context
+    include Helper
+
+    OPEN = SealAPI.new('open_context', 'pp')
+    CLOSE = SealAPI.new('close_context', 'p')
+    USE = SealAPI.new('use_context', 'p')
+    # Binds a context by address, as returned by GET.
+    USE_ADDRESS = SealAPI.new('use_context', 'l')
+    GET = SealAPI.new('get_context', 'v', 'l')
+
+    class << self
+      include Helper
+
+      def unbind
+        check_error(USE_ADDRESS[0])
+        nil
+      end
+    end
+
+    def initialize(device = nil)
+      @context = '    ' * 11
+      check_error(OPEN[@context, device ? device : 0])
+      ObjectSpace.define_finalizer(self, Helper.free(@context, CLOSE))
+      self
+    end
+
+    def use
+      previous = GET[]
+      check_error(USE[@context])
+      return self unless block_given?
+      begin
+        result = yield
+      ensure
+        error = USE_ADDRESS[previous]
+      end
+      check_error(error)
+      result
+    end
+  end
+end
@@ -65,26 +65,173 @@ module Seal
     end
   end
 
-  VERSION = SealAPI.new('get_version', 'v', 'p')[]
+  VERSION = SealAPI.new('get_version', 'v', 'p')[].freeze
 
   class << self
     include Helper
 
     STARTUP = SealAPI.new('startup', 'p')
+    STARTUP_LOOPBACK = SealAPI.new('startup_loopback', 'iii')
+    RENDER = SealAPI.new('render', 'pi')
     CLEANUP = SealAPI.new('cleanup', 'v', 'v')
     GET_PER_SRC_EFFECT_LIMIT = SealAPI.new('get_per_src_effect_limit', 'v')
+    GET_DEVICE_FREQ = SealAPI.new('get_device_freq', 'v')
+    SET_RESAMPLING = SealAPI.new('set_resampling', 'i', 'v')
+    IS_RESAMPLING = SealAPI.new('is_resampling', 'v')
+    SET_UNCHECKED = SealAPI.new('set_unchecked', 'i', 'v')
+    IS_UNCHECKED = SealAPI.new('is_unchecked', 'v')
+    GET_DEFERRED_ERR = SealAPI.new('get_deferred_err', 'v')
+    BEGIN_BATCH = SealAPI.new('begin_batch', 'v')
+    COMMIT_BATCH = SealAPI.new('commit_batch', 'v')
+    SET_DISTANCE_MODEL = SealAPI.new('set_distance_model', 'i')
+    GET_DISTANCE_MODEL = SealAPI.new('get_distance_model', 'p')
+    HAS_THREAD_LOCAL_CONTEXT = SealAPI.new('has_thread_local_context', 'v')
+    SET_WORKER_COUNT = SealAPI.new('set_worker_count', 'i')
+    GET_WORKER_COUNT = SealAPI.new('get_worker_count', 'v')
+    SET_WORKER_AFFINITY = SealAPI.new('set_worker_affinity', 'i')
+    HAS_WORKER_AFFINITY = SealAPI.new('has_worker_affinity', 'v')
+    SET_STREAMING_SCHED = SealAPI.new('set_streaming_sched', 'pp')
+    GET_STREAMING_SCHED = SealAPI.new('get_streaming_sched', 'p')
+    SCHED_POLICIES = [:default, :fifo, :rr]
+    DISTANCE_MODELS = [
+      :none, :inverse, :inverse_clamped, :linear, :linear_clamped,
+      :exponent, :exponent_clamped
+    ]
+    SAMPLE_TYPES = [:u8, :s16, :float]
+    SAMPLE_SIZES = [1, 2, 4]
 
     def startup(device = nil)
       check_error(STARTUP[device ? device : 0])
     end
 
+    def startup_loopback(frequency, channels, type = :s16)
+      index = SAMPLE_TYPES.index(type.to_sym)
+      check_error(STARTUP_LOOPBACK[
+        frequency, channels, index || SAMPLE_TYPES.size
+      ])
+      @loopback_frame_size = channels * SAMPLE_SIZES[index]
+      nil
+    end
+
+    def render(frames)
+      # Seal reports the error if not on a loopback device.
+      buffer = "\0" * (frames * (@loopback_frame_size || 0))
+      check_error(RENDER[buffer, frames])
+      buffer
+    end
+
     def cleanup
       CLEANUP[]
+      @loopback_frame_size = nil
     end
 
     def per_source_effect_limit
       GET_PER_SRC_EFFECT_LIMIT[]
     end
+
+    def device_frequency
+      GET_DEVICE_FREQ[]
+    end
+
+    def resampling=(value)
+      SET_RESAMPLING[value ? 1 : 0]
+      value
+    end
+
+    def resampling
+      IS_RESAMPLING[] & 0xff != 0
+    end
+    alias resampling? resampling
+
+    def unchecked=(value)
+      SET_UNCHECKED[value ? 1 : 0]
+      value
+    end
+
+    def unchecked
+      IS_UNCHECKED[] & 0xff != 0
+    end
+    alias unchecked? unchecked
+
+    def check_deferred_errors
+      check_error(GET_DEFERRED_ERR[])
+      nil
+    end
+
+    def batch
+      check_error(BEGIN_BATCH[])
+      begin
+        result = yield
+      ensure
+        error = COMMIT_BATCH[]
+      end
+      check_error(error)
+      result
+    end
+
+    def distance_model=(model)
+      index = DISTANCE_MODELS.index(model.to_sym)
+      # An out-of-range enum makes Seal report the error.
+      check_error(SET_DISTANCE_MODEL[index || DISTANCE_MODELS.size])
+      model
+    end
+
+    def distance_model
+      buffer = '    '
+      check_error(GET_DISTANCE_MODEL[buffer])
+      DISTANCE_MODELS[buffer.unpack('i')[0]]
+    end
+
+    def thread_local_context?
+      HAS_THREAD_LOCAL_CONTEXT[] & 0xff != 0
+    end
+
+    def worker_count=(count)
+      # Seal reports the error for a count of 0.
+      check_error(SET_WORKER_COUNT[count > 0 ? count : 0])
+      count
+    end
+
+    def worker_count
+      GET_WORKER_COUNT[]
+    end
+
+    def worker_affinity=(value)
+      check_error(SET_WORKER_AFFINITY[value ? 1 : 0])
+      value
+    end
+
+    def worker_affinity
+      HAS_WORKER_AFFINITY[] & 0xff != 0
+    end
+    alias worker_affinity? worker_affinity
+
+    def schedule_streaming(options = {})
+      policy = SCHED_POLICIES.index((options[:policy] || :default).to_sym)
+      # An out-of-range enum makes Seal report the error.
+      sched = [
+        policy || SCHED_POLICIES.size, options[:priority] || 0,
+        options[:nice] || 0, options[:cpu_mask] || 0
+      ].pack('iiiL')
+      obtained = '    ' * 4
+      check_error(SET_STREAMING_SCHED[sched, obtained])
+      unpack_sched(obtained)
+    end
+
+    def streaming_schedule
+      sched = '    ' * 4
+      check_error(GET_STREAMING_SCHED[sched])
+      unpack_sched(sched)
+    end
+
+  private
+    def unpack_sched(sched)
+      policy, priority, nice, cpu_mask = sched.unpack('iiiL')
+      {
+        :policy => SCHED_POLICIES[policy], :priority => priority,
+        :nice => nice, :cpu_mask => cpu_mask
+      }
+    end
   end
 
   module Format
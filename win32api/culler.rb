@@ -0,0 +1,40 @@
+require File.join(File.dirname(__FILE__), 'core')
+
+module Seal
+  class Culler
+    include Helper
+
+    INIT = SealAPI.new('init_culler', 'pi')
+    DESTROY = SealAPI.new('destroy_culler', 'p')
+    ADD = SealAPI.new('add_culled_src', 'pp')
+    REMOVE = SealAPI.new('remove_culled_src', 'pp')
+    CULL = SealAPI.new('cull_srcs', 'pi')
+    GET_SIZE = SealAPI.new('get_culler_size', 'pp')
+
+    def initialize(cell_size)
+      @culler = '    ' * 14
+      set_obj_float(@culler, cell_size, INIT)
+      ObjectSpace.define_finalizer(self, Helper.free(@culler, DESTROY))
+      self
+    end
+
+    def add(source)
+      check_error(ADD[@culler, source.instance_variable_get(:@source)])
+      self
+    end
+
+    def remove(source)
+      check_error(REMOVE[@culler, source.instance_variable_get(:@source)])
+      self
+    end
+
+    def cull(dt)
+      set_obj_float(@culler, dt, CULL)
+      self
+    end
+
+    def size
+      get_obj_int(@culler, GET_SIZE)
+    end
+  end
+end
@@ -0,0 +1,65 @@
+require File.join(File.dirname(__FILE__), 'core')
+
+module Seal
+  class << self
+    PROBE = SealAPI.new('probe', 'pp')
+
+    def probe(filename)
+      info = '    ' * 6
+      check_error(PROBE[filename, info])
+      Manifest.unpack_info(info)
+    end
+  end
+
+  class Manifest
+    include Helper
+
+    INIT = SealAPI.new('init_manifest', 'p')
+    DESTROY = SealAPI.new('destroy_manifest', 'p')
+    LOAD = SealAPI.new('load_manifest', 'pp')
+    SAVE = SealAPI.new('save_manifest', 'pp')
+    PROBE = SealAPI.new('probe_cached', 'ppp')
+    GET_SIZE = SealAPI.new('get_manifest_size', 'pp')
+
+    def self.unpack_info(info)
+      format, bit_depth, channel_count, frequency, frame_count, seekable =
+        info.unpack('iiiiIc')
+      {
+        :format => format,
+        :frequency => frequency,
+        :bit_depth => bit_depth,
+        :channel_count => channel_count,
+        :frame_count => frame_count,
+        :seekable => seekable != 0
+      }
+    end
+
+    def initialize(filename = nil)
+      @manifest = '    ' * 5
+      check_error(INIT[@manifest])
+      ObjectSpace.define_finalizer(self, Helper.free(@manifest, DESTROY))
+      load(filename) if filename
+      self
+    end
+
+    def load(filename)
+      check_error(LOAD[@manifest, filename])
+      self
+    end
+
+    def save(filename)
+      check_error(SAVE[@manifest, filename])
+      self
+    end
+
+    def probe(filename)
+      info = '    ' * 6
+      check_error(PROBE[@manifest, filename, info])
+      Manifest.unpack_info(info)
+    end
+
+    def size
+      get_obj_int(@manifest, GET_SIZE)
+    end
+  end
+end
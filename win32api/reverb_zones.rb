@@ -0,0 +1,58 @@
+require File.join(File.dirname(__FILE__), 'core')
+
+module Seal
+  class ReverbZones
+    include Helper
+
+    INIT = SealAPI.new('init_zones', 'pi')
+    DESTROY = SealAPI.new('destroy_zones', 'p')
+    SET_ZONES = SealAPI.new('set_zones', 'ppi')
+    UPDATE = SealAPI.new('update_zones', 'p')
+    GET_EFS = SealAPI.new('get_zones_efs', 'pi', 'l')
+    GET_SIZE = SealAPI.new('get_zones_size', 'pp')
+    GET_PRESET = SealAPI.new('get_rvb_preset', 'ip')
+    FEED_EFS = SealAPI.new('feed_efs', 'pli')
+    # The error code of an out-of-range effect slot index.
+    BAD_VAL = 3
+
+    def initialize(slot_count)
+      @zones = '    ' * 4
+      check_error(INIT[@zones, slot_count])
+      ObjectSpace.define_finalizer(self, Helper.free(@zones, DESTROY))
+      self
+    end
+
+    def zones=(zones)
+      packed = zones.map { |zone| pack_zone(zone) }.join
+      check_error(SET_ZONES[@zones, packed, zones.size])
+      zones
+    end
+
+    def update
+      check_error(UPDATE[@zones])
+      self
+    end
+
+    def feed(source, slot, index)
+      native_efs_obj = GET_EFS[@zones, slot]
+      check_error(BAD_VAL) if native_efs_obj == 0
+      native_src_obj = source.instance_variable_get(:@source)
+      check_error(FEED_EFS[native_src_obj, native_efs_obj, index])
+      self
+    end
+
+    def size
+      get_obj_int(@zones, GET_SIZE)
+    end
+
+  private
+    # Packs a zone into a `seal_zone_t`.
+    def pack_zone(zone)
+      params = '    ' * 13
+      check_error(GET_PRESET[zone.fetch(:preset), params])
+      x, y, z = zone.fetch(:position)
+      [x, y, z, zone.fetch(:radius), zone[:fade] || 0].pack('f5') +
+        [zone[:slot] || 0].pack('L') + params
+    end
+  end
+end
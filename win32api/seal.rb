@@ -4,6 +4,6 @@
 # Performance-wise, Win32API < DL < Ruby API.
 
 current_dir = File.dirname(__FILE__)
-%w[core listener buffer effect_slot reverb source stream].each do |mod|
+%w[core context listener buffer compressed_buffer manifest effect_slot reverb source culler reverb_zones stream writer].each do |mod|
   require File.join(current_dir, mod)
 end
\ No newline at end of file
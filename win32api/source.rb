@@ -14,12 +14,18 @@ module Seal
     DETACH = SealAPI.new('detach_src_audio', 'p')
     SET_BUF = SealAPI.new('set_src_buf', 'pp')
     SET_STREAM = SealAPI.new('set_src_stream', 'pp')
+    SET_CBUF = SealAPI.new('set_src_cbuf', 'pp')
     FEED_EFS = SealAPI.new('feed_efs', 'ppi')
     UPDATE = SealAPI.new('update_src', 'p')
     SET_POS = SealAPI.new('set_src_pos', 'piii')
     SET_VEL = SealAPI.new('set_src_vel', 'piii')
+    SET_TRANSFORMS = SealAPI.new('set_src_transforms', 'pipp')
+    MOVE_ALL = SealAPI.new('move_srcs', 'pii')
     SET_GAIN = SealAPI.new('set_src_gain', 'pi')
     SET_PITCH = SealAPI.new('set_src_pitch', 'pi')
+    SET_ROLLOFF_FACTOR = SealAPI.new('set_src_rolloff_factor', 'pi')
+    SET_REF_DIST = SealAPI.new('set_src_ref_dist', 'pi')
+    SET_MAX_DIST = SealAPI.new('set_src_max_dist', 'pi')
     SET_AUTO = SealAPI.new('set_src_auto', 'pi')
     SET_RELATIVE = SealAPI.new('set_src_relative', 'pi')
     SET_LOOPING = SealAPI.new('set_src_looping', 'pi')
@@ -29,6 +35,10 @@ module Seal
     GET_VEL = SealAPI.new('get_src_vel', 'pppp')
     GET_GAIN = SealAPI.new('get_src_gain', 'pp')
     GET_PITCH = SealAPI.new('get_src_pitch', 'pp')
+    GET_ROLLOFF_FACTOR = SealAPI.new('get_src_rolloff_factor', 'pp')
+    GET_REF_DIST = SealAPI.new('get_src_ref_dist', 'pp')
+    GET_MAX_DIST = SealAPI.new('get_src_max_dist', 'pp')
+    IS_CULLED = SealAPI.new('is_src_culled', 'pp')
     GET_AUTO = SealAPI.new('is_src_auto', 'pp')
     GET_RELATIVE = SealAPI.new('is_src_relative', 'pp')
     GET_LOOPING = SealAPI.new('is_src_looping', 'pp')
@@ -37,8 +47,41 @@ module Seal
     GET_TYPE = SealAPI.new('get_src_type', 'pp')
     GET_STATE = SealAPI.new('get_src_state', 'pp')
 
+    class << self
+      include Helper
+
+      def update_transforms(sources, transforms)
+        count = sources.size
+        nfloats = transforms.bytesize / 4
+        if transforms.bytesize % 4 != 0 ||
+           nfloats != count * 3 && nfloats != count * 6
+          raise ArgumentError, "expected #{count * 3} or #{count * 6} " \
+                               "packed floats for #{count} sources"
+        end
+        sources_ptr = pack_sources(sources)
+        positions = transforms.byteslice(0, count * 12)
+        velocities = transforms.byteslice(count * 12, count * 12)
+        velocities = nil if nfloats == count * 3
+        check_error(SET_TRANSFORMS[sources_ptr, count, positions, velocities])
+        sources
+      end
+
+      def move_all(sources, dt)
+        dt = [dt].pack('f').unpack('i')[0]
+        check_error(MOVE_ALL[pack_sources(sources), sources.size, dt])
+        sources
+      end
+
+    private
+
+      def pack_sources(sources)
+        sources.map { |source| source.instance_variable_get(:@source) }
+               .pack('p*')
+      end
+    end
+
     def initialize
-      @source = '    ' * 5
+      @source = '    ' * 20
       check_error(INIT[@source])
       ObjectSpace.define_finalizer(self, Helper.free(@source, DESTROY))
       self
@@ -72,7 +115,11 @@ module Seal
       set_audio(:@stream, stream, SET_STREAM)
     end
 
-    attr_reader :buffer, :stream
+    def compressed_buffer=(compressed_buffer)
+      set_audio(:@compressed_buffer, compressed_buffer, SET_CBUF)
+    end
+
+    attr_reader :buffer, :stream, :compressed_buffer
 
     def feed(effect_slot, index)
       native_efs_obj = effect_slot.instance_variable_get(:@effect_slot)
@@ -100,6 +147,18 @@ module Seal
       set_obj_float(@source, pitch, SET_PITCH)
     end
 
+    def rolloff_factor=(factor)
+      set_obj_float(@source, factor, SET_ROLLOFF_FACTOR)
+    end
+
+    def reference_distance=(distance)
+      set_obj_float(@source, distance, SET_REF_DIST)
+    end
+
+    def max_distance=(distance)
+      set_obj_float(@source, distance, SET_MAX_DIST)
+    end
+
     def auto=(auto)
       set_obj_char(@source, auto, SET_AUTO)
     end
@@ -136,6 +195,22 @@ module Seal
       get_obj_float(@source, GET_PITCH)
     end
 
+    def rolloff_factor
+      get_obj_float(@source, GET_ROLLOFF_FACTOR)
+    end
+
+    def reference_distance
+      get_obj_float(@source, GET_REF_DIST)
+    end
+
+    def max_distance
+      get_obj_float(@source, GET_MAX_DIST)
+    end
+
+    def culled?
+      get_obj_char(@source, IS_CULLED)
+    end
+
     def auto
       get_obj_char(@source, GET_AUTO)
     end
@@ -5,20 +5,51 @@ module Seal
     include Helper
 
     OPEN = SealAPI.new('open_stream', 'ppi')
+    OPEN_ASYNC = SealAPI.new('open_stream_async', 'ppipp')
+    IS_OPENING = SealAPI.new('is_stream_opening', 'pp')
+    WAIT = SealAPI.new('wait_stream', 'p')
+    SET_FAST_OPEN = SealAPI.new('set_fast_stream_open', 'i', 'v')
+    IS_FAST_OPEN = SealAPI.new('is_fast_stream_open', 'v')
     CLOSE = SealAPI.new('close_stream', 'p')
     REWIND = SealAPI.new('rewind_stream', 'p')
+    SET_READ_AHEAD = SealAPI.new('set_stream_readahead', 'pi')
+    GET_READ_AHEAD = SealAPI.new('get_stream_readahead', 'pp')
+    STREAM_INTO = SealAPI.new('stream_into', 'ppp')
 
     class << self
       alias open new
+
+      def open_async(filename, format = Format::UNKNOWN)
+        allocate.tap { |stream| stream.send(:open_async, filename, format) }
+      end
+
+      def fast_open=(value)
+        SET_FAST_OPEN[value ? 1 : 0]
+        value
+      end
+
+      def fast_open
+        IS_FAST_OPEN[] & 0xff != 0
+      end
+      alias fast_open? fast_open
     end
 
     def initialize(filename, format = Format::UNKNOWN)
-      @stream = '    ' * 5
+      @stream = '    ' * 7
       input_audio(@stream, filename, format, OPEN)
       ObjectSpace.define_finalizer(self, Helper.free(@stream, CLOSE))
       self
     end
 
+    def opening?
+      get_obj_char(@stream, IS_OPENING)
+    end
+
+    def wait
+      check_error(WAIT[@stream])
+      self
+    end
+
     def frequency
       field(4)
     end
@@ -31,6 +62,28 @@ module Seal
       field(3)
     end
 
+    def read_ahead=(size)
+      set_obj_int(@stream, size, SET_READ_AHEAD)
+    end
+
+    def read_ahead
+      get_obj_int(@stream, GET_READ_AHEAD)
+    end
+
+    def read(nbytes, options = {})
+      raise ArgumentError, "negative length #{nbytes} given" if nbytes < 0
+      string = options[:into] || ''
+      string.force_encoding(Encoding::BINARY)
+      string << "\0" * (nbytes - string.bytesize) if string.bytesize < nbytes
+      return string.replace('') if nbytes == 0
+      psize = '    '
+      check_error(STREAM_INTO[@stream, [string, nbytes, 0, 0, 0].pack('pLi3'),
+                              psize])
+      size = psize.unpack('L')[0]
+      string[size..-1] = ''
+      size == 0 ? nil : string
+    end
+
     def rewind
       check_error(REWIND[@stream])
     end
@@ -40,7 +93,14 @@ module Seal
     end
 
   private
+    def open_async(filename, format)
+      @stream = '    ' * 7
+      check_error(OPEN_ASYNC[@stream, filename, format, 0, 0])
+      ObjectSpace.define_finalizer(self, Helper.free(@stream, CLOSE))
+    end
+
     def field(index)
+      WAIT[@stream]
       @stream[index * 4, 4].unpack('i')[0]
     end
   end
@@ -0,0 +1,41 @@
+require File.join(File.dirname(__FILE__), 'core')
+
+module Seal
+  class Writer
+    include Helper
+
+    OPEN = SealAPI.new('open_writer', 'ppp')
+    WRITE_RAW = SealAPI.new('write_raw', 'pp')
+    CLOSE = SealAPI.new('close_writer', 'p')
+    GET_NFRAMES = SealAPI.new('get_writer_nframes', 'pp')
+
+    def initialize(filename, options)
+      @writer = '    ' * 8
+      @attr = [options.fetch(:bit_depth, 16), options.fetch(:channels),
+               options.fetch(:frequency)]
+      check_error(OPEN[@writer, filename, @attr.pack('i3')])
+      ObjectSpace.define_finalizer(self, Helper.free(@writer, CLOSE))
+      self
+    end
+
+    def write(pcm, options = {})
+      pcm = pcm.to_str
+      # seal_raw_t: data, size and the attribute.
+      raw = [pcm, pcm.bytesize, options.fetch(:bit_depth, @attr[0]),
+             *@attr[1, 2]].pack('pLi3')
+      check_error(WRITE_RAW[@writer, raw])
+      self
+    end
+
+    def close
+      check_error(CLOSE[@writer])
+      nil
+    end
+
+    def frame_count
+      buffer = '    '
+      check_error(GET_NFRAMES[@writer, buffer])
+      buffer.unpack('L')[0]
+    end
+  end
+end